@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <math.h>
 
 #include <glib.h>
 #include <gio/gio.h>
@@ -66,6 +67,12 @@ help_and_exit(int exit_code)
 	COMMAND("quit",       "Quit " PACKAGE_CAMEL_NAME);
 	COMMAND("is-running", "Check whether " PACKAGE_CAMEL_NAME " is running");
 	COMMAND("help",       "Print this help message");
+	COMMAND("--batch",    "Read commands from stdin, one per line");
+	COMMAND("--format=<format> <command>", "Output format: text, json, tsv or gvariant");
+	DESC   ("Applies to 'current', 'list' and 'watch'");
+	DESC   ("tsv columns: uid name uri check-error for 'list',");
+	DESC   ("name uri title artist album year genre comment for 'current'");
+	COMMAND("watch [--json] [<property>...]", "Print player and station list events as they happen");
 	NL();
 
 	TITLE  ("Control");
@@ -84,15 +91,37 @@ help_and_exit(int exit_code)
 	COMMAND("playing", "Get playback status");
 	NL();
 
+	TITLE  ("Recording");
+	COMMAND("record", "Start recording the stream to disk");
+	COMMAND("record-stop", "Stop recording");
+	COMMAND("recording", "Get recording status");
+	NL();
+
+	TITLE  ("Zones");
+	print  (". control commands can be sent to a zone instead of the main player");
+	COMMAND("zones", "List zones");
+	COMMAND("zone <name> <command>", "Run a control command for the given zone");
+	NL();
+
 	TITLE  ("Station list");
 	print  (". <station> can be the station name or uri");
-	COMMAND("list", "Display the list of stations");
+	COMMAND("list [<words>]", "Display the list of stations");
+	DESC   ("Only the stations matching <words>, if any");
 	COMMAND("add    <station-uri> [<station-name>] [[first/last] [before/after <station>]]", "");
 	DESC   ("Add a station to the list");
 	COMMAND("remove <station>", "Remove a station from the list");
 	COMMAND("rename <station> <name>", "Rename a station");
 	COMMAND("move   <station> [[first/last] [before/after <station>]]", "");
 	DESC   ("Move a station in the list");
+	COMMAND("import <file>", "Import stations from a M3U, PLS or XML file");
+	DESC   ("Read from stdin if <file> is '-'");
+	COMMAND("search <words>", "Search stations and songs played");
+	NL();
+
+	TITLE  ("History");
+	print  (". <time> can be HH:MM (today), YYYY-MM-DD or YYYY-MM-DDTHH:MM");
+	COMMAND("history [<station>] [<from> [<to>]]", "");
+	DESC   ("Display the songs played, the last 20 if no time is given");
 	NL();
 
 	TITLE  ("Configuration");
@@ -116,6 +145,51 @@ help_and_exit(int exit_code)
 #define DBUS_ROOT_IFACE     PACKAGE_APPLICATION_ID
 #define DBUS_PLAYER_IFACE   DBUS_ROOT_IFACE ".Player"
 #define DBUS_STATIONS_IFACE DBUS_ROOT_IFACE ".Stations"
+#define DBUS_HISTORY_IFACE  DBUS_ROOT_IFACE ".History"
+
+/* The connection is opened once, and used for every call */
+static GDBusConnection *dbus_connection;
+
+GDBusConnection *
+dbus_get_connection(void)
+{
+	GError *error = NULL;
+
+	if (dbus_connection)
+		return dbus_connection;
+
+	dbus_connection = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, &error);
+	if (dbus_connection == NULL) {
+		print_err("DBus connection error: %s", error->message);
+		g_error_free(error);
+	}
+
+	return dbus_connection;
+}
+
+void
+dbus_cleanup(void)
+{
+	if (dbus_connection == NULL)
+		return;
+
+	g_dbus_connection_flush_sync(dbus_connection, NULL, NULL);
+	g_object_unref(dbus_connection);
+	dbus_connection = NULL;
+}
+
+void
+print_dbus_error(const GError *error)
+{
+	if (error->domain == G_DBUS_ERROR &&
+	    error->code == G_DBUS_ERROR_NAME_HAS_NO_OWNER) {
+		/* Goodvibes is not running */
+		print_err(PACKAGE_CAMEL_NAME " is not running !");
+	} else {
+		/* Other error, just dump the GError */
+		print_err("DBus call error: %s", error->message);
+	}
+}
 
 int
 dbus_call(const char *bus_name,
@@ -132,10 +206,10 @@ dbus_call(const char *bus_name,
 	if (output)
 		*output = NULL;
 
-	c = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, &error);
+	c = dbus_get_connection();
 	if (c == NULL) {
-		print_err("DBus connection error: %s", error->message);
-		g_error_free(error);
+		if (args)
+			g_variant_unref(g_variant_ref_sink(args));
 		return -1;
 	}
 
@@ -145,20 +219,11 @@ dbus_call(const char *bus_name,
 	                                     &error);
 
 	if (error) {
-		if (error->domain == G_DBUS_ERROR &&
-		    error->code == G_DBUS_ERROR_NAME_HAS_NO_OWNER) {
-			/* Goodvibes is not running */
-			print_err(PACKAGE_CAMEL_NAME " is not running !");
-		} else {
-			/* Other error, just dump the GError */
-			print_err("DBus call error: %s", error->message);
-		}
+		print_dbus_error(error);
 		g_error_free(error);
 		return -1;
 	}
 
-	g_dbus_connection_close(c, NULL, NULL, NULL);
-
 	if (output)
 		*output = result;
 	else if (result)
@@ -169,6 +234,210 @@ dbus_call(const char *bus_name,
 
 
 
+/*
+ * Output formats
+ *
+ * Machine-readable formats are written straight to stdout, value by value,
+ * so that nothing is formatted in memory beforehand.
+ */
+
+enum output_format {
+	FORMAT_TEXT,
+	FORMAT_JSON,
+	FORMAT_TSV,
+	FORMAT_GVARIANT
+};
+
+static enum output_format output_format = FORMAT_TEXT;
+
+static int
+parse_output_format(const char *str)
+{
+	if (!g_strcmp0(str, "text"))
+		output_format = FORMAT_TEXT;
+	else if (!g_strcmp0(str, "json"))
+		output_format = FORMAT_JSON;
+	else if (!g_strcmp0(str, "tsv"))
+		output_format = FORMAT_TSV;
+	else if (!g_strcmp0(str, "gvariant"))
+		output_format = FORMAT_GVARIANT;
+	else
+		return -1;
+
+	return 0;
+}
+
+static void
+write_json_string(const gchar *str)
+{
+	const gchar *ptr;
+
+	fputc('"', stdout);
+
+	for (ptr = str; *ptr != '\0'; ptr++) {
+		guchar c = *ptr;
+
+		switch (c) {
+		case '"':
+			fputs("\\\"", stdout);
+			break;
+		case '\\':
+			fputs("\\\\", stdout);
+			break;
+		case '\n':
+			fputs("\\n", stdout);
+			break;
+		case '\r':
+			fputs("\\r", stdout);
+			break;
+		case '\t':
+			fputs("\\t", stdout);
+			break;
+		default:
+			if (c < 0x20)
+				fprintf(stdout, "\\u%04x", c);
+			else
+				fputc(c, stdout);
+			break;
+		}
+	}
+
+	fputc('"', stdout);
+}
+
+static void
+write_json_value(GVariant *value)
+{
+	const GVariantType *type = g_variant_get_type(value);
+
+	if (g_variant_type_equal(type, G_VARIANT_TYPE_BOOLEAN)) {
+		fputs(g_variant_get_boolean(value) ? "true" : "false", stdout);
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_BYTE)) {
+		fprintf(stdout, "%u", g_variant_get_byte(value));
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_INT16)) {
+		fprintf(stdout, "%d", g_variant_get_int16(value));
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_UINT16)) {
+		fprintf(stdout, "%u", g_variant_get_uint16(value));
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_INT32)) {
+		fprintf(stdout, "%d", g_variant_get_int32(value));
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_UINT32)) {
+		fprintf(stdout, "%u", g_variant_get_uint32(value));
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_INT64)) {
+		fprintf(stdout, "%" G_GINT64_FORMAT, g_variant_get_int64(value));
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_UINT64)) {
+		fprintf(stdout, "%" G_GUINT64_FORMAT, g_variant_get_uint64(value));
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_DOUBLE)) {
+		gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+		gdouble d = g_variant_get_double(value);
+
+		/* There's no such thing as nan or inf in json */
+		if (isfinite(d)) {
+			g_ascii_dtostr(buf, sizeof buf, d);
+			fputs(buf, stdout);
+		} else {
+			fputs("null", stdout);
+		}
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_STRING) ||
+	           g_variant_type_equal(type, G_VARIANT_TYPE_OBJECT_PATH)) {
+		write_json_string(g_variant_get_string(value, NULL));
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_VARIANT)) {
+		GVariant *child;
+
+		child = g_variant_get_variant(value);
+		write_json_value(child);
+		g_variant_unref(child);
+	} else if (g_variant_type_equal(type, G_VARIANT_TYPE_VARDICT)) {
+		GVariantIter iter;
+		const gchar *key;
+		GVariant *child;
+		gboolean first = TRUE;
+
+		fputc('{', stdout);
+		g_variant_iter_init(&iter, value);
+		while (g_variant_iter_next(&iter, "{&sv}", &key, &child)) {
+			if (!first)
+				fputc(',', stdout);
+			first = FALSE;
+			write_json_string(key);
+			fputc(':', stdout);
+			write_json_value(child);
+			g_variant_unref(child);
+		}
+		fputc('}', stdout);
+	} else if (g_variant_is_container(value)) {
+		GVariantIter iter;
+		GVariant *child;
+		gboolean first = TRUE;
+
+		fputc('[', stdout);
+		g_variant_iter_init(&iter, value);
+		while ((child = g_variant_iter_next_value(&iter))) {
+			if (!first)
+				fputc(',', stdout);
+			first = FALSE;
+			write_json_value(child);
+			g_variant_unref(child);
+		}
+		fputc(']', stdout);
+	} else {
+		fputs("null", stdout);
+	}
+}
+
+/* Tabs and newlines are escaped, so that each record stays on one line */
+static void
+write_tsv_field(const gchar *str, gboolean last)
+{
+	const gchar *ptr;
+
+	for (ptr = str ? str : ""; *ptr != '\0'; ptr++) {
+		switch (*ptr) {
+		case '\\':
+			fputs("\\\\", stdout);
+			break;
+		case '\t':
+			fputs("\\t", stdout);
+			break;
+		case '\n':
+			fputs("\\n", stdout);
+			break;
+		case '\r':
+			fputs("\\r", stdout);
+			break;
+		default:
+			fputc(*ptr, stdout);
+			break;
+		}
+	}
+
+	fputc(last ? '\n' : '\t', stdout);
+}
+
+/* Write the given keys of a dictionary as one tsv record */
+static void
+write_tsv_record(GVariant *dict, const char * const *keys)
+{
+	const char * const *key;
+
+	for (key = keys; *key; key++) {
+		const gchar *str = NULL;
+
+		g_variant_lookup(dict, *key, "&s", &str);
+		write_tsv_field(str, key[1] == NULL);
+	}
+}
+
+static void
+write_gvariant(GVariant *value)
+{
+	gchar *str;
+
+	str = g_variant_print(value, TRUE);
+	fputs(str, stdout);
+	fputc('\n', stdout);
+	g_free(str);
+}
+
 /*
  * Supported DBus commands
  */
@@ -178,12 +447,17 @@ enum cmd_type {
 	PROPERTY
 };
 
+/* Parse functions return -1 for invalid arguments, and -2 for any other
+ * failure, already reported. Print functions return -1 on failure.
+ */
 struct cmd {
 	enum cmd_type type;
 	const char *cmdline_name;
 	const char *dbus_name;
 	int  (*parse_args)   (int, char *[], GVariantBuilder *);
-	void (*print_result) (GVariant *);
+	int  (*print_result) (GVariant *);
+	/* Keeps a state between the call and the printing of the result */
+	gboolean stateful;
 };
 
 struct interface {
@@ -328,6 +602,380 @@ parse_move_args(int argc, char *argv[], GVariantBuilder *b)
 	return 0;
 }
 
+/*
+ * Import stations, either from a playlist (M3U, PLS), or from a
+ * station list, as saved by Goodvibes (XML).
+ */
+
+struct import_list {
+	GPtrArray *uris;
+	GPtrArray *names;
+	/* XML parsing */
+	gchar    **cur;
+	gchar     *uri;
+	gchar     *name;
+};
+
+static struct import_list import_list;
+
+static void
+import_station(const gchar *uri, const gchar *name)
+{
+	g_ptr_array_add(import_list.uris, g_strstrip(g_strdup(uri)));
+	g_ptr_array_add(import_list.names, g_strstrip(g_strdup(name ? name : "")));
+}
+
+static void
+import_m3u(const gchar *text)
+{
+	gchar **lines;
+	gchar *name = NULL;
+	guint i;
+
+	lines = g_strsplit(text, "\n", -1);
+
+	for (i = 0; lines[i]; i++) {
+		gchar *line = g_strstrip(lines[i]);
+
+		if (line[0] == '\0')
+			continue;
+
+		if (g_str_has_prefix(line, "#EXTINF:")) {
+			gchar *comma = strchr(line, ',');
+
+			g_free(name);
+			name = comma ? g_strdup(comma + 1) : NULL;
+		} else if (line[0] != '#') {
+			import_station(line, name);
+			g_free(name);
+			name = NULL;
+		}
+	}
+
+	g_free(name);
+	g_strfreev(lines);
+}
+
+static int
+import_pls(const gchar *text)
+{
+	GKeyFile *keyfile;
+	GError *err = NULL;
+	guint i;
+
+	keyfile = g_key_file_new();
+
+	if (!g_key_file_load_from_data(keyfile, text, -1, G_KEY_FILE_NONE, &err)) {
+		print_err("Failed to parse PLS: %s", err->message);
+		g_error_free(err);
+		g_key_file_free(keyfile);
+		return -1;
+	}
+
+	for (i = 1; ; i++) {
+		gchar *key;
+		gchar *uri;
+		gchar *name;
+
+		key = g_strdup_printf("File%u", i);
+		uri = g_key_file_get_string(keyfile, "playlist", key, NULL);
+		g_free(key);
+
+		if (uri == NULL)
+			break;
+
+		key = g_strdup_printf("Title%u", i);
+		name = g_key_file_get_string(keyfile, "playlist", key, NULL);
+		g_free(key);
+
+		import_station(uri, name);
+		g_free(uri);
+		g_free(name);
+	}
+
+	g_key_file_free(keyfile);
+
+	return 0;
+}
+
+static void
+import_xml_on_start_element(GMarkupParseContext  *context G_GNUC_UNUSED,
+                            const gchar          *element_name,
+                            const gchar         **attribute_names G_GNUC_UNUSED,
+                            const gchar         **attribute_values G_GNUC_UNUSED,
+                            gpointer              user_data G_GNUC_UNUSED,
+                            GError              **error G_GNUC_UNUSED)
+{
+	if (!g_strcmp0(element_name, "uri"))
+		import_list.cur = &import_list.uri;
+	else if (!g_strcmp0(element_name, "name"))
+		import_list.cur = &import_list.name;
+	else
+		import_list.cur = NULL;
+}
+
+static void
+import_xml_on_end_element(GMarkupParseContext  *context G_GNUC_UNUSED,
+                          const gchar          *element_name,
+                          gpointer              user_data G_GNUC_UNUSED,
+                          GError              **error G_GNUC_UNUSED)
+{
+	import_list.cur = NULL;
+
+	if (g_strcmp0(element_name, "Station"))
+		return;
+
+	if (import_list.uri)
+		import_station(import_list.uri, import_list.name);
+
+	g_free(import_list.uri);
+	g_free(import_list.name);
+	import_list.uri = NULL;
+	import_list.name = NULL;
+}
+
+static void
+import_xml_on_text(GMarkupParseContext  *context G_GNUC_UNUSED,
+                   const gchar          *text,
+                   gsize                 text_len,
+                   gpointer              user_data G_GNUC_UNUSED,
+                   GError              **error G_GNUC_UNUSED)
+{
+	if (import_list.cur == NULL)
+		return;
+
+	g_free(*import_list.cur);
+	*import_list.cur = g_strndup(text, text_len);
+}
+
+static int
+import_xml(const gchar *text)
+{
+	GMarkupParseContext *context;
+	GMarkupParser parser = {
+		import_xml_on_start_element,
+		import_xml_on_end_element,
+		import_xml_on_text,
+		NULL,
+		NULL
+	};
+	GError *err = NULL;
+
+	context = g_markup_parse_context_new(&parser, 0, NULL, NULL);
+	g_markup_parse_context_parse(context, text, -1, &err);
+	if (err == NULL)
+		g_markup_parse_context_end_parse(context, &err);
+	g_markup_parse_context_free(context);
+
+	if (err) {
+		print_err("Failed to parse XML: %s", err->message);
+		g_error_free(err);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Set when stdin is already used to read commands */
+static gboolean stdin_busy;
+
+static gchar *
+read_file_or_stdin(const char *filename)
+{
+	GError *err = NULL;
+	gchar *text = NULL;
+
+	if (strcmp(filename, "-")) {
+		if (!g_file_get_contents(filename, &text, NULL, &err)) {
+			print_err("Failed to read '%s': %s", filename, err->message);
+			g_error_free(err);
+		}
+	} else if (stdin_busy) {
+		print_err("Can't read stations from stdin, it's used for commands");
+	} else {
+		GString *string = g_string_new(NULL);
+		char buf[4096];
+		size_t n;
+
+		while ((n = fread(buf, 1, sizeof(buf), stdin)) > 0)
+			g_string_append_len(string, buf, n);
+
+		text = g_string_free(string, FALSE);
+	}
+
+	return text;
+}
+
+int
+parse_import_args(int argc, char *argv[], GVariantBuilder *b)
+{
+	const gchar *start;
+	gchar *text;
+	int err;
+	guint i;
+
+	if (argc != 1)
+		return -1;
+
+	text = read_file_or_stdin(argv[0]);
+	if (text == NULL)
+		return -2;
+
+	/* In batch mode, there might be several imports in a row */
+	if (import_list.uris == NULL) {
+		import_list.uris = g_ptr_array_new_with_free_func(g_free);
+		import_list.names = g_ptr_array_new_with_free_func(g_free);
+	}
+
+	g_ptr_array_set_size(import_list.uris, 0);
+	g_ptr_array_set_size(import_list.names, 0);
+
+	/* Guess the format from the content */
+	start = text;
+	while (isspace((unsigned char) *start))
+		start++;
+
+	if (*start == '<')
+		err = import_xml(start);
+	else if (strstr(start, "[playlist]"))
+		err = import_pls(start);
+	else {
+		import_m3u(start);
+		err = 0;
+	}
+
+	g_free(text);
+
+	if (err)
+		return -2;
+
+	if (import_list.uris->len == 0) {
+		print_err("No station found in '%s'", argv[0]);
+		return -2;
+	}
+
+	/* All the stations are added in a single call */
+	g_variant_builder_open(b, G_VARIANT_TYPE("a(ssss)"));
+	for (i = 0; i < import_list.uris->len; i++)
+		g_variant_builder_add(b, "(ssss)",
+		                      g_ptr_array_index(import_list.uris, i),
+		                      g_ptr_array_index(import_list.names, i),
+		                      "last", "");
+	g_variant_builder_close(b);
+
+	return 0;
+}
+
+int
+parse_time(const char *str, gint64 *timestamp)
+{
+	GDateTime *now, *date_time;
+	int year, month, day;
+	int hour = 0, minute = 0;
+	char c;
+
+	now = g_date_time_new_now_local();
+	year = g_date_time_get_year(now);
+	month = g_date_time_get_month(now);
+	day = g_date_time_get_day_of_month(now);
+	g_date_time_unref(now);
+
+	/* Trailing characters are detected with '%c' */
+	if (sscanf(str, "%d:%d%c", &hour, &minute, &c) != 2 &&
+	    sscanf(str, "%d-%d-%dT%d:%d%c", &year, &month, &day, &hour, &minute, &c) != 5) {
+		hour = minute = 0;
+		if (sscanf(str, "%d-%d-%d%c", &year, &month, &day, &c) != 3)
+			return -1;
+	}
+
+	date_time = g_date_time_new_local(year, month, day, hour, minute, 0);
+	if (date_time == NULL)
+		return -1;
+
+	*timestamp = g_date_time_to_unix(date_time);
+	g_date_time_unref(date_time);
+
+	return 0;
+}
+
+int
+parse_history_args(int argc, char *argv[], GVariantBuilder *b)
+{
+	const char *station;
+	gint64 times[2] = { 0, 0 };
+	int n_times;
+	int i;
+
+	station = "";
+	n_times = 0;
+
+	for (i = 0; i < argc; i++) {
+		if (n_times < 2 && parse_time(argv[i], &times[n_times]) == 0)
+			n_times++;
+		else if (i == 0)
+			station = argv[i];
+		else
+			return -1;
+	}
+
+	g_variant_builder_add(b, "s", station);
+	g_variant_builder_add(b, "x", times[0]);
+	g_variant_builder_add(b, "x", times[1]);
+	/* Without time range, only display the last songs */
+	g_variant_builder_add(b, "u", n_times == 0 ? 20 : 0);
+
+	return 0;
+}
+
+/* The station list is fetched in pages, with the same filter each time */
+#define LIST_PAGE_SIZE 100
+
+static gchar *list_filter;
+
+static void
+add_list_args(GVariantBuilder *b, const char *cursor)
+{
+	const char *text_fields[] = { "uri", "name", "check-error", NULL };
+	const char *fields[] = { "uid", "uri", "name", "check-error", NULL };
+
+	g_variant_builder_add(b, "u", 0);
+	g_variant_builder_add(b, "u", LIST_PAGE_SIZE);
+	g_variant_builder_add(b, "s", list_filter);
+	g_variant_builder_add(b, "^as",
+	                      output_format == FORMAT_TEXT ? text_fields : fields);
+	g_variant_builder_add(b, "s", cursor);
+}
+
+int
+parse_list_args(int argc, char *argv[], GVariantBuilder *b)
+{
+	g_free(list_filter);
+	list_filter = argc > 0 ? g_strjoinv(" ", argv) : g_strdup("");
+
+	add_list_args(b, "");
+
+	return 0;
+}
+
+int
+parse_search_args(int argc, char *argv[], GVariantBuilder *b)
+{
+	gchar *query;
+
+	if (argc == 0)
+		return -1;
+
+	query = g_strjoinv(" ", argv);
+	g_variant_builder_add(b, "s", query);
+	g_free(query);
+
+	/* Only display the best matches */
+	g_variant_builder_add(b, "u", 0);
+	g_variant_builder_add(b, "u", 50);
+
+	return 0;
+}
+
 int
 parse_boolean(int argc, char *argv[], GVariantBuilder *b)
 {
@@ -366,7 +1014,20 @@ parse_volume(int argc, char *argv[], GVariantBuilder *b)
 	return 0;
 }
 
-void
+int
+print_strv(GVariant *result)
+{
+	GVariantIter iter;
+	const gchar *str;
+
+	g_variant_iter_init(&iter, result);
+	while (g_variant_iter_next(&iter, "&s", &str))
+		print("%s", str);
+
+	return 0;
+}
+
+int
 print_boolean(GVariant *result)
 {
 	gboolean bool;
@@ -377,18 +1038,26 @@ print_boolean(GVariant *result)
 		print("true");
 	else
 		print("false");
+
+	return 0;
 }
 
-void
+int
 print_volume(GVariant *result)
 {
 	guint volume;
 
 	volume = g_variant_get_uint32(result);
 	print("%u%%", volume);
+
+	return 0;
 }
 
-void
+static const char *current_tsv_keys[] = {
+	"name", "uri", "title", "artist", "album", "year", "genre", "comment", NULL
+};
+
+int
 print_current(GVariant *result)
 {
 	GVariantIter *iter;
@@ -403,6 +1072,21 @@ print_current(GVariant *result)
 	gchar *year = NULL;
 	gchar *comment = NULL;
 
+	switch (output_format) {
+	case FORMAT_JSON:
+		write_json_value(result);
+		fputc('\n', stdout);
+		return 0;
+	case FORMAT_TSV:
+		write_tsv_record(result, current_tsv_keys);
+		return 0;
+	case FORMAT_GVARIANT:
+		write_gvariant(result);
+		return 0;
+	case FORMAT_TEXT:
+		break;
+	}
+
 	g_variant_get(result, "a{sv}", &iter);
 
 	while (g_variant_iter_loop(iter, "{sv}", &key, &value)) {
@@ -446,89 +1130,308 @@ print_current(GVariant *result)
 		g_free(tmp);
 	}
 
-	if (album || year || genre)
-		print("%s%s%s%s%s",
-		      album ? album : "",
-		      album && year ? " " : "",
-		      year ? year : "",
-		      (album && genre) || (year && genre) ? " - " : "",
-		      genre ? genre : "");
+	if (album || year || genre)
+		print("%s%s%s%s%s",
+		      album ? album : "",
+		      album && year ? " " : "",
+		      year ? year : "",
+		      (album && genre) || (year && genre) ? " - " : "",
+		      genre ? genre : "");
+
+	/* Freedom for the braves */
+	g_free(uri);
+	g_free(name);
+	g_free(artist);
+	g_free(title);
+	g_free(album);
+	g_free(genre);
+	g_free(year);
+	g_free(comment);
+
+	return 0;
+}
+
+static const char *list_tsv_keys[] = {
+	"uid", "name", "uri", "check-error", NULL
+};
+
+static void
+print_list_station(GVariant *station, guint index)
+{
+	const gchar *uri = NULL;
+	const gchar *name = NULL;
+	const gchar *check_error = NULL;
+
+	switch (output_format) {
+	case FORMAT_JSON:
+		fputs(index == 0 ? "[\n" : ",\n", stdout);
+		write_json_value(station);
+		return;
+	case FORMAT_TSV:
+		write_tsv_record(station, list_tsv_keys);
+		return;
+	case FORMAT_GVARIANT:
+		write_gvariant(station);
+		return;
+	case FORMAT_TEXT:
+		break;
+	}
+
+	g_variant_lookup(station, "uri", "&s", &uri);
+	g_variant_lookup(station, "name", "&s", &name);
+	g_variant_lookup(station, "check-error", "&s", &check_error);
+
+	if (check_error)
+		print(BOLD("%-20s") "%s (unreachable: %s)", name ? name : "",
+		      uri ? uri : "", check_error);
+	else
+		print(BOLD("%-20s") "%s", name ? name : "", uri ? uri : "");
+}
+
+/* Stations are printed one by one, a page is never formatted as a whole */
+static void
+print_list_page(GVariant *result, gchar **cursor, guint *n_stations)
+{
+	GVariantIter *iter;
+	GVariant *station;
+
+	g_variant_get(result, "(aa{sv}s)", &iter, cursor);
+
+	while ((station = g_variant_iter_next_value(iter))) {
+		print_list_station(station, *n_stations);
+		g_variant_unref(station);
+		(*n_stations)++;
+	}
+
+	g_variant_iter_free(iter);
+}
+
+int
+print_list_result(GVariant *result)
+{
+	guint n_stations = 0;
+	gchar *cursor;
+	int err = 0;
+
+	/* Print pages as they come, until there's no more cursor */
+	print_list_page(result, &cursor, &n_stations);
+
+	while (cursor[0] != '\0') {
+		GVariantBuilder b;
+		GVariant *page;
+
+		g_variant_builder_init(&b, G_VARIANT_TYPE_TUPLE);
+		add_list_args(&b, cursor);
+		g_free(cursor);
+		cursor = NULL;
+
+		err = dbus_call(DBUS_NAME, DBUS_PATH, DBUS_STATIONS_IFACE, "List",
+		                g_variant_builder_end(&b), &page);
+		if (err)
+			break;
+
+		print_list_page(page, &cursor, &n_stations);
+		g_variant_unref(page);
+	}
+
+	g_free(cursor);
+
+	/* Close the json array, even if a page is missing, so that the output
+	 * remains valid. The failure is reported afterwards.
+	 */
+	if (output_format == FORMAT_JSON)
+		fputs(n_stations == 0 ? "[]\n" : "\n]\n", stdout);
+
+	if (err)
+		print_err("The station list is incomplete");
+
+	return err;
+}
+
+int
+print_import_result(GVariant *result)
+{
+	GVariantIter *iter;
+	const gchar *error;
+	guint n_imported;
+	guint i;
+
+	g_variant_get(result, "(as)", &iter);
+
+	n_imported = 0;
+	for (i = 0; g_variant_iter_next(iter, "&s", &error); i++) {
+		if (error[0] == '\0')
+			n_imported++;
+		else if (i < import_list.uris->len)
+			print_err("Failed to import '%s': %s",
+			          (gchar *) g_ptr_array_index(import_list.uris, i), error);
+	}
+
+	g_variant_iter_free(iter);
+
+	print("%u station(s) imported", n_imported);
+
+	return 0;
+}
+
+int
+print_history_result(GVariant *result)
+{
+	GVariantIter *iter1;
+	GVariantIter *iter2;
+	GVariant *value;
+	gchar *key;
+
+	g_variant_get(result, "(aa{sv})", &iter1);
+
+	while (g_variant_iter_loop(iter1, "a{sv}", &iter2)) {
+		GDateTime *date_time;
+		gchar *date;
+		gint64 timestamp = 0;
+		gchar *uri = NULL;
+		gchar *name = NULL;
+		gchar *title = NULL;
+		gchar *artist = NULL;
+
+		while (g_variant_iter_loop(iter2, "{sv}", &key, &value)) {
+			if (!g_strcmp0(key, "time"))
+				g_variant_get(value, "x", &timestamp);
+			else if (!g_strcmp0(key, "uri"))
+				g_variant_get(value, "s", &uri);
+			else if (!g_strcmp0(key, "name"))
+				g_variant_get(value, "s", &name);
+			else if (!g_strcmp0(key, "title"))
+				g_variant_get(value, "s", &title);
+			else if (!g_strcmp0(key, "artist"))
+				g_variant_get(value, "s", &artist);
+		}
+
+		date_time = g_date_time_new_from_unix_local(timestamp);
+		date = g_date_time_format(date_time, "%Y-%m-%d %H:%M");
+
+		print("%s  " BOLD("%-20s") "%s%s%s",
+		      date,
+		      name ? name : uri ? uri : "",
+		      title ? title : "",
+		      title && artist ? " - " : "",
+		      artist ? artist : "");
+
+		g_free(date);
+		g_date_time_unref(date_time);
+		g_free(uri);
+		g_free(name);
+		g_free(title);
+		g_free(artist);
+	}
+
+	g_variant_iter_free(iter1);
 
-	/* Freedom for the braves */
-	g_free(uri);
-	g_free(name);
-	g_free(artist);
-	g_free(title);
-	g_free(album);
-	g_free(genre);
-	g_free(year);
-	g_free(comment);
+	return 0;
 }
 
-void
-print_list_result(GVariant *result)
+int
+print_search_result(GVariant *result)
 {
 	GVariantIter *iter1;
 	GVariantIter *iter2;
 	GVariant *value;
 	gchar *key;
+	guint n_results;
+	guint total;
 
-	g_variant_get(result, "(aa{sv})", &iter1);
+	g_variant_get(result, "(aa{sv}u)", &iter1, &total);
+	n_results = g_variant_iter_n_children(iter1);
 
 	while (g_variant_iter_loop(iter1, "a{sv}", &iter2)) {
+		gchar *type = NULL;
 		gchar *uri = NULL;
 		gchar *name = NULL;
+		gchar *title = NULL;
+		gchar *artist = NULL;
 
 		while (g_variant_iter_loop(iter2, "{sv}", &key, &value)) {
-			if (!g_strcmp0(key, "uri"))
+			if (!g_strcmp0(key, "type"))
+				g_variant_get(value, "s", &type);
+			else if (!g_strcmp0(key, "uri"))
 				g_variant_get(value, "s", &uri);
 			else if (!g_strcmp0(key, "name"))
 				g_variant_get(value, "s", &name);
+			else if (!g_strcmp0(key, "title"))
+				g_variant_get(value, "s", &title);
+			else if (!g_strcmp0(key, "artist"))
+				g_variant_get(value, "s", &artist);
 		}
 
-		print(BOLD("%-20s") "%s", name ? name : "", uri);
+		if (!g_strcmp0(type, "station"))
+			print(BOLD("%-20s") "%s", name ? name : "", uri ? uri : "");
+		else
+			print("%s%s%s (%s)",
+			      title ? title : "",
+			      title && artist ? " - " : "",
+			      artist ? artist : "",
+			      name ? name : uri ? uri : "");
 
+		g_free(type);
 		g_free(uri);
 		g_free(name);
+		g_free(title);
+		g_free(artist);
 	}
 
 	g_variant_iter_free(iter1);
+
+	if (total > n_results)
+		print("... and %u more", total - n_results);
+
+	return 0;
 }
 
 struct cmd root_cmds[] = {
-	{ METHOD, "quit", "Quit", NULL, NULL },
-	{ METHOD, NULL,   NULL,   NULL, NULL }
+	{ METHOD,   "quit",  "Quit",  NULL, NULL,       FALSE },
+	{ PROPERTY, "zones", "Zones", NULL, print_strv, FALSE },
+	{ METHOD,   NULL,    NULL,    NULL, NULL,       FALSE }
 };
 
 struct cmd player_cmds[] = {
-	{ METHOD,   "play",      "Play",     parse_play_args, NULL          },
-	{ METHOD,   "stop",      "Stop",     NULL,            NULL          },
-	{ METHOD,   "play-stop", "PlayStop", NULL,            NULL          },
-	{ METHOD,   "next",      "Next",     NULL,            NULL          },
-	{ METHOD,   "prev",      "Previous", NULL,            NULL          },
-	{ METHOD,   "previous",  "Previous", NULL,            NULL          },
-	{ PROPERTY, "current",   "Current",  NULL,            print_current },
-	{ PROPERTY, "playing",   "Playing",  NULL,            print_boolean },
-	{ PROPERTY, "repeat",    "Repeat",   parse_boolean,   print_boolean },
-	{ PROPERTY, "shuffle",   "Shuffle",  parse_boolean,   print_boolean },
-	{ PROPERTY, "volume",    "Volume",   parse_volume,    print_volume  },
-	{ PROPERTY, "mute",      "Mute",     parse_boolean,   print_boolean },
-	{ PROPERTY, NULL,        NULL,       NULL,            NULL          }
+	{ METHOD,   "play",      "Play",     parse_play_args, NULL,          FALSE },
+	{ METHOD,   "stop",      "Stop",     NULL,            NULL,          FALSE },
+	{ METHOD,   "play-stop", "PlayStop", NULL,            NULL,          FALSE },
+	{ METHOD,   "next",      "Next",     NULL,            NULL,          FALSE },
+	{ METHOD,   "prev",      "Previous", NULL,            NULL,          FALSE },
+	{ METHOD,   "previous",  "Previous", NULL,            NULL,          FALSE },
+	{ PROPERTY, "current",   "Current",  NULL,            print_current, FALSE },
+	{ PROPERTY, "playing",   "Playing",  NULL,            print_boolean, FALSE },
+	{ PROPERTY, "repeat",    "Repeat",   parse_boolean,   print_boolean, FALSE },
+	{ PROPERTY, "shuffle",   "Shuffle",  parse_boolean,   print_boolean, FALSE },
+	{ PROPERTY, "volume",    "Volume",   parse_volume,    print_volume,  FALSE },
+	{ PROPERTY, "mute",      "Mute",     parse_boolean,   print_boolean, FALSE },
+	{ METHOD,   "record",      "StartRecording", NULL,    NULL,          FALSE },
+	{ METHOD,   "record-stop", "StopRecording",  NULL,    NULL,          FALSE },
+	{ PROPERTY, "recording",   "Recording",      NULL,    print_boolean, FALSE },
+	{ PROPERTY, NULL,        NULL,       NULL,            NULL,          FALSE }
 };
 
 struct cmd stations_cmds[] = {
-	{ METHOD,   "list",    "List",   NULL,              print_list_result },
-	{ METHOD,   "add",     "Add",    parse_add_args,    NULL              },
-	{ METHOD,   "remove",  "Remove", parse_remove_args, NULL              },
-	{ METHOD,   "rename",  "Rename", parse_rename_args, NULL              },
-	{ METHOD,   "move",    "Move",   parse_move_args,   NULL              },
-	{ METHOD,   NULL,      NULL,     NULL,              NULL              }
+	{ METHOD,   "list",    "List",    parse_list_args,   print_list_result,   TRUE  },
+	{ METHOD,   "add",     "Add",     parse_add_args,    NULL,                FALSE },
+	{ METHOD,   "remove",  "Remove",  parse_remove_args, NULL,                FALSE },
+	{ METHOD,   "rename",  "Rename",  parse_rename_args, NULL,                FALSE },
+	{ METHOD,   "move",    "Move",    parse_move_args,   NULL,                FALSE },
+	{ METHOD,   "import",  "AddMany", parse_import_args, print_import_result, TRUE  },
+	{ METHOD,   "search",  "Search",  parse_search_args, print_search_result, FALSE },
+	{ METHOD,   NULL,      NULL,      NULL,              NULL,                FALSE }
+};
+
+struct cmd history_cmds[] = {
+	{ METHOD,   "history", "Query",  parse_history_args, print_history_result, FALSE },
+	{ METHOD,   NULL,      NULL,     NULL,               NULL,                 FALSE }
 };
 
 struct interface interfaces[] = {
 	{ DBUS_ROOT_IFACE,     root_cmds     },
 	{ DBUS_PLAYER_IFACE,   player_cmds   },
 	{ DBUS_STATIONS_IFACE, stations_cmds },
+	{ DBUS_HISTORY_IFACE,  history_cmds  },
 	{ NULL,                NULL          }
 };
 
@@ -588,14 +1491,50 @@ handle_is_running(int argc, char *argv[] G_GNUC_UNUSED)
 	return err;
 }
 
+/* Copy of gv_core_make_zone_id(), both must stay identical */
+static gchar *
+make_zone_id(const gchar *zone)
+{
+	return g_strcanon(g_strdup(zone),
+	                  "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	                  "abcdefghijklmnopqrstuvwxyz"
+	                  "0123456789_", '_');
+}
+
+static char *
+make_zone_path(const char *zone)
+{
+	gchar *id;
+	gchar *path;
+
+	id = make_zone_id(zone);
+	path = g_strdup_printf("%s/Zones/%s", DBUS_PATH, id);
+	g_free(id);
+
+	return path;
+}
+
+/* A DBus action (method call, property get/set), ready to be sent */
+struct dbus_request {
+	const struct cmd *cmd;
+	const char *iface_name;
+	const char *method_name;
+	GVariant *args;
+	/* Whether it's a property get */
+	gboolean get;
+};
+
 static int
-handle_dbus_command(int argc, char *argv[])
+make_dbus_request(const char *path, int argc, char *argv[], struct dbus_request *req)
 {
 	struct interface *iface;
 	const struct cmd *cmd;
-	GVariant *args, *result;
+	GVariant *args;
 	int err = 0;
 
+	if (argc < 1)
+		return -1;
+
 	/* Find command in lists */
 	for (iface = interfaces; iface->name; iface++) {
 		for (cmd = iface->cmds; cmd->cmdline_name; cmd++) {
@@ -607,7 +1546,11 @@ handle_dbus_command(int argc, char *argv[])
 	}
 
 	if (iface->name == NULL)
-		help_and_exit(EXIT_FAILURE);
+		return -1;
+
+	/* Zones only implement the player interface */
+	if (strcmp(path, DBUS_PATH) && strcmp(iface->name, DBUS_PLAYER_IFACE))
+		return -1;
 
 	/* Discard arguments that has been processed */
 	argc -= 1;
@@ -626,7 +1569,7 @@ handle_dbus_command(int argc, char *argv[])
 			err = cmd->parse_args(argc, argv, &b);
 			args = g_variant_builder_end(&b);
 		} else if (argc > 0) {
-			help_and_exit(EXIT_FAILURE);
+			err = -1;
 		}
 		break;
 
@@ -643,7 +1586,7 @@ handle_dbus_command(int argc, char *argv[])
 			if (cmd->parse_args)
 				err = cmd->parse_args(argc, argv, &b);
 			else
-				help_and_exit(EXIT_FAILURE);
+				err = -1;
 		}
 
 		args = g_variant_builder_end(&b);
@@ -652,53 +1595,448 @@ handle_dbus_command(int argc, char *argv[])
 	}
 	}
 
-	if (err)
-		help_and_exit(EXIT_FAILURE);
+	if (err) {
+		if (args)
+			g_variant_unref(g_variant_ref_sink(args));
+		return err;
+	}
+
+	req->cmd = cmd;
+	req->args = args;
+	req->get = FALSE;
 
-	/* DBus action (method call, property get/set) */
-	result = NULL;
 	switch (cmd->type) {
 	case METHOD:
-		err = dbus_call(DBUS_NAME, DBUS_PATH, iface->name,
-		                cmd->dbus_name, args, &result);
+		req->iface_name = iface->name;
+		req->method_name = cmd->dbus_name;
 		break;
 	case PROPERTY:
-		if (argc == 0)
-			/* Get command */
-			err = dbus_call(DBUS_NAME, DBUS_PATH,
-			                "org.freedesktop.DBus.Properties",
-			                "Get", args, &result);
-		else
-			/* Set command */
-			err = dbus_call(DBUS_NAME, DBUS_PATH,
-			                "org.freedesktop.DBus.Properties",
-			                "Set", args, NULL);
+		req->iface_name = "org.freedesktop.DBus.Properties";
+		req->method_name = argc == 0 ? "Get" : "Set";
+		req->get = argc == 0;
 		break;
 	}
 
+	return 0;
+}
+
+static int
+print_dbus_result(const struct dbus_request *req, GVariant *result)
+{
+	const struct cmd *cmd = req->cmd;
+	int err = 0;
+
+	if (result == NULL || cmd->print_result == NULL)
+		return 0;
+
+	// print("%s", g_variant_print(result, FALSE));
+
+	if (cmd->type == METHOD) {
+		err = cmd->print_result(result);
+	} else if (req->get) {
+		/* cmd->type == PROPERTY */
+		/* Result is always a GVariant, encapsulated in a tuple */
+		GVariant *tmp;
+		g_variant_get(result, "(v)", &tmp);
+		err = cmd->print_result(tmp);
+		g_variant_unref(tmp);
+	}
+
+	return err;
+}
+
+static int
+handle_dbus_command(const char *path, int argc, char *argv[])
+{
+	struct dbus_request req;
+	GVariant *result;
+	int err;
+
+	err = make_dbus_request(path, argc, argv, &req);
+	if (err == -1)
+		help_and_exit(EXIT_FAILURE);
+	else if (err)
+		return -1;
+
+	/* DBus action (method call, property get/set) */
+	result = NULL;
+	err = dbus_call(DBUS_NAME, path, req.iface_name, req.method_name,
+	                req.args, &result);
 	if (err)
 		exit(EXIT_FAILURE);
 
 	/* Print result */
-	if (result && cmd->print_result) {
-		// print("%s", g_variant_print(result, FALSE));
+	err = print_dbus_result(&req, result);
 
-		if (cmd->type == METHOD) {
-			cmd->print_result(result);
-		} else {
-			/* cmd->type == PROPERTY */
-			/* Result is always a GVariant, encapsulated in a tuple */
-			GVariant *tmp;
-			g_variant_get(result, "(v)", &tmp);
-			cmd->print_result(tmp);
-			g_variant_unref(tmp);
+	if (result)
+		g_variant_unref(result);
+
+	return err;
+}
+
+/*
+ * Batch mode
+ *
+ * Commands are read from stdin, one per line, and sent as they come
+ * without waiting for the replies. Results are printed as they arrive.
+ * Lines that are empty or start with '#' are ignored. A failing command
+ * is reported with its line number, and doesn't stop the batch.
+ */
+
+struct batch {
+	GMainLoop *loop;
+	guint      n_pending;
+	guint      n_errors;
+	gboolean   eof;
+};
+
+static struct batch batch;
+
+struct batch_call {
+	guint line_number;
+	struct dbus_request req;
+};
+
+static void
+batch_check_done(void)
+{
+	if (batch.eof && batch.n_pending == 0)
+		g_main_loop_quit(batch.loop);
+}
+
+static void
+on_batch_call_finished(GObject      *source,
+                       GAsyncResult *res,
+                       gpointer      user_data)
+{
+	struct batch_call *call = user_data;
+	GVariant *result;
+	GError *error = NULL;
+
+	result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), res, &error);
+
+	if (error) {
+		print_err("Line %u:", call->line_number);
+		print_dbus_error(error);
+		g_error_free(error);
+		batch.n_errors++;
+	} else {
+		if (print_dbus_result(&call->req, result) != 0)
+			batch.n_errors++;
+		g_variant_unref(result);
+	}
+
+	g_free(call);
+
+	batch.n_pending--;
+	batch_check_done();
+}
+
+static void
+batch_handle_line(guint line_number, const gchar *line)
+{
+	GDBusConnection *c;
+	struct batch_call *call;
+	const char *path;
+	char *zone_path = NULL;
+	gchar **argv;
+	gint argc;
+	GError *error = NULL;
+	int err;
+
+	/* Skip empty lines and comments */
+	while (isspace((unsigned char) *line))
+		line++;
+
+	if (*line == '\0' || *line == '#')
+		return;
+
+	if (!g_shell_parse_argv(line, &argc, &argv, &error)) {
+		print_err("Line %u: %s", line_number, error->message);
+		g_error_free(error);
+		batch.n_errors++;
+		return;
+	}
+
+	/* Commands might be sent to a zone */
+	path = DBUS_PATH;
+	if (argc >= 3 && !strcmp(argv[0], "zone")) {
+		zone_path = make_zone_path(argv[1]);
+		path = zone_path;
+	}
+
+	call = g_new0(struct batch_call, 1);
+	call->line_number = line_number;
+
+	err = make_dbus_request(path, zone_path ? argc - 2 : argc,
+	                        zone_path ? argv + 2 : argv, &call->req);
+	if (err) {
+		if (err == -1)
+			print_err("Line %u: invalid command '%s'", line_number, line);
+		else
+			print_err("Line %u: command '%s' failed", line_number, line);
+		batch.n_errors++;
+		g_free(call);
+		goto out;
+	}
+
+	/* The connection was opened before reading stdin */
+	c = dbus_get_connection();
+	g_assert(c != NULL);
+
+	/* Some commands keep a state between the call and the printing of the
+	 * result, they can't be pipelined with others of the same kind. Just
+	 * wait for everything in flight, and send it synchronously.
+	 */
+	if (call->req.cmd->stateful) {
+		GVariant *result = NULL;
+
+		while (batch.n_pending > 0)
+			g_main_context_iteration(NULL, TRUE);
+
+		err = dbus_call(DBUS_NAME, path, call->req.iface_name,
+		                call->req.method_name, call->req.args, &result);
+		if (err == 0) {
+			err = print_dbus_result(&call->req, result);
+			if (result)
+				g_variant_unref(result);
 		}
+
+		if (err) {
+			print_err("Line %u: command '%s' failed", line_number, line);
+			batch.n_errors++;
+		}
+
+		g_free(call);
+		goto out;
 	}
 
-	if (result)
-		g_variant_unref(result);
+	batch.n_pending++;
+	g_dbus_connection_call(c, DBUS_NAME, path, call->req.iface_name,
+	                       call->req.method_name, call->req.args, NULL,
+	                       G_DBUS_CALL_FLAGS_NO_AUTO_START, -1, NULL,
+	                       on_batch_call_finished, call);
 
-	return 0;
+out:
+	g_free(zone_path);
+	g_strfreev(argv);
+}
+
+static gboolean
+on_batch_input(GIOChannel   *channel,
+               GIOCondition  condition G_GNUC_UNUSED,
+               gpointer      user_data G_GNUC_UNUSED)
+{
+	static guint line_number;
+	GIOStatus status;
+	GError *error = NULL;
+	gchar *line;
+
+	status = g_io_channel_read_line(channel, &line, NULL, NULL, &error);
+
+	switch (status) {
+	case G_IO_STATUS_NORMAL:
+		line_number++;
+		g_strchomp(line);
+		batch_handle_line(line_number, line);
+		g_free(line);
+		return G_SOURCE_CONTINUE;
+
+	case G_IO_STATUS_AGAIN:
+		return G_SOURCE_CONTINUE;
+
+	case G_IO_STATUS_ERROR:
+		print_err("Failed to read stdin: %s", error->message);
+		g_error_free(error);
+		batch.n_errors++;
+		break;
+
+	case G_IO_STATUS_EOF:
+		break;
+	}
+
+	batch.eof = TRUE;
+	batch_check_done();
+
+	return G_SOURCE_REMOVE;
+}
+
+static int
+handle_batch(int argc, char *argv[] G_GNUC_UNUSED)
+{
+	GIOChannel *channel;
+
+	if (argc != 0)
+		help_and_exit(EXIT_FAILURE);
+
+	if (dbus_get_connection() == NULL)
+		return -1;
+
+	stdin_busy = TRUE;
+	channel = g_io_channel_unix_new(fileno(stdin));
+	g_io_channel_set_encoding(channel, NULL, NULL);
+	g_io_add_watch(channel, G_IO_IN | G_IO_HUP | G_IO_ERR, on_batch_input, NULL);
+
+	batch.loop = g_main_loop_new(NULL, FALSE);
+	g_main_loop_run(batch.loop);
+	g_main_loop_unref(batch.loop);
+
+	g_io_channel_unref(channel);
+
+	return batch.n_errors > 0 ? -1 : 0;
+}
+
+/*
+ * Watch mode
+ *
+ * Signals are filtered by the bus daemon through match rules, so that we
+ * only wake up when something we care about happens.
+ */
+
+struct watch {
+	GMainLoop *loop;
+	gboolean json;
+	gchar **properties;
+	int err;
+};
+
+static struct watch watch;
+
+static void
+print_watch_event(const gchar *name, GVariant *value)
+{
+	if (watch.json) {
+		fputs("{\"event\":", stdout);
+		write_json_string(name);
+		fputs(",\"value\":", stdout);
+		write_json_value(value);
+		fputs("}\n", stdout);
+	} else {
+		gchar *str;
+
+		str = g_variant_print(value, FALSE);
+		print("%s %s", name, str);
+		g_free(str);
+	}
+
+	fflush(stdout);
+}
+
+static void
+on_watch_properties_changed(GDBusConnection *connection G_GNUC_UNUSED,
+                            const gchar     *sender_name G_GNUC_UNUSED,
+                            const gchar     *object_path G_GNUC_UNUSED,
+                            const gchar     *interface_name G_GNUC_UNUSED,
+                            const gchar     *signal_name G_GNUC_UNUSED,
+                            GVariant        *parameters,
+                            gpointer         user_data G_GNUC_UNUSED)
+{
+	GVariantIter *iter;
+	const gchar *property;
+	GVariant *value;
+
+	if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(sa{sv}as)")))
+		return;
+
+	g_variant_get(parameters, "(&sa{sv}as)", NULL, &iter, NULL);
+	while (g_variant_iter_next(iter, "{&sv}", &property, &value)) {
+		if (watch.properties == NULL ||
+		    g_strv_contains((const gchar * const *) watch.properties, property))
+			print_watch_event(property, value);
+		g_variant_unref(value);
+	}
+	g_variant_iter_free(iter);
+}
+
+static void
+on_watch_stations_changed(GDBusConnection *connection G_GNUC_UNUSED,
+                          const gchar     *sender_name G_GNUC_UNUSED,
+                          const gchar     *object_path G_GNUC_UNUSED,
+                          const gchar     *interface_name G_GNUC_UNUSED,
+                          const gchar     *signal_name,
+                          GVariant        *parameters,
+                          gpointer         user_data G_GNUC_UNUSED)
+{
+	GVariant *revision;
+
+	if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(t)")))
+		return;
+
+	if (watch.properties &&
+	    !g_strv_contains((const gchar * const *) watch.properties, signal_name))
+		return;
+
+	revision = g_variant_get_child_value(parameters, 0);
+	print_watch_event(signal_name, revision);
+	g_variant_unref(revision);
+}
+
+static void
+on_watch_name_vanished(GDBusConnection *connection G_GNUC_UNUSED,
+                       const gchar     *name G_GNUC_UNUSED,
+                       gpointer         user_data G_GNUC_UNUSED)
+{
+	print_err(PACKAGE_CAMEL_NAME " is not running !");
+	watch.err = -1;
+	g_main_loop_quit(watch.loop);
+}
+
+static int
+handle_watch(int argc, char *argv[])
+{
+	GDBusConnection *c;
+	guint properties_id, stations_id, name_id;
+	GPtrArray *properties;
+	int i;
+
+	watch.json = output_format == FORMAT_JSON;
+
+	properties = g_ptr_array_new();
+	for (i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--json"))
+			watch.json = TRUE;
+		else
+			g_ptr_array_add(properties, argv[i]);
+	}
+
+	if (properties->len > 0) {
+		g_ptr_array_add(properties, NULL);
+		watch.properties = (gchar **) g_ptr_array_free(properties, FALSE);
+	} else {
+		g_ptr_array_free(properties, TRUE);
+	}
+
+	c = dbus_get_connection();
+	if (c == NULL) {
+		g_free(watch.properties);
+		return -1;
+	}
+
+	/* Only the player interface, the spectrum signal is left out */
+	properties_id = g_dbus_connection_signal_subscribe
+	                (c, DBUS_NAME, "org.freedesktop.DBus.Properties",
+	                 "PropertiesChanged", DBUS_PATH, DBUS_PLAYER_IFACE,
+	                 G_DBUS_SIGNAL_FLAGS_NONE,
+	                 on_watch_properties_changed, NULL, NULL);
+	stations_id = g_dbus_connection_signal_subscribe
+	              (c, DBUS_NAME, DBUS_STATIONS_IFACE,
+	               "StationsChanged", DBUS_PATH, NULL,
+	               G_DBUS_SIGNAL_FLAGS_NONE,
+	               on_watch_stations_changed, NULL, NULL);
+	name_id = g_bus_watch_name_on_connection
+	          (c, DBUS_NAME, G_BUS_NAME_WATCHER_FLAGS_NONE,
+	           NULL, on_watch_name_vanished, NULL, NULL);
+
+	watch.loop = g_main_loop_new(NULL, FALSE);
+	g_main_loop_run(watch.loop);
+	g_main_loop_unref(watch.loop);
+
+	g_bus_unwatch_name(name_id);
+	g_dbus_connection_signal_unsubscribe(c, stations_id);
+	g_dbus_connection_signal_unsubscribe(c, properties_id);
+	g_free(watch.properties);
+
+	return watch.err;
 }
 
 /*
@@ -812,6 +2150,24 @@ main(int argc, char *argv[])
 
 	help_init(argv[0]);
 
+	if (argc < 2)
+		help_and_exit(EXIT_FAILURE);
+
+	/* Output format, must come before the command */
+	if (g_str_has_prefix(argv[1], "--format=")) {
+		if (parse_output_format(argv[1] + strlen("--format=")) != 0)
+			help_and_exit(EXIT_FAILURE);
+
+		argc -= 1;
+		argv += 1;
+	} else if (!strcmp(argv[1], "--format")) {
+		if (argc < 3 || parse_output_format(argv[2]) != 0)
+			help_and_exit(EXIT_FAILURE);
+
+		argc -= 2;
+		argv += 2;
+	}
+
 	if (argc < 2)
 		help_and_exit(EXIT_FAILURE);
 
@@ -826,6 +2182,20 @@ main(int argc, char *argv[])
 
 		err = handle_launch(argc, argv);
 
+	} else if (!strcmp(argv[1], "--batch")) {
+		/* Batch mode, commands are read from stdin */
+		argc -= 2;
+		argv += 2;
+
+		err = handle_batch(argc, argv);
+
+	} else if (!strcmp(argv[1], "watch")) {
+		/* Watch mode, events are printed as they happen */
+		argc -= 2;
+		argv += 2;
+
+		err = handle_watch(argc, argv);
+
 	} else if (!strcmp(argv[1], "is-running")) {
 		/* Launch commmand */
 		argc -= 2;
@@ -840,13 +2210,31 @@ main(int argc, char *argv[])
 
 		err = handle_conf_command(argc, argv);
 
+	} else if (!strcmp(argv[1], "zone")) {
+		/* DBus related command, sent to a zone */
+		char *path;
+
+		if (argc < 4)
+			help_and_exit(EXIT_FAILURE);
+
+		path = make_zone_path(argv[2]);
+
+		argc -= 3;
+		argv += 3;
+
+		err = handle_dbus_command(path, argc, argv);
+
+		g_free(path);
+
 	} else {
 		/* DBus related command */
 		argc -= 1;
 		argv += 1;
 
-		err = handle_dbus_command(argc, argv);
+		err = handle_dbus_command(DBUS_PATH, argc, argv);
 	}
 
+	dbus_cleanup();
+
 	return err ? EXIT_FAILURE : EXIT_SUCCESS;
 }
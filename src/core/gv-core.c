@@ -23,16 +23,28 @@
 #include "framework/gv-framework.h"
 
 #include "core/gv-engine.h"
+#include "core/gv-health-checker.h"
+#include "core/gv-history.h"
 #include "core/gv-player.h"
+#include "core/gv-preconnect.h"
+#include "core/gv-recorder.h"
+#include "core/gv-search.h"
 #include "core/gv-station-list.h"
 
 GApplication  *gv_core_application;
 GSettings     *gv_core_settings;
 
 GvStationList *gv_core_station_list;
+GvEngine      *gv_core_engine;
 GvPlayer      *gv_core_player;
+GvRecorder    *gv_core_recorder;
+GvHistory     *gv_core_history;
+GvSearch      *gv_core_search;
+GvPreconnect  *gv_core_preconnect;
+GvHealthChecker *gv_core_health_checker;
+GList         *gv_core_zones;
 
-static GvEngine *gv_core_engine;
+static GList   *gv_core_zone_engines;
 
 gchar         *gv_core_user_agent;
 
@@ -82,10 +94,69 @@ make_user_agent(void)
 	                       "Linux");
 }
 
+static void
+create_zones(void)
+{
+	GVariant *zones;
+	GVariantIter iter;
+	GHashTable *zone_ids;
+	const gchar *name;
+	const gchar *audio_sink;
+
+	/* Each zone is a player with its own engine, that plays to its own sink.
+	 * The station list is shared with the main player.
+	 */
+	zones = g_settings_get_value(gv_core_settings, "zones");
+	zone_ids = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	g_variant_iter_init(&iter, zones);
+	while (g_variant_iter_next(&iter, "{&s&s}", &name, &audio_sink)) {
+		GvEngine *engine;
+		GvPlayer *player;
+
+		if (name[0] == '\0') {
+			WARNING("Ignoring zone with empty name");
+			continue;
+		}
+
+		/* Zones are exported on the bus by id, it must be unique */
+		if (!g_hash_table_add(zone_ids, gv_core_make_zone_id(name))) {
+			WARNING("Ignoring zone '%s', its id clashes with another zone", name);
+			continue;
+		}
+
+		DEBUG("Creating zone '%s' with audio sink '%s'", name, audio_sink);
+
+		engine = gv_engine_new_with_audio_sink(audio_sink);
+		gv_framework_register(engine);
+		gv_core_zone_engines = g_list_append(gv_core_zone_engines, engine);
+
+		player = gv_player_new_for_zone(engine, gv_core_station_list, name);
+		gv_framework_register(player);
+		gv_core_zones = g_list_append(gv_core_zones, player);
+	}
+
+	g_hash_table_unref(zone_ids);
+	g_variant_unref(zones);
+}
+
 /*
  * Core public functions
  */
 
+/* Zone ids are the zone names canonicalized to [A-Za-z0-9_], so that they
+ * can be used as an element of a DBus object path. goodvibes-client has its
+ * own copy of this function, both must stay identical.
+ */
+gchar *
+gv_core_make_zone_id(const gchar *zone)
+{
+	return g_strcanon(g_strdup(zone),
+	                  "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	                  "abcdefghijklmnopqrstuvwxyz"
+	                  "0123456789_", '_');
+}
+
 void
 gv_core_quit(void)
 {
@@ -97,6 +168,13 @@ gv_core_cleanup(void)
 {
 	/* Destroy core objects */
 
+	g_list_free_full(gv_core_zones, g_object_unref);
+	g_list_free_full(gv_core_zone_engines, g_object_unref);
+	g_object_unref(gv_core_health_checker);
+	g_object_unref(gv_core_preconnect);
+	g_object_unref(gv_core_search);
+	g_object_unref(gv_core_history);
+	g_object_unref(gv_core_recorder);
 	g_object_unref(gv_core_player);
 	g_object_unref(gv_core_station_list);
 	g_object_unref(gv_core_engine);
@@ -143,4 +221,21 @@ gv_core_init(GApplication *application)
 
 	gv_core_player = gv_player_new(gv_core_engine, gv_core_station_list);
 	gv_framework_register(gv_core_player);
+
+	gv_core_recorder = gv_recorder_new(gv_core_engine);
+	gv_framework_register(gv_core_recorder);
+
+	gv_core_history = gv_history_new(gv_core_player);
+	gv_framework_register(gv_core_history);
+
+	gv_core_search = gv_search_new(gv_core_station_list, gv_core_history);
+	gv_framework_register(gv_core_search);
+
+	gv_core_preconnect = gv_preconnect_new();
+	gv_framework_register(gv_core_preconnect);
+
+	gv_core_health_checker = gv_health_checker_new(gv_core_station_list, gv_core_player);
+	gv_framework_register(gv_core_health_checker);
+
+	create_zones();
 }
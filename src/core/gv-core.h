@@ -27,8 +27,14 @@
 #include <glib.h>
 #include <gio/gio.h>
 
+#include "core/gv-engine.h"
+#include "core/gv-health-checker.h"
+#include "core/gv-history.h"
 #include "core/gv-metadata.h"
 #include "core/gv-player.h"
+#include "core/gv-preconnect.h"
+#include "core/gv-recorder.h"
+#include "core/gv-search.h"
 #include "core/gv-station.h"
 #include "core/gv-station-list.h"
 
@@ -36,8 +42,15 @@
 
 extern GApplication  *gv_core_application;
 
+extern GvEngine      *gv_core_engine;
 extern GvPlayer      *gv_core_player;
+extern GvRecorder    *gv_core_recorder;
+extern GvHistory     *gv_core_history;
+extern GvSearch      *gv_core_search;
+extern GvPreconnect  *gv_core_preconnect;
+extern GvHealthChecker *gv_core_health_checker;
 extern GvStationList *gv_core_station_list;
+extern GList         *gv_core_zones;
 
 /* Functions */
 
@@ -46,6 +59,8 @@ void gv_core_cleanup(void);
 
 void gv_core_quit   (void);
 
+gchar *gv_core_make_zone_id(const gchar *zone);
+
 /*
  * Underlying audio backend
  */
@@ -17,9 +17,13 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+#include <string.h>
+
 #include <glib.h>
 #include <glib-object.h>
 #include <gst/gst.h>
+#include <gst/audio/audio.h>
 #include <gst/audio/streamvolume.h>
 
 #include "additions/glib-object.h"
@@ -27,7 +31,9 @@
 #include "framework/gv-framework.h"
 #include "core/gv-core-enum-types.h"
 #include "core/gv-core-internal.h"
+#include "core/gv-loudness.h"
 #include "core/gv-metadata.h"
+#include "core/gv-ring-buffer.h"
 
 #include "core/gv-engine.h"
 
@@ -35,29 +41,85 @@
 
 //#define DEBUG_GST_TAGS
 //#define DEBUG_GST_STATE_CHANGES
+//#define DEBUG_GST_BUS
 
 /*
  * Properties
  */
 
-#define DEFAULT_VOLUME 1.0
-#define DEFAULT_MUTE   FALSE
+#define DEFAULT_VOLUME                 1.0
+#define DEFAULT_MUTE                   FALSE
+#define DEFAULT_LEVEL_INTERVAL         0
+#define DEFAULT_SILENCE_THRESHOLD      -50.0
+#define DEFAULT_SILENCE_DURATION       0
+#define DEFAULT_LOUDNESS_NORMALIZATION FALSE
+#define DEFAULT_SPECTRUM_BANDS         0
+#define DEFAULT_SPECTRUM_INTERVAL      50
+
+/* Interval used for silence detection, if level metering is disabled */
+#define SILENCE_CHECK_INTERVAL 1000
+
+/* Tags often come in bursts when a new track starts, hence we wait a bit
+ * before turning them into metadata.
+ */
+#define TAGS_DEBOUNCE_DELAY 300   /* ms */
+
+/* Loudness normalization. The target is the one commonly used by
+ * streaming services, a bit louder than EBU R128 broadcast (-23 LUFS).
+ * The gain starts moving after a few seconds, and moves slowly, so that
+ * it's not audible.
+ */
+#define LOUDNESS_TARGET       -18.0   /* LUFS */
+#define LOUDNESS_MIN_GAIN     -20.0   /* dB */
+#define LOUDNESS_MAX_GAIN     12.0    /* dB */
+#define LOUDNESS_MAX_SLOPE    1.0     /* dB per second */
+#define LOUDNESS_MIN_DURATION 3       /* seconds */
+
+/* Spectrum analysis. Magnitudes below the threshold are clamped to it.
+ * The ring buffer can hold a few frames, in case the main loop is late.
+ */
+#define SPECTRUM_MAX_BANDS    1024
+#define SPECTRUM_THRESHOLD    -80     /* dB */
+#define SPECTRUM_RING_FRAMES  8
 
 enum {
 	/* Reserved */
 	PROP_0,
+	/* Construct properties */
+	PROP_AUDIO_SINK,
 	/* Properties - refer to class_init() for more details */
 	PROP_STATE,
 	PROP_VOLUME,
 	PROP_MUTE,
 	PROP_STREAM_URI,
 	PROP_METADATA,
+	PROP_LEVEL_INTERVAL,
+	PROP_SILENCE_THRESHOLD,
+	PROP_SILENCE_DURATION,
+	PROP_SILENT,
+	PROP_LOUDNESS_NORMALIZATION,
+	PROP_NORMALIZATION_GAIN,
+	PROP_SPECTRUM_BANDS,
+	PROP_SPECTRUM_INTERVAL,
 	/* Number of properties */
 	PROP_N
 };
 
 static GParamSpec *properties[PROP_N];
 
+/*
+ * Signals
+ */
+
+enum {
+	SIGNAL_LEVEL,
+	SIGNAL_SPECTRUM,
+	SIGNAL_REBUFFERING,
+	SIGNAL_N
+};
+
+static guint signals[SIGNAL_N];
+
 /*
  * GObject definitions
  */
@@ -65,13 +127,73 @@ static GParamSpec *properties[PROP_N];
 struct _GvEnginePrivate {
 	/* GStreamer stuff */
 	GstElement     *playbin;
+	GstElement     *level;
+	GstElement     *volume;
+	GstElement     *spectrum;
 	GstBus         *bus;
+	/* Construct-only properties */
+	gchar          *audio_sink;
 	/* Properties */
 	GvEngineState  state;
 	gdouble         volume;
 	gboolean        mute;
 	gchar          *stream_uri;
 	GvMetadata    *metadata;
+	guint           level_interval;
+	gdouble         silence_threshold;
+	guint           silence_duration;
+	gboolean        silent;
+	gboolean        loudness_normalization;
+	gdouble         normalization_gain;
+	guint           spectrum_bands;
+	guint           spectrum_interval;
+	/* Silence detection */
+	GstClockTime    silence_time;
+	/* Buffer ran low while playing */
+	gboolean        buffer_underrun;
+	/* Metadata debouncing */
+	GstTagList     *pending_tags;
+	guint           pending_tags_id;
+	GstTagList     *metadata_tags;
+	guint           metadata_fingerprint;
+	/* Loudness normalization - streaming thread only */
+	GvLoudness     *loudness;
+	guint64         loudness_frames;
+	guint           loudness_seconds;
+	gdouble         loudness_gain;
+	gdouble         loudness_target_gain;
+	/* Loudness normalization - shared with the main thread */
+	GMutex          loudness_lock;
+	gdouble         loudness_reported_gain;
+	guint           loudness_idle_id;
+	/* Spectrum - the streaming thread writes to the ring buffer,
+	 * and the main thread reads from it.
+	 */
+	GvRingBuffer   *spectrum_ring;
+	gfloat         *spectrum_frame;
+	guint           spectrum_timeout_id;
+	/* Stream taps */
+	GMutex          taps_lock;
+	GArray         *taps;
+	gint            n_taps;
+	/* Bus messages - shared with the streaming threads */
+	GMutex          bus_lock;
+	GQueue          bus_queue;
+	GList          *bus_buffering_link;
+	GstTagList     *bus_last_tags;
+	guint           bus_tags_fingerprint;
+	guint           bus_serial;
+	guint           bus_idle_id;
+#ifdef DEBUG_GST_BUS
+	guint           bus_n_received;
+	guint           bus_n_queued;
+	guint           bus_n_dispatches;
+	gint64          bus_stats_time;
+#endif
+	/* Shoutcast metadata stripping - streaming thread only */
+	guint           icy_metaint;
+	guint           icy_audio_left;
+	guint           icy_meta_left;
 };
 
 typedef struct _GvEnginePrivate GvEnginePrivate;
@@ -87,6 +209,11 @@ G_DEFINE_TYPE_WITH_CODE(GvEngine, gv_engine, G_TYPE_OBJECT,
                         G_ADD_PRIVATE(GvEngine)
                         G_IMPLEMENT_INTERFACE(GV_TYPE_ERRORABLE, NULL))
 
+typedef struct {
+	GvEngineTapFunc func;
+	gpointer        data;
+} GvEngineTap;
+
 /*
  * GStreamer helpers
  */
@@ -154,6 +281,81 @@ get_gst_state(GstElement *playbin)
 }
 #endif
 
+/* Tags that end up in the metadata, see taglist_to_metadata() */
+static const gchar *const metadata_string_tags[] = {
+	GST_TAG_ARTIST, GST_TAG_TITLE, GST_TAG_ALBUM,
+	GST_TAG_GENRE, GST_TAG_COMMENT, NULL
+};
+
+static gint
+taglist_get_year(const GstTagList *taglist)
+{
+	GDate *date = NULL;
+	gint year = 0;
+
+	if (gst_tag_list_get_date_index(taglist, GST_TAG_DATE, 0, &date)) {
+		if (g_date_valid(date))
+			year = g_date_get_year(date);
+		g_date_free(date);
+	}
+
+	return year;
+}
+
+static guint
+taglist_fingerprint(const GstTagList *taglist)
+{
+	const gchar *const *tag;
+	guint  bitrate = 0;
+	guint  hash = 5381;
+
+	/* Hash the fields that end up in the metadata, see taglist_to_metadata().
+	 * Missing fields are part of the hash as well, so that a string moving
+	 * from one field to another changes the fingerprint.
+	 */
+	for (tag = metadata_string_tags; *tag; tag++) {
+		const gchar *str = NULL;
+
+		gst_tag_list_peek_string_index(taglist, *tag, 0, &str);
+		hash = (hash * 33) ^ (str ? g_str_hash(str) : 0);
+	}
+
+	gst_tag_list_get_uint_index(taglist, GST_TAG_BITRATE, 0, &bitrate);
+	hash = (hash * 33) ^ bitrate;
+
+	hash = (hash * 33) ^ taglist_get_year(taglist);
+
+	return hash;
+}
+
+static gboolean
+taglist_metadata_equal(const GstTagList *taglist1, const GstTagList *taglist2)
+{
+	const gchar *const *tag;
+	guint bitrate1 = 0;
+	guint bitrate2 = 0;
+
+	/* Only the fields that end up in the metadata matter, streams often
+	 * send other tags (codec, audio level...) that change all the time.
+	 */
+	for (tag = metadata_string_tags; *tag; tag++) {
+		const gchar *str1 = NULL;
+		const gchar *str2 = NULL;
+
+		gst_tag_list_peek_string_index(taglist1, *tag, 0, &str1);
+		gst_tag_list_peek_string_index(taglist2, *tag, 0, &str2);
+		if (g_strcmp0(str1, str2))
+			return FALSE;
+	}
+
+	gst_tag_list_get_uint_index(taglist1, GST_TAG_BITRATE, 0, &bitrate1);
+	gst_tag_list_get_uint_index(taglist2, GST_TAG_BITRATE, 0, &bitrate2);
+	if (bitrate1 != bitrate2)
+		return FALSE;
+
+	return taglist_get_year(taglist1) == taglist_get_year(taglist2);
+}
+
 static GvMetadata *
 taglist_to_metadata(GstTagList *taglist)
 {
@@ -178,16 +380,8 @@ taglist_to_metadata(GstTagList *taglist)
 	if (date && g_date_valid(date))
 		year = g_strdup_printf("%d", g_date_get_year(date));
 
-	/* Create new metadata object */
-	metadata = g_object_new(GV_TYPE_METADATA,
-	                        "artist", artist,
-	                        "title", title,
-	                        "album", album,
-	                        "genre", genre,
-	                        "year", year,
-	                        "comment", comment,
-	                        "bitrate", &bitrate,
-	                        NULL);
+	/* Create new metadata */
+	metadata = gv_metadata_new(title, artist, album, genre, year, comment, bitrate);
 
 	/* Freedom for the braves */
 	g_free(year);
@@ -197,10 +391,454 @@ taglist_to_metadata(GstTagList *taglist)
 	return metadata;
 }
 
+/*
+ * Audio filter helpers
+ *
+ * The audio filter is a bin plugged in playbin, made of:
+ * - a level element, for level metering and silence detection.
+ * - a volume element, for loudness normalization. The loudness is measured
+ *   on the samples that go through, and the gain is adjusted accordingly.
+ * - a spectrum element, for visualizers. The magnitudes are picked from the
+ *   bus messages in the streaming thread, and go to the main thread through
+ *   a lock-free ring buffer.
+ * The filter is only plugged if needed, and it's only changed when playback
+ * starts, as playbin doesn't allow to change it on the fly.
+ */
+
+static guint
+get_level_interval(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* Level metering might be wanted for itself, or might be needed
+	 * for silence detection. Returns zero if it's not needed at all.
+	 */
+	if (priv->level_interval > 0)
+		return priv->level_interval;
+
+	if (priv->silence_duration > 0)
+		return SILENCE_CHECK_INTERVAL;
+
+	return 0;
+}
+
+static void
+update_level_interval(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	guint interval = get_level_interval(self);
+
+	/* The interval can be changed while playing */
+	if (priv->level && interval > 0)
+		g_object_set(priv->level, "interval", (guint64) interval * GST_MSECOND, NULL);
+}
+
+static gboolean
+when_idle_notify_normalization_gain(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	gdouble gain;
+
+	g_mutex_lock(&priv->loudness_lock);
+	gain = priv->loudness_reported_gain;
+	priv->loudness_idle_id = 0;
+	g_mutex_unlock(&priv->loudness_lock);
+
+	if (priv->normalization_gain != gain) {
+		priv->normalization_gain = gain;
+		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_NORMALIZATION_GAIN]);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+process_loudness_buffer(GvEngine *self, GstBuffer *buffer)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvLoudness *loudness = priv->loudness;
+	guint rate, channels;
+	gsize n_frames;
+	gdouble max_step;
+	gdouble gain;
+	GstMapInfo map;
+
+	if (loudness == NULL)
+		return;
+
+	if (!gst_buffer_map(buffer, &map, GST_MAP_READ))
+		return;
+
+	rate = gv_loudness_get_rate(loudness);
+	channels = gv_loudness_get_channels(loudness);
+	n_frames = map.size / (channels * sizeof(gfloat));
+
+	gv_loudness_process(loudness, (const gfloat *) map.data, n_frames);
+	gst_buffer_unmap(buffer, &map);
+
+	/* Update the target gain every second, once we have enough data */
+	priv->loudness_frames += n_frames;
+	if (priv->loudness_frames >= rate) {
+		gdouble lufs;
+
+		priv->loudness_frames -= rate;
+		priv->loudness_seconds++;
+
+		if (priv->loudness_seconds >= LOUDNESS_MIN_DURATION &&
+		    gv_loudness_get_integrated(loudness, &lufs))
+			priv->loudness_target_gain = CLAMP(LOUDNESS_TARGET - lufs,
+			                                   LOUDNESS_MIN_GAIN,
+			                                   LOUDNESS_MAX_GAIN);
+	}
+
+	/* Move the gain smoothly toward the target */
+	gain = priv->loudness_gain;
+	max_step = LOUDNESS_MAX_SLOPE * n_frames / rate;
+	if (gain < priv->loudness_target_gain)
+		gain = MIN(gain + max_step, priv->loudness_target_gain);
+	else if (gain > priv->loudness_target_gain)
+		gain = MAX(gain - max_step, priv->loudness_target_gain);
+
+	if (gain == priv->loudness_gain)
+		return;
+
+	priv->loudness_gain = gain;
+	g_object_set(priv->volume, "volume", pow(10.0, gain / 20.0), NULL);
+
+	/* Let the main thread know, now and then */
+	if (ABS(gain - priv->loudness_reported_gain) < 0.1)
+		return;
+
+	g_mutex_lock(&priv->loudness_lock);
+	priv->loudness_reported_gain = gain;
+	if (priv->loudness_idle_id == 0)
+		priv->loudness_idle_id = g_idle_add
+		                         ((GSourceFunc) when_idle_notify_normalization_gain, self);
+	g_mutex_unlock(&priv->loudness_lock);
+}
+
+static GstPadProbeReturn
+on_volume_pad_probe(GstPad          *pad G_GNUC_UNUSED,
+                    GstPadProbeInfo *info,
+                    GvEngine        *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* Invoked from the streaming thread */
+	if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+		process_loudness_buffer(self, GST_PAD_PROBE_INFO_BUFFER(info));
+
+	} else if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+		GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+		GstAudioInfo audio_info;
+		GstCaps *caps;
+
+		if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS)
+			return GST_PAD_PROBE_OK;
+
+		gst_event_parse_caps(event, &caps);
+		if (!gst_audio_info_from_caps(&audio_info, caps))
+			return GST_PAD_PROBE_OK;
+
+		/* The loudness measurement starts over if the format changes */
+		if (priv->loudness &&
+		    gv_loudness_get_rate(priv->loudness) == (guint) GST_AUDIO_INFO_RATE(&audio_info) &&
+		    gv_loudness_get_channels(priv->loudness) == (guint) GST_AUDIO_INFO_CHANNELS(&audio_info))
+			return GST_PAD_PROBE_OK;
+
+		if (priv->loudness)
+			gv_loudness_free(priv->loudness);
+
+		priv->loudness = gv_loudness_new(GST_AUDIO_INFO_RATE(&audio_info),
+		                                 GST_AUDIO_INFO_CHANNELS(&audio_info));
+		priv->loudness_frames = 0;
+		priv->loudness_seconds = 0;
+	}
+
+	return GST_PAD_PROBE_OK;
+}
+
+static void
+reset_loudness(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* Must be called when the pipeline is stopped. Start with the last gain
+	 * known, the measurement starts over though.
+	 */
+	if (priv->loudness)
+		gv_loudness_reset(priv->loudness);
+
+	priv->loudness_frames = 0;
+	priv->loudness_seconds = 0;
+	priv->loudness_gain = priv->normalization_gain;
+	priv->loudness_target_gain = priv->normalization_gain;
+	priv->loudness_reported_gain = priv->normalization_gain;
+
+	if (priv->volume)
+		g_object_set(priv->volume, "volume",
+		             pow(10.0, priv->normalization_gain / 20.0), NULL);
+}
+
+static gboolean
+when_timeout_read_spectrum(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	gboolean got_frame = FALSE;
+	guint n_bands;
+
+	/* Only the latest frame is relevant */
+	while (gv_ring_buffer_read(priv->spectrum_ring, priv->spectrum_frame))
+		got_frame = TRUE;
+
+	if (got_frame == FALSE)
+		return G_SOURCE_CONTINUE;
+
+	n_bands = gv_ring_buffer_get_frame_size(priv->spectrum_ring) / sizeof(gfloat);
+	g_signal_emit(self, signals[SIGNAL_SPECTRUM], 0, n_bands, priv->spectrum_frame);
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+stop_reading_spectrum(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->spectrum_timeout_id) {
+		g_source_remove(priv->spectrum_timeout_id);
+		priv->spectrum_timeout_id = 0;
+	}
+
+	/* Drop the frames left, they belong to the previous stream */
+	if (priv->spectrum_ring)
+		while (gv_ring_buffer_read(priv->spectrum_ring, priv->spectrum_frame))
+			continue;
+}
+
+static void
+start_reading_spectrum(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	stop_reading_spectrum(self);
+
+	if (priv->spectrum_ring == NULL)
+		return;
+
+	priv->spectrum_timeout_id =
+	        g_timeout_add(priv->spectrum_interval,
+	                      (GSourceFunc) when_timeout_read_spectrum, self);
+}
+
+static void
+update_spectrum_interval(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* The interval can be changed while playing */
+	if (priv->spectrum == NULL)
+		return;
+
+	g_object_set(priv->spectrum, "interval",
+	             (guint64) priv->spectrum_interval * GST_MSECOND, NULL);
+
+	if (priv->spectrum_timeout_id)
+		start_reading_spectrum(self);
+}
+
+static void
+reset_spectrum(GvEngine *self, guint n_bands)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* Must be called when the pipeline is stopped */
+	gv_ring_buffer_free(priv->spectrum_ring);
+	priv->spectrum_ring = NULL;
+	g_free(priv->spectrum_frame);
+	priv->spectrum_frame = NULL;
+
+	if (n_bands == 0)
+		return;
+
+	priv->spectrum_ring = gv_ring_buffer_new(SPECTRUM_RING_FRAMES,
+	                                         n_bands * sizeof(gfloat));
+	priv->spectrum_frame = g_new0(gfloat, n_bands);
+}
+
+static GstElement *
+make_audio_filter(GvEngine *self, gboolean with_level, gboolean with_volume,
+                  gboolean with_spectrum)
+{
+	GvEnginePrivate *priv = self->priv;
+	GstElement *bin;
+	GstElement *first = NULL, *last = NULL;
+	GstPad *pad;
+
+	bin = gst_bin_new("audio-filter");
+
+	/* Loudness measurement needs floats */
+	if (with_volume) {
+		GstElement *convert, *capsfilter;
+		GstCaps *caps;
+
+		convert = gst_element_factory_make("audioconvert", NULL);
+		capsfilter = gst_element_factory_make("capsfilter", NULL);
+		caps = gst_caps_new_simple("audio/x-raw",
+		                           "format", G_TYPE_STRING, GST_AUDIO_NE(F32),
+		                           "layout", G_TYPE_STRING, "interleaved",
+		                           NULL);
+		g_object_set(capsfilter, "caps", caps, NULL);
+		gst_caps_unref(caps);
+
+		gst_bin_add_many(GST_BIN(bin), convert, capsfilter, NULL);
+		gst_element_link(convert, capsfilter);
+		first = convert;
+		last = capsfilter;
+	}
+
+	if (with_level) {
+		GstElement *level;
+
+		level = gst_element_factory_make("level", "level");
+		if (level == NULL) {
+			WARNING("Failed to create level element");
+		} else {
+			gst_bin_add(GST_BIN(bin), level);
+			if (last)
+				gst_element_link(last, level);
+			else
+				first = level;
+			last = level;
+			priv->level = g_object_ref(level);
+			update_level_interval(self);
+		}
+	}
+
+	if (with_volume) {
+		GstElement *volume;
+
+		volume = gst_element_factory_make("volume", "normalization");
+		gst_bin_add(GST_BIN(bin), volume);
+		gst_element_link(last, volume);
+		last = volume;
+		priv->volume = g_object_ref(volume);
+
+		pad = gst_element_get_static_pad(volume, "sink");
+		gst_pad_add_probe(pad,
+		                  GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+		                  (GstPadProbeCallback) on_volume_pad_probe, self, NULL);
+		gst_object_unref(pad);
+	}
+
+	if (with_spectrum) {
+		GstElement *spectrum;
+
+		spectrum = gst_element_factory_make("spectrum", "spectrum");
+		if (spectrum == NULL) {
+			WARNING("Failed to create spectrum element");
+		} else {
+			g_object_set(spectrum,
+			             "bands", priv->spectrum_bands,
+			             "threshold", SPECTRUM_THRESHOLD,
+			             "post-messages", TRUE,
+			             "message-magnitude", TRUE,
+			             "message-phase", FALSE,
+			             NULL);
+			gst_bin_add(GST_BIN(bin), spectrum);
+			if (last)
+				gst_element_link(last, spectrum);
+			else
+				first = spectrum;
+			last = spectrum;
+			priv->spectrum = g_object_ref(spectrum);
+			update_spectrum_interval(self);
+		}
+	}
+
+	if (first == NULL) {
+		gst_object_unref(bin);
+		return NULL;
+	}
+
+	/* Expose pads */
+	pad = gst_element_get_static_pad(first, "sink");
+	gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad));
+	gst_object_unref(pad);
+
+	pad = gst_element_get_static_pad(last, "src");
+	gst_element_add_pad(bin, gst_ghost_pad_new("src", pad));
+	gst_object_unref(pad);
+
+	return bin;
+}
+
+static void
+update_audio_filter(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	gboolean with_level = get_level_interval(self) > 0;
+	gboolean with_volume = priv->loudness_normalization;
+	gboolean with_spectrum = priv->spectrum_bands > 0;
+	guint n_bands = 0;
+	GstElement *filter;
+
+	/* Must be called when the pipeline is stopped */
+	if (priv->spectrum_ring)
+		n_bands = gv_ring_buffer_get_frame_size(priv->spectrum_ring) / sizeof(gfloat);
+
+	if (with_level == (priv->level != NULL) &&
+	    with_volume == (priv->volume != NULL) &&
+	    with_spectrum == (priv->spectrum != NULL) &&
+	    n_bands == (priv->spectrum ? priv->spectrum_bands : 0))
+		goto out;
+
+#if GST_CHECK_VERSION(1, 10, 0)
+	/* Drop the current filter */
+	g_clear_object(&priv->level);
+	g_clear_object(&priv->volume);
+	g_clear_object(&priv->spectrum);
+
+	/* Plug a new one - returns floating ref */
+	filter = make_audio_filter(self, with_level, with_volume, with_spectrum);
+	g_object_set(priv->playbin, "audio-filter", filter, NULL);
+
+	/* The spectrum frames must match the number of bands */
+	reset_spectrum(self, priv->spectrum ? priv->spectrum_bands : 0);
+
+	DEBUG("Audio filter: level %s, normalization %s, spectrum %s",
+	      priv->level ? "enabled" : "disabled",
+	      priv->volume ? "enabled" : "disabled",
+	      priv->spectrum ? "enabled" : "disabled");
+#else
+	(void) filter;
+	WARNING("Audio filters need GStreamer >= 1.10");
+#endif
+
+out:
+	reset_loudness(self);
+}
+
 /*
  * Property accessors
  */
 
+static void
+gv_engine_set_audio_sink(GvEngine *self, const gchar *audio_sink)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* This is a construct-only property */
+	g_assert_null(priv->audio_sink);
+	priv->audio_sink = g_strdup(audio_sink);
+}
+
+const gchar *
+gv_engine_get_audio_sink(GvEngine *self)
+{
+	return self->priv->audio_sink;
+}
+
 GvEngineState
 gv_engine_get_state(GvEngine *self)
 {
@@ -267,6 +905,162 @@ gv_engine_get_metadata(GvEngine *self)
 	return self->priv->metadata;
 }
 
+guint
+gv_engine_get_level_interval(GvEngine *self)
+{
+	return self->priv->level_interval;
+}
+
+void
+gv_engine_set_level_interval(GvEngine *self, guint interval)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->level_interval == interval)
+		return;
+
+	priv->level_interval = interval;
+	update_level_interval(self);
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_LEVEL_INTERVAL]);
+}
+
+gdouble
+gv_engine_get_silence_threshold(GvEngine *self)
+{
+	return self->priv->silence_threshold;
+}
+
+void
+gv_engine_set_silence_threshold(GvEngine *self, gdouble threshold)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->silence_threshold == threshold)
+		return;
+
+	priv->silence_threshold = threshold;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SILENCE_THRESHOLD]);
+}
+
+guint
+gv_engine_get_silence_duration(GvEngine *self)
+{
+	return self->priv->silence_duration;
+}
+
+void
+gv_engine_set_silence_duration(GvEngine *self, guint duration)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->silence_duration == duration)
+		return;
+
+	priv->silence_duration = duration;
+	update_level_interval(self);
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SILENCE_DURATION]);
+}
+
+gboolean
+gv_engine_get_silent(GvEngine *self)
+{
+	return self->priv->silent;
+}
+
+gboolean
+gv_engine_get_loudness_normalization(GvEngine *self)
+{
+	return self->priv->loudness_normalization;
+}
+
+void
+gv_engine_set_loudness_normalization(GvEngine *self, gboolean enabled)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* Takes effect on the next play */
+	if (priv->loudness_normalization == enabled)
+		return;
+
+	priv->loudness_normalization = enabled;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_LOUDNESS_NORMALIZATION]);
+}
+
+gdouble
+gv_engine_get_normalization_gain(GvEngine *self)
+{
+	return self->priv->normalization_gain;
+}
+
+void
+gv_engine_set_normalization_gain(GvEngine *self, gdouble gain)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* This is the gain applied when playback starts, then it's adjusted
+	 * according to the loudness measured.
+	 */
+	gain = CLAMP(gain, LOUDNESS_MIN_GAIN, LOUDNESS_MAX_GAIN);
+
+	if (priv->normalization_gain == gain)
+		return;
+
+	priv->normalization_gain = gain;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_NORMALIZATION_GAIN]);
+}
+
+guint
+gv_engine_get_spectrum_bands(GvEngine *self)
+{
+	return self->priv->spectrum_bands;
+}
+
+void
+gv_engine_set_spectrum_bands(GvEngine *self, guint n_bands)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->spectrum_bands == n_bands)
+		return;
+
+	/* Takes effect on the next play */
+	priv->spectrum_bands = n_bands;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SPECTRUM_BANDS]);
+}
+
+guint
+gv_engine_get_spectrum_interval(GvEngine *self)
+{
+	return self->priv->spectrum_interval;
+}
+
+void
+gv_engine_set_spectrum_interval(GvEngine *self, guint interval)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->spectrum_interval == interval)
+		return;
+
+	priv->spectrum_interval = interval;
+	update_spectrum_interval(self);
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SPECTRUM_INTERVAL]);
+}
+
+static void
+gv_engine_set_silent(GvEngine *self, gboolean silent)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	priv->silence_time = 0;
+
+	if (priv->silent == silent)
+		return;
+
+	priv->silent = silent;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SILENT]);
+}
+
 static void
 gv_engine_set_metadata(GvEngine *self, GvMetadata *metadata)
 {
@@ -280,8 +1074,14 @@ gv_engine_set_metadata(GvEngine *self, GvMetadata *metadata)
 	}
 
 	/* Assign */
-	if (g_set_object(&priv->metadata, metadata))
-		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_METADATA]);
+	if (priv->metadata == metadata)
+		return;
+
+	if (priv->metadata)
+		gv_metadata_unref(priv->metadata);
+	priv->metadata = metadata ? gv_metadata_ref(metadata) : NULL;
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_METADATA]);
 }
 
 const gchar *
@@ -321,6 +1121,9 @@ gv_engine_get_property(GObject    *object,
 	TRACE_GET_PROPERTY(object, property_id, value, pspec);
 
 	switch (property_id) {
+	case PROP_AUDIO_SINK:
+		g_value_set_string(value, gv_engine_get_audio_sink(self));
+		break;
 	case PROP_STATE:
 		g_value_set_enum(value, gv_engine_get_state(self));
 		break;
@@ -334,7 +1137,31 @@ gv_engine_get_property(GObject    *object,
 		g_value_set_string(value, gv_engine_get_stream_uri(self));
 		break;
 	case PROP_METADATA:
-		g_value_set_object(value, gv_engine_get_metadata(self));
+		g_value_set_boxed(value, gv_engine_get_metadata(self));
+		break;
+	case PROP_LEVEL_INTERVAL:
+		g_value_set_uint(value, gv_engine_get_level_interval(self));
+		break;
+	case PROP_SILENCE_THRESHOLD:
+		g_value_set_double(value, gv_engine_get_silence_threshold(self));
+		break;
+	case PROP_SILENCE_DURATION:
+		g_value_set_uint(value, gv_engine_get_silence_duration(self));
+		break;
+	case PROP_SILENT:
+		g_value_set_boolean(value, gv_engine_get_silent(self));
+		break;
+	case PROP_LOUDNESS_NORMALIZATION:
+		g_value_set_boolean(value, gv_engine_get_loudness_normalization(self));
+		break;
+	case PROP_NORMALIZATION_GAIN:
+		g_value_set_double(value, gv_engine_get_normalization_gain(self));
+		break;
+	case PROP_SPECTRUM_BANDS:
+		g_value_set_uint(value, gv_engine_get_spectrum_bands(self));
+		break;
+	case PROP_SPECTRUM_INTERVAL:
+		g_value_set_uint(value, gv_engine_get_spectrum_interval(self));
 		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
@@ -353,12 +1180,36 @@ gv_engine_set_property(GObject      *object,
 	TRACE_SET_PROPERTY(object, property_id, value, pspec);
 
 	switch (property_id) {
+	case PROP_AUDIO_SINK:
+		gv_engine_set_audio_sink(self, g_value_get_string(value));
+		break;
 	case PROP_VOLUME:
 		gv_engine_set_volume(self, g_value_get_double(value));
 		break;
 	case PROP_MUTE:
 		gv_engine_set_mute(self, g_value_get_boolean(value));
 		break;
+	case PROP_LEVEL_INTERVAL:
+		gv_engine_set_level_interval(self, g_value_get_uint(value));
+		break;
+	case PROP_SILENCE_THRESHOLD:
+		gv_engine_set_silence_threshold(self, g_value_get_double(value));
+		break;
+	case PROP_SILENCE_DURATION:
+		gv_engine_set_silence_duration(self, g_value_get_uint(value));
+		break;
+	case PROP_LOUDNESS_NORMALIZATION:
+		gv_engine_set_loudness_normalization(self, g_value_get_boolean(value));
+		break;
+	case PROP_NORMALIZATION_GAIN:
+		gv_engine_set_normalization_gain(self, g_value_get_double(value));
+		break;
+	case PROP_SPECTRUM_BANDS:
+		gv_engine_set_spectrum_bands(self, g_value_get_uint(value));
+		break;
+	case PROP_SPECTRUM_INTERVAL:
+		gv_engine_set_spectrum_interval(self, g_value_get_uint(value));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
 		break;
@@ -369,6 +1220,8 @@ gv_engine_set_property(GObject      *object,
  * Public methods
  */
 
+static void flush_bus_messages(GvEngine *self);
+
 void
 gv_engine_play(GvEngine *self, const gchar *uri)
 {
@@ -394,9 +1247,14 @@ gv_engine_play(GvEngine *self, const gchar *uri)
 
 	/* Ensure playback is stopped */
 	set_gst_state(priv->playbin, GST_STATE_NULL);
+	flush_bus_messages(self);
 
-	/* Clear metadata */
+	/* Clear metadata and silence */
 	gv_engine_set_metadata(self, NULL);
+	gv_engine_set_silent(self, FALSE);
+
+	/* Plug audio filters if needed, can only be done when stopped */
+	update_audio_filter(self);
 
 	/* Set the stream uri */
 	g_object_set(priv->playbin, "uri", priv->stream_uri, NULL);
@@ -409,6 +1267,9 @@ gv_engine_play(GvEngine *self, const gchar *uri)
 	 */
 	set_gst_state(priv->playbin, GST_STATE_PAUSED);
 	gv_engine_set_state(self, GV_ENGINE_STATE_CONNECTING);
+
+	/* Pass spectrum frames to the main thread, if any */
+	start_reading_spectrum(self);
 }
 
 void
@@ -418,7 +1279,56 @@ gv_engine_stop(GvEngine *self)
 
 	/* Radical way to stop: set state to NULL */
 	set_gst_state(priv->playbin, GST_STATE_NULL);
+	flush_bus_messages(self);
+	stop_reading_spectrum(self);
 	gv_engine_set_state(self, GV_ENGINE_STATE_STOPPED);
+	gv_engine_set_silent(self, FALSE);
+}
+
+/*
+ * Taps give access to the encoded stream, as it comes out of the source
+ * element, before decoding. Tap functions are invoked from the streaming
+ * thread, so they must be quick and must never block.
+ */
+
+void
+gv_engine_add_tap(GvEngine *self, GvEngineTapFunc func, gpointer user_data)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvEngineTap tap = { func, user_data };
+
+	g_mutex_lock(&priv->taps_lock);
+	g_array_append_val(priv->taps, tap);
+	g_atomic_int_set(&priv->n_taps, priv->taps->len);
+	g_mutex_unlock(&priv->taps_lock);
+}
+
+void
+gv_engine_remove_tap(GvEngine *self, GvEngineTapFunc func, gpointer user_data)
+{
+	GvEnginePrivate *priv = self->priv;
+	gboolean found = FALSE;
+	guint i;
+
+	/* Once we own the lock, we know that no tap is being invoked.
+	 * So after this function returns, the caller can safely free
+	 * the data associated with the tap.
+	 */
+	g_mutex_lock(&priv->taps_lock);
+	for (i = 0; i < priv->taps->len; i++) {
+		GvEngineTap *tap = &g_array_index(priv->taps, GvEngineTap, i);
+
+		if (tap->func == func && tap->data == user_data) {
+			g_array_remove_index(priv->taps, i);
+			found = TRUE;
+			break;
+		}
+	}
+	g_atomic_int_set(&priv->n_taps, priv->taps->len);
+	g_mutex_unlock(&priv->taps_lock);
+
+	if (!found)
+		WARNING("Tap %p not found", func);
 }
 
 GvEngine *
@@ -427,6 +1337,119 @@ gv_engine_new(void)
 	return g_object_new(GV_TYPE_ENGINE, NULL);
 }
 
+GvEngine *
+gv_engine_new_with_audio_sink(const gchar *audio_sink)
+{
+	return g_object_new(GV_TYPE_ENGINE,
+	                    "audio-sink", audio_sink,
+	                    NULL);
+}
+
+/*
+ * Stream taps helpers
+ */
+
+static void
+dispatch_to_taps(GvEngine *self, GstBuffer *buffer)
+{
+	GvEnginePrivate *priv = self->priv;
+	guint i;
+
+	g_mutex_lock(&priv->taps_lock);
+	for (i = 0; i < priv->taps->len; i++) {
+		GvEngineTap *tap = &g_array_index(priv->taps, GvEngineTap, i);
+
+		tap->func(buffer, tap->data);
+	}
+	g_mutex_unlock(&priv->taps_lock);
+}
+
+static void
+process_stream_buffer(GvEngine *self, GstBuffer *buffer)
+{
+	GvEnginePrivate *priv = self->priv;
+	gboolean tapped = g_atomic_int_get(&priv->n_taps) > 0;
+	gsize size = gst_buffer_get_size(buffer);
+	gsize offset = 0;
+
+	/* Plain stream, the buffer can be passed as it is */
+	if (priv->icy_metaint == 0) {
+		if (tapped)
+			dispatch_to_taps(self, buffer);
+		return;
+	}
+
+	/* Shoutcast stream: every 'metaint' bytes of audio, there's a length
+	 * byte, followed by (length * 16) bytes of metadata. We must keep track
+	 * of that even if nobody listens, otherwise we get lost when a tap is
+	 * added in the middle of the stream.
+	 */
+	while (offset < size) {
+		gsize len;
+
+		if (priv->icy_meta_left > 0) {
+			len = MIN(priv->icy_meta_left, size - offset);
+			priv->icy_meta_left -= len;
+			offset += len;
+		} else if (priv->icy_audio_left == 0) {
+			guint8 n_blocks = 0;
+
+			gst_buffer_extract(buffer, offset, &n_blocks, 1);
+			priv->icy_meta_left = n_blocks * 16;
+			priv->icy_audio_left = priv->icy_metaint;
+			offset += 1;
+		} else {
+			len = MIN(priv->icy_audio_left, size - offset);
+			if (tapped) {
+				GstBuffer *audio;
+
+				/* Shares the memory of the parent buffer, no copy involved */
+				audio = gst_buffer_copy_region(buffer, GST_BUFFER_COPY_MEMORY,
+				                               offset, len);
+				dispatch_to_taps(self, audio);
+				gst_buffer_unref(audio);
+			}
+			priv->icy_audio_left -= len;
+			offset += len;
+		}
+	}
+}
+
+static GstPadProbeReturn
+on_source_pad_probe(GstPad          *pad G_GNUC_UNUSED,
+                    GstPadProbeInfo *info,
+                    GvEngine        *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+		process_stream_buffer(self, GST_PAD_PROBE_INFO_BUFFER(info));
+
+	} else if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+		GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+		GstStructure *structure;
+		GstCaps *caps;
+		gint metaint = 0;
+
+		if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS)
+			return GST_PAD_PROBE_OK;
+
+		/* Shoutcast streams come with the metadata interval in the caps */
+		gst_event_parse_caps(event, &caps);
+		structure = gst_caps_get_structure(caps, 0);
+		if (gst_structure_has_name(structure, "application/x-icy"))
+			gst_structure_get_int(structure, "metadata-interval", &metaint);
+
+		DEBUG("Stream caps: %" GST_PTR_FORMAT, caps);
+
+		priv->icy_metaint = metaint > 0 ? metaint : 0;
+		priv->icy_audio_left = priv->icy_metaint;
+		priv->icy_meta_left = 0;
+	}
+
+	return GST_PAD_PROBE_OK;
+}
+
 /*
  * GStreamer playbin signal handlers
  */
@@ -434,9 +1457,11 @@ gv_engine_new(void)
 static void
 on_playbin_source_setup(GstElement *playbin G_GNUC_UNUSED,
                         GstElement *source,
-                        GvEngine   *self G_GNUC_UNUSED)
+                        GvEngine   *self)
 {
+	GvEnginePrivate *priv = self->priv;
 	static gchar *user_agent;
+	GstPad *pad;
 
 	if (user_agent == NULL) {
 		gchar *gst_version;
@@ -447,10 +1472,26 @@ on_playbin_source_setup(GstElement *playbin G_GNUC_UNUSED,
 	}
 
 	g_object_set(source, "user-agent", user_agent, NULL);
+
+	/* Watch the encoded data as it comes out of the source */
+	priv->icy_metaint = 0;
+	priv->icy_audio_left = 0;
+	priv->icy_meta_left = 0;
+
+	pad = gst_element_get_static_pad(source, "src");
+	if (pad == NULL) {
+		DEBUG("Source has no 'src' pad, stream taps won't work");
+		return;
+	}
+
+	gst_pad_add_probe(pad,
+	                  GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+	                  (GstPadProbeCallback) on_source_pad_probe, self, NULL);
+	gst_object_unref(pad);
 }
 
 /*
- * GStreamer bus signal handlers
+ * GStreamer bus message handlers
  */
 
 static gboolean
@@ -630,9 +1671,47 @@ tag_list_foreach_dump(const GstTagList *list, const gchar *tag,
 #endif /* DEBUG_GST_TAGS */
 
 static gboolean
-on_bus_message_tag(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *self)
+when_timeout_apply_pending_tags(GvEngine *self)
 {
+	GvEnginePrivate *priv = self->priv;
+	GstTagList *taglist = priv->pending_tags;
 	GvMetadata *metadata;
+	guint fingerprint;
+
+	priv->pending_tags = NULL;
+	priv->pending_tags_id = 0;
+
+	/* Don't bother creating metadata if nothing changed. The fingerprint
+	 * is only a quick way to tell that the tags differ.
+	 */
+	fingerprint = taglist_fingerprint(taglist);
+	if (priv->metadata && priv->metadata_tags &&
+	    priv->metadata_fingerprint == fingerprint &&
+	    taglist_metadata_equal(priv->metadata_tags, taglist)) {
+		DEBUG("Metadata identical, ignoring...");
+		goto taglist_unref;
+	}
+
+	/* Turn taglist into metadata and assign it */
+	metadata = taglist_to_metadata(taglist);
+	gv_engine_set_metadata(self, metadata);
+	gv_metadata_unref(metadata);
+
+	if (priv->metadata_tags)
+		gst_tag_list_unref(priv->metadata_tags);
+	priv->metadata_tags = gst_tag_list_ref(taglist);
+	priv->metadata_fingerprint = fingerprint;
+
+taglist_unref:
+	gst_tag_list_unref(taglist);
+
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_bus_message_tag(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
 	GstTagList *taglist = NULL;
 	const gchar *tag_title = NULL;
 
@@ -661,10 +1740,18 @@ on_bus_message_tag(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *self)
 		goto taglist_unref;
 	}
 
-	/* Turn taglist into metadata and assign it */
-	metadata = taglist_to_metadata(taglist);
-	gv_engine_set_metadata(self, metadata);
-	g_object_unref(metadata);
+	/* Keep only the latest tags of a burst, they'll be applied when the
+	 * timeout expires. The timeout is not restarted, so that a stream that
+	 * keeps sending tags still gets its metadata updated.
+	 */
+	if (priv->pending_tags)
+		gst_tag_list_unref(priv->pending_tags);
+	priv->pending_tags = gst_tag_list_ref(taglist);
+
+	if (priv->pending_tags_id == 0)
+		priv->pending_tags_id = g_timeout_add(TAGS_DEBOUNCE_DELAY,
+		                                      (GSourceFunc) when_timeout_apply_pending_tags,
+		                                      self);
 
 taglist_unref:
 	/* Unref taglist */
@@ -716,6 +1803,7 @@ on_bus_message_buffering(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *s
 		if (percent >= 100) {
 			DEBUG("Buffering complete, starting playback");
 			set_gst_state(priv->playbin, GST_STATE_PLAYING);
+			priv->buffer_underrun = FALSE;
 			gv_engine_set_state(self, GV_ENGINE_STATE_PLAYING);
 		}
 		break;
@@ -734,6 +1822,17 @@ on_bus_message_buffering(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *s
 			DEBUG("Buffering < 100%%, ignoring instead of setting to pause");
 			//set_gst_state(priv->playbin, GST_STATE_PAUSED);
 			//gv_engine_set_state(self, GV_ENGINE_STATE_BUFFERING);
+
+			/* Playback goes on, but it's still worth telling that the
+			 * buffer ran low. It's told once, until the buffer is full
+			 * again.
+			 */
+			if (priv->buffer_underrun == FALSE) {
+				priv->buffer_underrun = TRUE;
+				g_signal_emit(self, signals[SIGNAL_REBUFFERING], 0);
+			}
+		} else {
+			priv->buffer_underrun = FALSE;
 		}
 		break;
 
@@ -744,6 +1843,102 @@ on_bus_message_buffering(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *s
 	return TRUE;
 }
 
+static gdouble
+get_level_values(const GstStructure *s, const gchar *field, gdouble *values, guint n_values)
+{
+	const GValue *value;
+	GValueArray *array;
+	gdouble max = -G_MAXDOUBLE;
+	guint i;
+
+	/* The level element posts arrays of doubles (in dB), one value per channel.
+	 * GValueArray is deprecated, but that's what the element uses.
+	 */
+	value = gst_structure_get_value(s, field);
+	if (value == NULL)
+		return max;
+
+	G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+	array = g_value_get_boxed(value);
+	for (i = 0; i < n_values && i < array->n_values; i++) {
+		values[i] = g_value_get_double(g_value_array_get_nth(array, i));
+		if (values[i] > max)
+			max = values[i];
+	}
+	G_GNUC_END_IGNORE_DEPRECATIONS
+
+	return max;
+}
+
+static gboolean
+on_bus_message_element(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	const GstStructure *s;
+	const GValue *value;
+	GstClockTime duration;
+	gdouble *rms, *peak;
+	gdouble max_rms;
+	guint n_channels;
+
+	/* We're only interested in level messages */
+	if (priv->level == NULL || GST_MESSAGE_SRC(msg) != GST_OBJECT(priv->level))
+		return TRUE;
+
+	s = gst_message_get_structure(msg);
+	if (!gst_structure_has_name(s, "level"))
+		return TRUE;
+
+	/* Get per-channel values */
+	value = gst_structure_get_value(s, "rms");
+	if (value == NULL)
+		return TRUE;
+
+	G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+	n_channels = ((GValueArray *) g_value_get_boxed(value))->n_values;
+	G_GNUC_END_IGNORE_DEPRECATIONS
+
+	if (n_channels == 0)
+		return TRUE;
+
+	rms = g_newa(gdouble, n_channels);
+	peak = g_newa(gdouble, n_channels);
+	memset(peak, 0, n_channels * sizeof(gdouble));
+
+	max_rms = get_level_values(s, "rms", rms, n_channels);
+	get_level_values(s, "peak", peak, n_channels);
+
+	/* Emit level, if someone asked for it */
+	if (priv->level_interval > 0)
+		g_signal_emit(self, signals[SIGNAL_LEVEL], 0, n_channels, rms, peak);
+
+	/* Silence detection, only relevant while playing */
+	if (priv->silence_duration == 0 || priv->state != GV_ENGINE_STATE_PLAYING)
+		return TRUE;
+
+	if (max_rms >= priv->silence_threshold) {
+		if (priv->silent)
+			INFO("Sound is back");
+		gv_engine_set_silent(self, FALSE);
+		return TRUE;
+	}
+
+	if (priv->silent)
+		return TRUE;
+
+	if (!gst_structure_get_clock_time(s, "duration", &duration))
+		duration = get_level_interval(self) * GST_MSECOND;
+
+	priv->silence_time += duration;
+	if (priv->silence_time >= priv->silence_duration * GST_SECOND) {
+		INFO("No sound for %u seconds (below %.1f dB)",
+		     priv->silence_duration, priv->silence_threshold);
+		gv_engine_set_silent(self, TRUE);
+	}
+
+	return TRUE;
+}
+
 static gboolean
 on_bus_message_state_changed(GstBus *bus G_GNUC_UNUSED, GstMessage *msg,
                              GvEngine *self G_GNUC_UNUSED)
@@ -766,6 +1961,287 @@ on_bus_message_state_changed(GstBus *bus G_GNUC_UNUSED, GstMessage *msg,
 	return TRUE;
 }
 
+/*
+ * GStreamer bus dispatching
+ *
+ * Bus messages are posted from the streaming threads, and some streams
+ * flood the bus with buffering and tag messages. Rather than waking up
+ * the main loop for each of them, a sync handler sorts them out right
+ * away, in the thread that posts them:
+ * - messages that are only logged are handled there and dropped.
+ * - messages we don't care about are dropped.
+ * - buffering messages are collapsed: only the latest percentage of
+ *   those waiting to be dispatched is kept.
+ * - tag messages are dropped if the fields that make the metadata are
+ *   the same as in the previous one.
+ * What's left is queued, and the whole queue is dispatched at once
+ * from the main loop.
+ */
+
+static void
+dispatch_bus_message(GvEngine *self, GstMessage *msg)
+{
+	GstBus *bus = self->priv->bus;
+
+	switch (GST_MESSAGE_TYPE(msg)) {
+	case GST_MESSAGE_EOS:
+		on_bus_message_eos(bus, msg, self);
+		break;
+	case GST_MESSAGE_ERROR:
+		on_bus_message_error(bus, msg, self);
+		break;
+	case GST_MESSAGE_TAG:
+		on_bus_message_tag(bus, msg, self);
+		break;
+	case GST_MESSAGE_BUFFERING:
+		on_bus_message_buffering(bus, msg, self);
+		break;
+	case GST_MESSAGE_ELEMENT:
+		on_bus_message_element(bus, msg, self);
+		break;
+	default:
+		WARNING("Unexpected bus message '%s'", GST_MESSAGE_TYPE_NAME(msg));
+		break;
+	}
+}
+
+static gboolean
+when_idle_dispatch_bus_messages(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GstMessage *msg;
+	GQueue queue;
+	guint serial;
+
+	/* Take all the pending messages at once */
+	g_mutex_lock(&priv->bus_lock);
+	queue = priv->bus_queue;
+	g_queue_init(&priv->bus_queue);
+	priv->bus_buffering_link = NULL;
+	priv->bus_idle_id = 0;
+	serial = priv->bus_serial;
+#ifdef DEBUG_GST_BUS
+	priv->bus_n_dispatches++;
+#endif
+	g_mutex_unlock(&priv->bus_lock);
+
+	/* Dispatch, unless the messages become outdated along the way. This
+	 * happens if a handler causes the playback to be stopped or restarted.
+	 */
+	while ((msg = g_queue_pop_head(&queue)) != NULL) {
+		if (serial == priv->bus_serial)
+			dispatch_bus_message(self, msg);
+		gst_message_unref(msg);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+flush_bus_messages(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* Must be called when the pipeline is stopped, so that the messages
+	 * still waiting to be dispatched are not mistaken for new ones.
+	 */
+	g_mutex_lock(&priv->bus_lock);
+	g_queue_clear_full(&priv->bus_queue, (GDestroyNotify) gst_message_unref);
+	priv->bus_buffering_link = NULL;
+	if (priv->bus_last_tags) {
+		gst_tag_list_unref(priv->bus_last_tags);
+		priv->bus_last_tags = NULL;
+	}
+	if (priv->bus_idle_id) {
+		g_source_remove(priv->bus_idle_id);
+		priv->bus_idle_id = 0;
+	}
+	priv->bus_serial++;
+	g_mutex_unlock(&priv->bus_lock);
+
+	/* Tags waiting to be applied are outdated as well */
+	if (priv->pending_tags_id) {
+		g_source_remove(priv->pending_tags_id);
+		priv->pending_tags_id = 0;
+	}
+	if (priv->pending_tags) {
+		gst_tag_list_unref(priv->pending_tags);
+		priv->pending_tags = NULL;
+	}
+}
+
+static gboolean
+filter_bus_message_tag(GvEngine *self, GstMessage *msg)
+{
+	GvEnginePrivate *priv = self->priv;
+	GstTagList *taglist = NULL;
+	const gchar *title = NULL;
+	gboolean keep = FALSE;
+	guint fingerprint;
+
+	gst_message_parse_tag(msg, &taglist);
+
+	/* Tags without title are discarded anyway, see on_bus_message_tag() */
+	gst_tag_list_peek_string_index(taglist, GST_TAG_TITLE, 0, &title);
+	if (title == NULL)
+		goto taglist_unref;
+
+	/* Keep only if the tags changed since the previous ones. Comparing
+	 * fingerprints first is cheap, and catches most changes.
+	 */
+	fingerprint = taglist_fingerprint(taglist);
+
+	g_mutex_lock(&priv->bus_lock);
+	if (priv->bus_last_tags == NULL ||
+	    priv->bus_tags_fingerprint != fingerprint ||
+	    !taglist_metadata_equal(priv->bus_last_tags, taglist)) {
+		if (priv->bus_last_tags)
+			gst_tag_list_unref(priv->bus_last_tags);
+		priv->bus_last_tags = gst_tag_list_ref(taglist);
+		priv->bus_tags_fingerprint = fingerprint;
+		keep = TRUE;
+	}
+	g_mutex_unlock(&priv->bus_lock);
+
+taglist_unref:
+	gst_tag_list_unref(taglist);
+
+	return keep;
+}
+
+static void
+queue_bus_message(GvEngine *self, GstMessage *msg)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	g_mutex_lock(&priv->bus_lock);
+
+	/* If a buffering message is already waiting, just replace it */
+	if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_BUFFERING) {
+		if (priv->bus_buffering_link) {
+			gst_message_unref(priv->bus_buffering_link->data);
+			priv->bus_buffering_link->data = gst_message_ref(msg);
+			goto unlock;
+		}
+
+		g_queue_push_tail(&priv->bus_queue, gst_message_ref(msg));
+		priv->bus_buffering_link = g_queue_peek_tail_link(&priv->bus_queue);
+	} else {
+		g_queue_push_tail(&priv->bus_queue, gst_message_ref(msg));
+	}
+
+#ifdef DEBUG_GST_BUS
+	priv->bus_n_queued++;
+#endif
+
+	/* Wake up the main loop, if not done already */
+	if (priv->bus_idle_id == 0)
+		priv->bus_idle_id = g_idle_add((GSourceFunc) when_idle_dispatch_bus_messages,
+		                               self);
+
+unlock:
+	g_mutex_unlock(&priv->bus_lock);
+}
+
+#ifdef DEBUG_GST_BUS
+static void
+log_bus_stats(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	gint64 now = g_get_monotonic_time();
+
+	g_mutex_lock(&priv->bus_lock);
+	priv->bus_n_received++;
+	if (priv->bus_stats_time == 0)
+		priv->bus_stats_time = now;
+	if (now - priv->bus_stats_time >= G_USEC_PER_SEC) {
+		DEBUG("Bus messages: %u received, %u queued, %u main loop wakeups",
+		      priv->bus_n_received, priv->bus_n_queued, priv->bus_n_dispatches);
+		priv->bus_n_received = 0;
+		priv->bus_n_queued = 0;
+		priv->bus_n_dispatches = 0;
+		priv->bus_stats_time = now;
+	}
+	g_mutex_unlock(&priv->bus_lock);
+}
+#endif /* DEBUG_GST_BUS */
+
+/* Invoked from the streaming thread, must never block */
+static void
+write_spectrum_frame(GvEngine *self, GstMessage *msg)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvRingBuffer *ring = priv->spectrum_ring;
+	const GstStructure *s;
+	const GValue *magnitudes;
+	gfloat *frame;
+	guint n_bands, i;
+
+	if (ring == NULL)
+		return;
+
+	s = gst_message_get_structure(msg);
+	magnitudes = gst_structure_get_value(s, "magnitude");
+	if (magnitudes == NULL || !GST_VALUE_HOLDS_LIST(magnitudes))
+		return;
+
+	n_bands = gst_value_list_get_size(magnitudes);
+	if (n_bands * sizeof(gfloat) != gv_ring_buffer_get_frame_size(ring))
+		return;
+
+	frame = g_newa(gfloat, n_bands);
+	for (i = 0; i < n_bands; i++)
+		frame[i] = g_value_get_float(gst_value_list_get_value(magnitudes, i));
+
+	/* If the main loop is late, the frame is dropped */
+	gv_ring_buffer_write(ring, frame);
+}
+
+static GstBusSyncReply
+on_bus_sync_message(GstBus *bus, GstMessage *msg, GvEngine *self)
+{
+#ifdef DEBUG_GST_BUS
+	log_bus_stats(self);
+#endif
+
+	switch (GST_MESSAGE_TYPE(msg)) {
+	case GST_MESSAGE_WARNING:
+		on_bus_message_warning(bus, msg, self);
+		return GST_BUS_DROP;
+	case GST_MESSAGE_INFO:
+		on_bus_message_info(bus, msg, self);
+		return GST_BUS_DROP;
+	case GST_MESSAGE_STATE_CHANGED:
+		on_bus_message_state_changed(bus, msg, self);
+		return GST_BUS_DROP;
+	case GST_MESSAGE_TAG:
+		if (filter_bus_message_tag(self, msg) == FALSE)
+			return GST_BUS_DROP;
+		break;
+	case GST_MESSAGE_ELEMENT:
+		/* Spectrum messages don't go through the main loop */
+		if (gst_message_has_name(msg, "spectrum")) {
+			write_spectrum_frame(self, msg);
+			return GST_BUS_DROP;
+		}
+		/* Apart from that, we're only interested in level messages */
+		if (gst_message_has_name(msg, "level") == FALSE)
+			return GST_BUS_DROP;
+		break;
+	case GST_MESSAGE_EOS:
+	case GST_MESSAGE_ERROR:
+	case GST_MESSAGE_BUFFERING:
+		break;
+	default:
+		return GST_BUS_DROP;
+	}
+
+	/* Queue it for the main loop. The bus drops its own reference. */
+	queue_bus_message(self, msg);
+
+	return GST_BUS_DROP;
+}
+
 /*
  * GObject methods
  */
@@ -783,20 +2259,47 @@ gv_engine_finalize(GObject *object)
 
 	/* Unref metadata */
 	if (priv->metadata)
-		g_object_unref(priv->metadata);
+		gv_metadata_unref(priv->metadata);
+	if (priv->metadata_tags)
+		gst_tag_list_unref(priv->metadata_tags);
 
-	/* Free stream uri */
+	/* Free strings */
 	g_free(priv->stream_uri);
+	g_free(priv->audio_sink);
+
+	/* Free taps */
+	g_array_free(priv->taps, TRUE);
+	g_mutex_clear(&priv->taps_lock);
 
 	/* Unref the bus */
-	g_signal_handlers_disconnect_by_data(priv->bus, self);
-	gst_bus_remove_signal_watch(priv->bus);
+	gst_bus_set_sync_handler(priv->bus, NULL, NULL, NULL);
+	flush_bus_messages(self);
+	g_mutex_clear(&priv->bus_lock);
 	g_object_unref(priv->bus);
 
 	/* Unref the playbin */
 	g_signal_handlers_disconnect_by_data(priv->playbin, self);
 	g_object_unref(priv->playbin);
 
+	/* Unref audio filter elements */
+	if (priv->level)
+		g_object_unref(priv->level);
+	if (priv->volume)
+		g_object_unref(priv->volume);
+	if (priv->spectrum)
+		g_object_unref(priv->spectrum);
+
+	/* Free spectrum stuff */
+	stop_reading_spectrum(self);
+	reset_spectrum(self, 0);
+
+	/* Free loudness stuff */
+	if (priv->loudness_idle_id)
+		g_source_remove(priv->loudness_idle_id);
+	if (priv->loudness)
+		gv_loudness_free(priv->loudness);
+	g_mutex_clear(&priv->loudness_lock);
+
 	/* Chain up */
 	G_OBJECT_CHAINUP_FINALIZE(gv_engine, object);
 }
@@ -811,8 +2314,21 @@ gv_engine_constructed(GObject *object)
 	GstBus *bus;
 
 	/* Initialize properties */
-	priv->volume = DEFAULT_VOLUME;
-	priv->mute   = DEFAULT_MUTE;
+	priv->volume                 = DEFAULT_VOLUME;
+	priv->mute                   = DEFAULT_MUTE;
+	priv->level_interval         = DEFAULT_LEVEL_INTERVAL;
+	priv->silence_threshold      = DEFAULT_SILENCE_THRESHOLD;
+	priv->silence_duration       = DEFAULT_SILENCE_DURATION;
+	priv->loudness_normalization = DEFAULT_LOUDNESS_NORMALIZATION;
+	priv->spectrum_bands         = DEFAULT_SPECTRUM_BANDS;
+	priv->spectrum_interval      = DEFAULT_SPECTRUM_INTERVAL;
+
+	/* Initialize loudness stuff */
+	g_mutex_init(&priv->loudness_lock);
+
+	/* Initialize stream taps */
+	g_mutex_init(&priv->taps_lock);
+	priv->taps = g_array_new(FALSE, FALSE, sizeof(GvEngineTap));
 
 	/* Gstreamer must be initialized, let's check that */
 	g_assert(gst_is_initialized());
@@ -830,23 +2346,47 @@ gv_engine_constructed(GObject *object)
 	g_assert_nonnull(fakesink);
 	g_object_set(playbin, "video-sink", fakesink, NULL);
 
+	/* Use a specific audio sink if needed - returns floating ref */
+	if (priv->audio_sink) {
+		GstElement *audio_sink;
+		GError *err = NULL;
+
+		audio_sink = gst_parse_bin_from_description(priv->audio_sink, TRUE, &err);
+		if (err) {
+			WARNING("Failed to create audio sink '%s': %s",
+			        priv->audio_sink, err->message);
+			g_error_free(err);
+		}
+
+		if (audio_sink)
+			g_object_set(playbin, "audio-sink", audio_sink, NULL);
+	}
+
 	/* Get a reference to the message bus - returns full ref */
 	bus = gst_element_get_bus(playbin);
 	g_assert_nonnull(bus);
 	priv->bus = bus;
 
-	/* Add a bus signal watch (so that 'message' signals are emitted) */
-	gst_bus_add_signal_watch(bus);
-
-	/* Connect bus signal handlers */
-	g_signal_connect(bus, "message::eos", G_CALLBACK(on_bus_message_eos), self);
-	g_signal_connect(bus, "message::error", G_CALLBACK(on_bus_message_error), self);
-	g_signal_connect(bus, "message::warning", G_CALLBACK(on_bus_message_warning), self);
-	g_signal_connect(bus, "message::info", G_CALLBACK(on_bus_message_info), self);
-	g_signal_connect(bus, "message::tag", G_CALLBACK(on_bus_message_tag), self);
-	g_signal_connect(bus, "message::buffering", G_CALLBACK(on_bus_message_buffering), self);
-	g_signal_connect(bus, "message::state-changed", G_CALLBACK(on_bus_message_state_changed),
-	                 self);
+	/* Handle bus messages as soon as they're posted, in the thread that
+	 * posts them. See the bus dispatching section for more details.
+	 */
+	g_mutex_init(&priv->bus_lock);
+	g_queue_init(&priv->bus_queue);
+	gst_bus_set_sync_handler(bus, (GstBusSyncHandler) on_bus_sync_message, self, NULL);
+
+	/* Bind settings */
+	g_settings_bind(gv_core_settings, "level-interval",
+	                self, "level-interval", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "silence-threshold",
+	                self, "silence-threshold", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "silence-duration",
+	                self, "silence-duration", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "loudness-normalization",
+	                self, "loudness-normalization", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "spectrum-bands",
+	                self, "spectrum-bands", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "spectrum-interval",
+	                self, "spectrum-interval", G_SETTINGS_BIND_DEFAULT);
 
 	/* Chain up */
 	G_OBJECT_CHAINUP_CONSTRUCTED(gv_engine, object);
@@ -876,6 +2416,13 @@ gv_engine_class_init(GvEngineClass *class)
 	object_class->get_property = gv_engine_get_property;
 	object_class->set_property = gv_engine_set_property;
 
+	properties[PROP_AUDIO_SINK] =
+	        g_param_spec_string("audio-sink", "Audio sink",
+	                            "Description of the audio sink, as for gst-launch",
+	                            NULL,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE |
+	                            G_PARAM_CONSTRUCT_ONLY);
+
 	properties[PROP_STATE] =
 	        g_param_spec_enum("state", "Playback state", NULL,
 	                          GV_ENGINE_STATE_ENUM_TYPE,
@@ -897,9 +2444,76 @@ gv_engine_class_init(GvEngineClass *class)
 	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
 
 	properties[PROP_METADATA] =
-	        g_param_spec_object("metadata", "Current metadata", NULL,
-	                            GV_TYPE_METADATA,
-	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
+	        g_param_spec_boxed("metadata", "Current metadata", NULL,
+	                           GV_TYPE_METADATA,
+	                           GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
+
+	properties[PROP_LEVEL_INTERVAL] =
+	        g_param_spec_uint("level-interval", "Level interval",
+	                          "Interval between level measurements in ms, 0 to disable",
+	                          0, G_MAXUINT, DEFAULT_LEVEL_INTERVAL,
+	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_SILENCE_THRESHOLD] =
+	        g_param_spec_double("silence-threshold", "Silence threshold",
+	                            "Level (RMS, in dB) below which the stream is silent",
+	                            -200.0, 0.0, DEFAULT_SILENCE_THRESHOLD,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_SILENCE_DURATION] =
+	        g_param_spec_uint("silence-duration", "Silence duration",
+	                          "Seconds of silence before the stream is silent, 0 to disable",
+	                          0, G_MAXUINT, DEFAULT_SILENCE_DURATION,
+	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_SILENT] =
+	        g_param_spec_boolean("silent", "Silent",
+	                             "Whether the stream has been silent for too long",
+	                             FALSE,
+	                             GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
+
+	properties[PROP_LOUDNESS_NORMALIZATION] =
+	        g_param_spec_boolean("loudness-normalization", "Loudness normalization",
+	                             "Whether to adjust the gain so that streams sound equally loud",
+	                             DEFAULT_LOUDNESS_NORMALIZATION,
+	                             GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_NORMALIZATION_GAIN] =
+	        g_param_spec_double("normalization-gain", "Normalization gain",
+	                            "Gain (in dB) applied for loudness normalization",
+	                            LOUDNESS_MIN_GAIN, LOUDNESS_MAX_GAIN, 0.0,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_SPECTRUM_BANDS] =
+	        g_param_spec_uint("spectrum-bands", "Spectrum bands",
+	                          "Number of bands of the spectrum analyzer, 0 to disable",
+	                          0, SPECTRUM_MAX_BANDS, DEFAULT_SPECTRUM_BANDS,
+	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_SPECTRUM_INTERVAL] =
+	        g_param_spec_uint("spectrum-interval", "Spectrum interval",
+	                          "Interval between spectrum measurements in ms",
+	                          10, G_MAXUINT, DEFAULT_SPECTRUM_INTERVAL,
+	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
 
 	g_object_class_install_properties(object_class, PROP_N, properties);
+
+	/* Signals */
+	signals[SIGNAL_LEVEL] =
+	        g_signal_new("level", G_TYPE_FROM_CLASS(class),
+	                     G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+	                     0, NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE,
+	                     3, G_TYPE_UINT, G_TYPE_POINTER, G_TYPE_POINTER);
+
+	signals[SIGNAL_SPECTRUM] =
+	        g_signal_new("spectrum", G_TYPE_FROM_CLASS(class),
+	                     G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+	                     0, NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE,
+	                     2, G_TYPE_UINT, G_TYPE_POINTER);
+
+	signals[SIGNAL_REBUFFERING] =
+	        g_signal_new("rebuffering", G_TYPE_FROM_CLASS(class),
+	                     G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+	                     0, NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE,
+	                     0);
 }
@@ -22,6 +22,7 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <gst/gst.h>
 
 #include "core/gv-metadata.h"
 
@@ -40,14 +41,21 @@ typedef enum {
 	GV_ENGINE_STATE_PLAYING
 } GvEngineState;
 
+typedef void (*GvEngineTapFunc) (GstBuffer *buffer, gpointer user_data);
+
 /* Methods */
 
 GvEngine *gv_engine_new    (void);
+GvEngine *gv_engine_new_with_audio_sink(const gchar *audio_sink);
 void       gv_engine_play   (GvEngine *self, const gchar *uri);
 void       gv_engine_stop   (GvEngine *self);
 
+void       gv_engine_add_tap   (GvEngine *self, GvEngineTapFunc func, gpointer user_data);
+void       gv_engine_remove_tap(GvEngine *self, GvEngineTapFunc func, gpointer user_data);
+
 /* Property accessors */
 
+const gchar    *gv_engine_get_audio_sink(GvEngine *self);
 GvEngineState  gv_engine_get_state     (GvEngine *self);
 gdouble         gv_engine_get_volume    (GvEngine *self);
 void            gv_engine_set_volume    (GvEngine *self, gdouble volume);
@@ -55,5 +63,20 @@ gboolean        gv_engine_get_mute      (GvEngine *self);
 void            gv_engine_set_mute      (GvEngine *self, gboolean mute);
 const gchar    *gv_engine_get_stream_uri(GvEngine *self);
 GvMetadata    *gv_engine_get_metadata  (GvEngine *self);
+guint           gv_engine_get_level_interval   (GvEngine *self);
+void            gv_engine_set_level_interval   (GvEngine *self, guint interval);
+gdouble         gv_engine_get_silence_threshold(GvEngine *self);
+void            gv_engine_set_silence_threshold(GvEngine *self, gdouble threshold);
+guint           gv_engine_get_silence_duration (GvEngine *self);
+void            gv_engine_set_silence_duration (GvEngine *self, guint duration);
+gboolean        gv_engine_get_silent           (GvEngine *self);
+gboolean        gv_engine_get_loudness_normalization(GvEngine *self);
+void            gv_engine_set_loudness_normalization(GvEngine *self, gboolean enabled);
+gdouble         gv_engine_get_normalization_gain    (GvEngine *self);
+void            gv_engine_set_normalization_gain    (GvEngine *self, gdouble gain);
+guint           gv_engine_get_spectrum_bands   (GvEngine *self);
+void            gv_engine_set_spectrum_bands   (GvEngine *self, guint n_bands);
+guint           gv_engine_get_spectrum_interval(GvEngine *self);
+void            gv_engine_set_spectrum_interval(GvEngine *self, guint interval);
 
 #endif /* __GOODVIBES_CORE_GV_ENGINE_H__ */
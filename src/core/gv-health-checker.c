@@ -0,0 +1,753 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "additions/glib-object.h"
+#include "framework/gv-framework.h"
+#include "core/gv-core-internal.h"
+#include "core/gv-player.h"
+#include "core/gv-playlist.h"
+#include "core/gv-station.h"
+#include "core/gv-station-list.h"
+
+#include "core/gv-health-checker.h"
+
+/*
+ * Low priority checker, that goes through the station list in the
+ * background, and probes each station to find out if it's still alive.
+ * Playlists are downloaded, then the first stream is probed with a GET
+ * request, that is cancelled as soon as the response headers arrive.
+ * The result is stored in the station.
+ *
+ * The checker must never get in the way of the station being played:
+ * probes are started at a slow pace, that is set by the user, and every
+ * probe is cancelled while the player connects or buffers. On top of that,
+ * there's a cap on the number of probes in flight, and a given host is not
+ * probed more than once in a while.
+ */
+
+/* Default delay between two probes, 0 to disable the checker */
+#define DEFAULT_INTERVAL 60 /* s */
+
+/* How long a check result remains valid */
+#define CHECK_PERIOD     (12 * 60 * 60) /* s */
+
+/* Minimum delay between two probes to the same host */
+#define HOST_DELAY       (5 * 60) /* s */
+
+/* Maximum number of probes in flight */
+#define MAX_PROBES       2
+
+/* How long to wait for an answer */
+#define PROBE_TIMEOUT    10 /* s */
+
+typedef struct {
+	GvHealthChecker *self;
+	GvStation       *station;
+	GCancellable    *cancellable;
+	/* Waiting for the playlist */
+	gulong           stream_uris_handler;
+	/* Waiting for the http response */
+	SoupMessage     *message;
+	guint            status_code;
+	gchar           *reason_phrase;
+} Probe;
+
+/*
+ * GObject definitions
+ */
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Construct-only properties */
+	PROP_STATION_LIST,
+	PROP_PLAYER,
+	/* Properties */
+	PROP_INTERVAL,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+struct _GvHealthCheckerPrivate {
+	/* Construct-only properties */
+	GvStationList *station_list;
+	GvPlayer      *player;
+	/* Properties */
+	guint          interval;
+	/* Probes in flight */
+	SoupSession   *session;
+	GQueue         probes;
+	/* Current pass through the list, to check stations in a round-robin way */
+	GvStationListIter *cursor;
+	/* Last probe time per host, in monotonic time */
+	GHashTable    *hosts;
+	guint          timeout_id;
+};
+
+typedef struct _GvHealthCheckerPrivate GvHealthCheckerPrivate;
+
+struct _GvHealthChecker {
+	/* Parent instance structure */
+	GObject                 parent_instance;
+	/* Private data */
+	GvHealthCheckerPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GvHealthChecker, gv_health_checker, G_TYPE_OBJECT)
+
+/*
+ * Helpers
+ */
+
+static gboolean
+is_http_uri(const gchar *uri)
+{
+	return g_str_has_prefix(uri, "http://") || g_str_has_prefix(uri, "https://");
+}
+
+static gchar *
+get_host(const gchar *uri)
+{
+	SoupURI *soup_uri;
+	gchar *host;
+
+	soup_uri = soup_uri_new(uri);
+	if (soup_uri == NULL)
+		return NULL;
+
+	host = g_strdup(soup_uri_get_host(soup_uri));
+	soup_uri_free(soup_uri);
+
+	return host;
+}
+
+static gboolean
+is_player_busy(GvHealthChecker *self)
+{
+	GvPlayerState state = gv_player_get_state(self->priv->player);
+
+	return state == GV_PLAYER_STATE_CONNECTING ||
+	       state == GV_PLAYER_STATE_BUFFERING;
+}
+
+/*
+ * Probes
+ */
+
+static Probe *
+probe_new(GvHealthChecker *self, GvStation *station)
+{
+	Probe *probe;
+
+	probe = g_new0(Probe, 1);
+	probe->self = self;
+	probe->station = g_object_ref(station);
+	probe->cancellable = g_cancellable_new();
+
+	return probe;
+}
+
+static void
+probe_free(Probe *probe)
+{
+	g_free(probe->reason_phrase);
+	g_object_unref(probe->cancellable);
+	g_object_unref(probe->station);
+	g_free(probe);
+}
+
+/* Remove a probe that is over. If a request is pending, the probe is freed
+ * in the completion callback.
+ */
+static void
+finish_probe(GvHealthChecker *self, Probe *probe)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+
+	g_queue_remove(&priv->probes, probe);
+
+	if (probe->stream_uris_handler) {
+		g_signal_handler_disconnect(probe->station, probe->stream_uris_handler);
+		probe->stream_uris_handler = 0;
+	}
+
+	if (probe->message == NULL)
+		probe_free(probe);
+}
+
+static void
+complete_probe(GvHealthChecker *self, Probe *probe, const gchar *error)
+{
+	if (error)
+		INFO("Station '%s' failed health check: %s",
+		     gv_station_get_name_or_uri(probe->station), error);
+	else
+		DEBUG("Station '%s' passed health check",
+		      gv_station_get_name_or_uri(probe->station));
+
+	gv_station_set_check_result(probe->station, error);
+
+	finish_probe(self, probe);
+}
+
+/* Cancel a probe, the station will be checked again later */
+static void
+cancel_probe(GvHealthChecker *self, Probe *probe)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+	SoupMessage *msg = probe->message;
+
+	DEBUG("Cancelling health check for station %p", probe->station);
+
+	/* This also cancels the playlist download, unless someone else
+	 * is waiting for it.
+	 */
+	g_cancellable_cancel(probe->cancellable);
+
+	finish_probe(self, probe);
+
+	/* The completion callback is invoked, and frees the probe */
+	if (msg)
+		soup_session_cancel_message(priv->session, msg, SOUP_STATUS_CANCELLED);
+}
+
+static void
+cancel_all_probes(GvHealthChecker *self)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+
+	while (!g_queue_is_empty(&priv->probes))
+		cancel_probe(self, g_queue_peek_head(&priv->probes));
+}
+
+static void
+on_message_got_headers(SoupMessage *msg, Probe *probe)
+{
+	GvHealthCheckerPrivate *priv = probe->self->priv;
+
+	/* Let the session follow redirections */
+	if (SOUP_STATUS_IS_REDIRECTION(msg->status_code))
+		return;
+
+	/* That's all we need, don't download the stream */
+	probe->status_code = msg->status_code;
+	probe->reason_phrase = g_strdup(msg->reason_phrase);
+
+	soup_session_cancel_message(priv->session, msg, SOUP_STATUS_CANCELLED);
+}
+
+static void
+on_message_completed(SoupSession *session G_GNUC_UNUSED,
+                     SoupMessage *msg,
+                     Probe       *probe)
+{
+	gchar *error = NULL;
+
+	probe->message = NULL;
+
+	/* If the probe was cancelled, it's not in the queue anymore,
+	 * and probe->self might be gone already.
+	 */
+	if (g_cancellable_is_cancelled(probe->cancellable)) {
+		probe_free(probe);
+		return;
+	}
+
+	/* If we didn't get any headers, the message failed at the transport
+	 * level, and the status code says why.
+	 */
+	if (probe->status_code == 0)
+		error = g_strdup_printf("%u %s", msg->status_code, msg->reason_phrase);
+	else if (!SOUP_STATUS_IS_SUCCESSFUL(probe->status_code))
+		error = g_strdup_printf("%u %s", probe->status_code, probe->reason_phrase);
+
+	complete_probe(probe->self, probe, error);
+	g_free(error);
+}
+
+static void
+send_request(GvHealthChecker *self, Probe *probe, const gchar *uri)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+	SoupMessage *msg;
+
+	msg = soup_message_new("GET", uri);
+	if (msg == NULL) {
+		complete_probe(self, probe, _("Invalid uri"));
+		return;
+	}
+
+	DEBUG("Station %p: probing '%s'", probe->station, uri);
+
+	/* The body is never read, make sure it's not kept either */
+	soup_message_body_set_accumulate(msg->response_body, FALSE);
+	g_signal_connect(msg, "got-headers", G_CALLBACK(on_message_got_headers), probe);
+
+	/* The session steals the message reference */
+	probe->message = msg;
+	soup_session_queue_message(priv->session, msg,
+	                           (SoupSessionCallback) on_message_completed, probe);
+}
+
+static void
+probe_stream(GvHealthChecker *self, Probe *probe)
+{
+	GSList *uris;
+	const gchar *uri;
+
+	uris = gv_station_get_stream_uris(probe->station);
+	if (uris == NULL) {
+		complete_probe(self, probe, _("Failed to download playlist"));
+		return;
+	}
+
+	/* Only http streams can be probed, for the others it's enough that
+	 * the playlist was downloaded.
+	 */
+	uri = uris->data;
+	if (!is_http_uri(uri)) {
+		complete_probe(self, probe, NULL);
+		return;
+	}
+
+	send_request(self, probe, uri);
+}
+
+static void
+on_station_notify_stream_uris(GvStation  *station G_GNUC_UNUSED,
+                              GParamSpec *pspec G_GNUC_UNUSED,
+                              Probe      *probe)
+{
+	g_signal_handler_disconnect(probe->station, probe->stream_uris_handler);
+	probe->stream_uris_handler = 0;
+
+	probe_stream(probe->self, probe);
+}
+
+static void
+start_probe(GvHealthChecker *self, GvStation *station)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+	const gchar *uri = gv_station_get_uri(station);
+	Probe *probe;
+
+	DEBUG("Checking station %p", station);
+
+	probe = probe_new(self, station);
+	g_queue_push_tail(&priv->probes, probe);
+
+	/* Plain stream, probe it directly */
+	if (gv_playlist_get_format(uri) == GV_PLAYLIST_FORMAT_UNKNOWN) {
+		send_request(self, probe, uri);
+		return;
+	}
+
+	/* Playlist, download it first, unless it's done already */
+	if (gv_station_get_stream_uris(station)) {
+		probe_stream(self, probe);
+	} else if (gv_station_download_playlist(station, probe->cancellable)) {
+		probe->stream_uris_handler =
+		        g_signal_connect(station, "notify::stream-uris",
+		                         G_CALLBACK(on_station_notify_stream_uris), probe);
+	} else {
+		complete_probe(self, probe, _("Failed to download playlist"));
+	}
+}
+
+/*
+ * Scheduling
+ */
+
+static gboolean
+needs_check(GvHealthChecker *self, GvStation *station)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+	const gchar *uri = gv_station_get_uri(station);
+	gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+	GList *item;
+
+	if (uri == NULL || !is_http_uri(uri))
+		return FALSE;
+
+	/* The station being played is checked for real */
+	if (station == gv_player_get_station(priv->player))
+		return FALSE;
+
+	if (now - gv_station_get_check_time(station) < CHECK_PERIOD)
+		return FALSE;
+
+	for (item = priv->probes.head; item; item = item->next) {
+		Probe *probe = item->data;
+
+		if (probe->station == station)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* Check if the host can be probed, and if so, remember that it was */
+static gboolean
+take_host(GvHealthChecker *self, GvStation *station)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+	gint64 now = g_get_monotonic_time();
+	gint64 *last;
+	gchar *host;
+
+	host = get_host(gv_station_get_uri(station));
+	if (host == NULL)
+		return FALSE;
+
+	last = g_hash_table_lookup(priv->hosts, host);
+	if (last && now - *last < HOST_DELAY * G_USEC_PER_SEC) {
+		g_free(host);
+		return FALSE;
+	}
+
+	last = g_new(gint64, 1);
+	*last = now;
+	g_hash_table_replace(priv->hosts, host, last);
+
+	return TRUE;
+}
+
+static void
+forget_old_hosts(GvHealthChecker *self)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+	gint64 now = g_get_monotonic_time();
+	GHashTableIter iter;
+	gpointer value;
+
+	g_hash_table_iter_init(&iter, priv->hosts);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		gint64 *last = value;
+
+		if (now - *last >= HOST_DELAY * G_USEC_PER_SEC)
+			g_hash_table_iter_remove(&iter);
+	}
+}
+
+/* Pick the next station to check, going through the list in order.
+ * The iterator works on a snapshot of the list, so it's not disturbed by
+ * changes, and it doesn't touch the playback order of the station list.
+ */
+static GvStation *
+pick_station(GvHealthChecker *self)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+	guint n_tries = gv_station_list_get_length(priv->station_list) + 1;
+	GvStation *station;
+
+	while (n_tries-- > 0) {
+		if (priv->cursor == NULL)
+			priv->cursor = gv_station_list_iter_new(priv->station_list);
+
+		/* End of the pass, start over at the next try */
+		if (!gv_station_list_iter_loop(priv->cursor, &station)) {
+			gv_station_list_iter_free(priv->cursor);
+			priv->cursor = NULL;
+			continue;
+		}
+
+		if (needs_check(self, station) && take_host(self, station))
+			return station;
+	}
+
+	return NULL;
+}
+
+static gboolean
+when_timeout_check_station(GvHealthChecker *self)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+	GvStation *station;
+
+	if (is_player_busy(self))
+		return G_SOURCE_CONTINUE;
+
+	if (priv->probes.length >= MAX_PROBES)
+		return G_SOURCE_CONTINUE;
+
+	forget_old_hosts(self);
+
+	station = pick_station(self);
+	if (station)
+		start_probe(self, station);
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+restart_timeout(GvHealthChecker *self)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+
+	if (priv->timeout_id) {
+		g_source_remove(priv->timeout_id);
+		priv->timeout_id = 0;
+	}
+
+	if (priv->interval == 0) {
+		cancel_all_probes(self);
+		return;
+	}
+
+	priv->timeout_id = g_timeout_add_seconds(priv->interval,
+	                   (GSourceFunc) when_timeout_check_station, self);
+}
+
+/*
+ * Signal handlers & callbacks
+ */
+
+static void
+on_player_notify_state(GvPlayer        *player G_GNUC_UNUSED,
+                       GParamSpec      *pspec G_GNUC_UNUSED,
+                       GvHealthChecker *self)
+{
+	/* Give all the bandwidth to the player */
+	if (is_player_busy(self))
+		cancel_all_probes(self);
+}
+
+/*
+ * Property accessors
+ */
+
+static void
+gv_health_checker_set_station_list(GvHealthChecker *self, GvStationList *station_list)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+
+	/* This is a construct-only property */
+	g_assert_null(priv->station_list);
+	g_assert_nonnull(station_list);
+	priv->station_list = g_object_ref(station_list);
+}
+
+static void
+gv_health_checker_set_player(GvHealthChecker *self, GvPlayer *player)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+
+	/* This is a construct-only property */
+	g_assert_null(priv->player);
+	g_assert_nonnull(player);
+	priv->player = g_object_ref(player);
+	g_signal_connect(player, "notify::state",
+	                 G_CALLBACK(on_player_notify_state), self);
+}
+
+guint
+gv_health_checker_get_interval(GvHealthChecker *self)
+{
+	return self->priv->interval;
+}
+
+void
+gv_health_checker_set_interval(GvHealthChecker *self, guint interval)
+{
+	GvHealthCheckerPrivate *priv = self->priv;
+
+	if (priv->interval == interval)
+		return;
+
+	priv->interval = interval;
+	restart_timeout(self);
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_INTERVAL]);
+}
+
+static void
+gv_health_checker_get_property(GObject    *object,
+                               guint       property_id,
+                               GValue     *value,
+                               GParamSpec *pspec)
+{
+	GvHealthChecker *self = GV_HEALTH_CHECKER(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_INTERVAL:
+		g_value_set_uint(value, gv_health_checker_get_interval(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_health_checker_set_property(GObject      *object,
+                               guint         property_id,
+                               const GValue *value,
+                               GParamSpec   *pspec)
+{
+	GvHealthChecker *self = GV_HEALTH_CHECKER(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_STATION_LIST:
+		gv_health_checker_set_station_list(self, g_value_get_object(value));
+		break;
+	case PROP_PLAYER:
+		gv_health_checker_set_player(self, g_value_get_object(value));
+		break;
+	case PROP_INTERVAL:
+		gv_health_checker_set_interval(self, g_value_get_uint(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Public methods
+ */
+
+GvHealthChecker *
+gv_health_checker_new(GvStationList *station_list, GvPlayer *player)
+{
+	return g_object_new(GV_TYPE_HEALTH_CHECKER,
+	                    "station-list", station_list,
+	                    "player", player,
+	                    NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_health_checker_finalize(GObject *object)
+{
+	GvHealthChecker *self = GV_HEALTH_CHECKER(object);
+	GvHealthCheckerPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Cancel everything */
+	if (priv->timeout_id)
+		g_source_remove(priv->timeout_id);
+
+	cancel_all_probes(self);
+	soup_session_abort(priv->session);
+
+	/* Free resources */
+	g_object_unref(priv->session);
+	g_hash_table_unref(priv->hosts);
+	if (priv->cursor)
+		gv_station_list_iter_free(priv->cursor);
+
+	/* Unref */
+	g_signal_handlers_disconnect_by_data(priv->player, self);
+	g_object_unref(priv->player);
+	g_object_unref(priv->station_list);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_health_checker, object);
+}
+
+static void
+gv_health_checker_constructed(GObject *object)
+{
+	GvHealthChecker *self = GV_HEALTH_CHECKER(object);
+
+	TRACE("%p", object);
+
+	/* Initialize properties */
+	gv_health_checker_set_interval(self, DEFAULT_INTERVAL);
+
+	/* Bind settings */
+	g_settings_bind(gv_core_settings, "health-check-interval",
+	                self, "interval", G_SETTINGS_BIND_DEFAULT);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_health_checker, object);
+}
+
+static void
+gv_health_checker_init(GvHealthChecker *self)
+{
+	GvHealthCheckerPrivate *priv;
+
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = priv = gv_health_checker_get_instance_private(self);
+
+	/* Initialize internal state */
+	g_queue_init(&priv->probes);
+	priv->hosts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	priv->session = soup_session_new_with_options(SOUP_SESSION_USER_AGENT,
+	                                              gv_core_user_agent,
+	                                              SOUP_SESSION_TIMEOUT,
+	                                              PROBE_TIMEOUT,
+	                                              SOUP_SESSION_MAX_CONNS_PER_HOST,
+	                                              1,
+	                                              NULL);
+}
+
+static void
+gv_health_checker_class_init(GvHealthCheckerClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_health_checker_finalize;
+	object_class->constructed = gv_health_checker_constructed;
+
+	/* Properties */
+	object_class->get_property = gv_health_checker_get_property;
+	object_class->set_property = gv_health_checker_set_property;
+
+	properties[PROP_STATION_LIST] =
+	        g_param_spec_object("station-list", "Station list", NULL,
+	                            GV_TYPE_STATION_LIST,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_WRITABLE |
+	                            G_PARAM_CONSTRUCT_ONLY);
+
+	properties[PROP_PLAYER] =
+	        g_param_spec_object("player", "Player", NULL,
+	                            GV_TYPE_PLAYER,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_WRITABLE |
+	                            G_PARAM_CONSTRUCT_ONLY);
+
+	properties[PROP_INTERVAL] =
+	        g_param_spec_uint("interval", "Interval",
+	                          "Delay between two probes, in seconds, 0 to disable",
+	                          0, G_MAXUINT, DEFAULT_INTERVAL,
+	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+}
@@ -0,0 +1,43 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GOODVIBES_CORE_GV_HEALTH_CHECKER_H__
+#define __GOODVIBES_CORE_GV_HEALTH_CHECKER_H__
+
+#include <glib-object.h>
+
+#include "core/gv-player.h"
+#include "core/gv-station-list.h"
+
+/* GObject declarations */
+
+#define GV_TYPE_HEALTH_CHECKER gv_health_checker_get_type()
+
+G_DECLARE_FINAL_TYPE(GvHealthChecker, gv_health_checker, GV, HEALTH_CHECKER, GObject)
+
+/* Methods */
+
+GvHealthChecker *gv_health_checker_new(GvStationList *station_list, GvPlayer *player);
+
+/* Property accessors */
+
+guint gv_health_checker_get_interval(GvHealthChecker *self);
+void  gv_health_checker_set_interval(GvHealthChecker *self, guint interval);
+
+#endif /* __GOODVIBES_CORE_GV_HEALTH_CHECKER_H__ */
@@ -0,0 +1,1028 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "additions/glib-object.h"
+#include "framework/gv-framework.h"
+#include "core/gv-core-internal.h"
+#include "core/gv-metadata.h"
+#include "core/gv-player.h"
+#include "core/gv-station.h"
+
+#include "core/gv-history.h"
+
+/*
+ * The history is stored in two append-only files:
+ * - the index, an array of fixed-size records, one per song. Records are
+ *   appended in chronological order, so that a time range can be found
+ *   with a binary search.
+ * - the strings: station uri and name, title and artist. A string is
+ *   stored only once, no matter how many records refer to it, and records
+ *   refer to strings by offset.
+ *
+ * Queries are served from read-only memory mappings of these files.
+ * When the history exceeds the retention limits, both files are rewritten
+ * without the oldest records, and without the strings that are not used
+ * anymore.
+ *
+ * Note that stations are identified by their uri, as it's the only thing
+ * that is persistent across sessions.
+ */
+
+#define INDEX_FILENAME   "history.idx"
+#define STRINGS_FILENAME "history.str"
+#define INDEX_MAGIC      "GVHIDX01"
+#define STRINGS_MAGIC    "GVHSTR01"
+#define MAGIC_SIZE       8
+
+#define SECONDS_PER_DAY  (24 * 60 * 60)
+
+/* The history is allowed to grow a bit over the limits, so that the files
+ * are not rewritten every time a song is added.
+ */
+#define ENTRIES_SLACK(max) ((max) / 4)
+#define AGE_SLACK          1  /* day */
+
+typedef struct {
+	gint64  timestamp;
+	guint32 station_uri;
+	guint32 station_name;
+	guint32 title;
+	guint32 artist;
+} HistoryRecord;
+
+G_STATIC_ASSERT(sizeof(HistoryRecord) == 24);
+
+/*
+ * Properties
+ */
+
+#define DEFAULT_MAX_ENTRIES 10000
+#define DEFAULT_MAX_AGE     90
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Construct properties */
+	PROP_PLAYER,
+	/* Properties */
+	PROP_MAX_ENTRIES,
+	PROP_MAX_AGE,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+/*
+ * Signals
+ */
+
+enum {
+	SIGNAL_ENTRY_ADDED,
+	/* Number of signals */
+	SIGNAL_N
+};
+
+static guint signals[SIGNAL_N];
+
+/*
+ * GObject definitions
+ */
+
+typedef struct {
+	FILE       *file;
+	guint32     size;
+	GHashTable *offsets;
+} StringTable;
+
+struct _GvHistoryPrivate {
+	/* Construct-only properties */
+	GvPlayer      *player;
+	/* Properties */
+	guint          max_entries;
+	guint          max_age;
+	/* Files */
+	gchar         *index_path;
+	gchar         *strings_path;
+	FILE          *index_file;
+	StringTable    strings;
+	guint          n_records;
+	gint64         first_timestamp;
+	HistoryRecord  last_record;
+	/* Read-only mappings, for queries */
+	GMappedFile   *index_map;
+	GMappedFile   *strings_map;
+};
+
+typedef struct _GvHistoryPrivate GvHistoryPrivate;
+
+struct _GvHistory {
+	/* Parent instance structure */
+	GObject           parent_instance;
+	/* Private data */
+	GvHistoryPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GvHistory, gv_history, G_TYPE_OBJECT,
+                        G_ADD_PRIVATE(GvHistory)
+                        G_IMPLEMENT_INTERFACE(GV_TYPE_ERRORABLE, NULL))
+
+/*
+ * String table
+ */
+
+static void
+string_table_clear(StringTable *table)
+{
+	if (table->file) {
+		fclose(table->file);
+		table->file = NULL;
+	}
+
+	if (table->offsets) {
+		g_hash_table_unref(table->offsets);
+		table->offsets = NULL;
+	}
+
+	table->size = 0;
+}
+
+static gboolean
+string_table_add(StringTable *table, const gchar *str, guint32 *offset, GError **err)
+{
+	gpointer value;
+	gsize len;
+
+	/* Offset 0 is the magic, hence it means 'no string' */
+	if (str == NULL || str[0] == '\0') {
+		*offset = 0;
+		return TRUE;
+	}
+
+	if (g_hash_table_lookup_extended(table->offsets, str, NULL, &value)) {
+		*offset = GPOINTER_TO_UINT(value);
+		return TRUE;
+	}
+
+	len = strlen(str) + 1;
+	if (fwrite(str, 1, len, table->file) != len) {
+		g_set_error(err, G_FILE_ERROR, g_file_error_from_errno(errno),
+		            "Failed to write string: %s", g_strerror(errno));
+		return FALSE;
+	}
+
+	*offset = table->size;
+	table->size += len;
+	g_hash_table_insert(table->offsets, g_strdup(str), GUINT_TO_POINTER(*offset));
+
+	return TRUE;
+}
+
+/*
+ * Helpers
+ */
+
+static const gchar *
+get_string(GMappedFile *map, guint32 offset)
+{
+	const gchar *contents = g_mapped_file_get_contents(map);
+	gsize size = g_mapped_file_get_length(map);
+
+	if (offset < MAGIC_SIZE || offset >= size)
+		return NULL;
+
+	/* Don't trust the file blindly */
+	if (memchr(contents + offset, '\0', size - offset) == NULL)
+		return NULL;
+
+	return contents + offset;
+}
+
+static const HistoryRecord *
+get_records(GMappedFile *map, guint *n_records)
+{
+	const gchar *contents = g_mapped_file_get_contents(map);
+	gsize size = g_mapped_file_get_length(map);
+
+	*n_records = (size - MAGIC_SIZE) / sizeof(HistoryRecord);
+
+	return (const HistoryRecord *) (contents + MAGIC_SIZE);
+}
+
+static guint
+find_first_record(const HistoryRecord *records, guint n_records, gint64 timestamp)
+{
+	guint lo = 0, hi = n_records;
+
+	/* Index of the first record at or after timestamp */
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+
+		if (records[mid].timestamp < timestamp)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static GMappedFile *
+map_file(const gchar *path, const gchar *magic, GError **err)
+{
+	GMappedFile *map;
+
+	map = g_mapped_file_new(path, FALSE, err);
+	if (map == NULL)
+		return NULL;
+
+	if (g_mapped_file_get_length(map) < MAGIC_SIZE ||
+	    memcmp(g_mapped_file_get_contents(map), magic, MAGIC_SIZE)) {
+		g_set_error(err, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+		            "Invalid file '%s'", path);
+		g_mapped_file_unref(map);
+		return NULL;
+	}
+
+	return map;
+}
+
+static gboolean
+truncate_file(const gchar *path, gsize size, GError **err)
+{
+	/* Get rid of an incomplete record, left by a crash */
+	WARNING("Truncating '%s' to %zu bytes", path, size);
+
+	if (truncate(path, size) != 0) {
+		g_set_error(err, G_FILE_ERROR, g_file_error_from_errno(errno),
+		            "Failed to truncate file '%s': %s",
+		            path, g_strerror(errno));
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+drop_maps(GvHistory *self)
+{
+	GvHistoryPrivate *priv = self->priv;
+
+	if (priv->index_map) {
+		g_mapped_file_unref(priv->index_map);
+		priv->index_map = NULL;
+	}
+
+	if (priv->strings_map) {
+		g_mapped_file_unref(priv->strings_map);
+		priv->strings_map = NULL;
+	}
+}
+
+static gboolean
+ensure_maps(GvHistory *self, GError **err)
+{
+	GvHistoryPrivate *priv = self->priv;
+
+	if (priv->index_file == NULL) {
+		g_set_error(err, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+		            "History is not available");
+		return FALSE;
+	}
+
+	if (priv->index_map == NULL)
+		priv->index_map = map_file(priv->index_path, INDEX_MAGIC, err);
+	if (priv->index_map == NULL)
+		return FALSE;
+
+	if (priv->strings_map == NULL)
+		priv->strings_map = map_file(priv->strings_path, STRINGS_MAGIC, err);
+	if (priv->strings_map == NULL)
+		return FALSE;
+
+	return TRUE;
+}
+
+static void
+close_files(GvHistory *self)
+{
+	GvHistoryPrivate *priv = self->priv;
+
+	drop_maps(self);
+	string_table_clear(&priv->strings);
+
+	if (priv->index_file) {
+		fclose(priv->index_file);
+		priv->index_file = NULL;
+	}
+
+	priv->n_records = 0;
+	priv->first_timestamp = 0;
+	memset(&priv->last_record, 0, sizeof(HistoryRecord));
+}
+
+static gboolean
+create_files(GvHistory *self, GError **err)
+{
+	GvHistoryPrivate *priv = self->priv;
+
+	INFO("Creating history files in '%s'", gv_get_user_data_dir());
+
+	if (!g_file_set_contents(priv->index_path, INDEX_MAGIC, MAGIC_SIZE, err))
+		return FALSE;
+
+	if (!g_file_set_contents(priv->strings_path, STRINGS_MAGIC, MAGIC_SIZE, err))
+		return FALSE;
+
+	return TRUE;
+}
+
+static gboolean
+open_files(GvHistory *self, GError **err)
+{
+	GvHistoryPrivate *priv = self->priv;
+	const HistoryRecord *records;
+	const gchar *contents;
+	GError *map_err = NULL;
+	gsize size, pos;
+	guint n_records;
+
+	g_assert_null(priv->index_file);
+
+	/* Map the files, create them if they're missing or broken */
+	priv->index_map = map_file(priv->index_path, INDEX_MAGIC, &map_err);
+	if (priv->index_map)
+		priv->strings_map = map_file(priv->strings_path, STRINGS_MAGIC, &map_err);
+
+	if (map_err) {
+		if (!g_error_matches(map_err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+			WARNING("Discarding history: %s", map_err->message);
+		g_clear_error(&map_err);
+		drop_maps(self);
+
+		if (!create_files(self, err))
+			return FALSE;
+
+		priv->index_map = map_file(priv->index_path, INDEX_MAGIC, err);
+		if (priv->index_map == NULL)
+			return FALSE;
+
+		priv->strings_map = map_file(priv->strings_path, STRINGS_MAGIC, err);
+		if (priv->strings_map == NULL)
+			return FALSE;
+	}
+
+	/* Load the strings */
+	priv->strings.offsets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	contents = g_mapped_file_get_contents(priv->strings_map);
+	size = g_mapped_file_get_length(priv->strings_map);
+	pos = MAGIC_SIZE;
+
+	while (pos < size) {
+		const gchar *end;
+
+		end = memchr(contents + pos, '\0', size - pos);
+		if (end == NULL)
+			break;
+
+		g_hash_table_insert(priv->strings.offsets, g_strdup(contents + pos),
+		                    GUINT_TO_POINTER(pos));
+		pos = end - contents + 1;
+	}
+
+	priv->strings.size = pos;
+	if (pos < size && !truncate_file(priv->strings_path, pos, err))
+		return FALSE;
+
+	/* Load the records */
+	records = get_records(priv->index_map, &n_records);
+	size = g_mapped_file_get_length(priv->index_map);
+	pos = MAGIC_SIZE + n_records * sizeof(HistoryRecord);
+
+	if (n_records > 0) {
+		priv->first_timestamp = records[0].timestamp;
+		priv->last_record = records[n_records - 1];
+	}
+	priv->n_records = n_records;
+
+	if (pos < size && !truncate_file(priv->index_path, pos, err))
+		return FALSE;
+
+	/* Mappings might be stale after truncating */
+	drop_maps(self);
+
+	/* Open for appending */
+	priv->strings.file = g_fopen(priv->strings_path, "ab");
+	if (priv->strings.file == NULL)
+		goto fopen_error;
+
+	priv->index_file = g_fopen(priv->index_path, "ab");
+	if (priv->index_file == NULL)
+		goto fopen_error;
+
+	DEBUG("History loaded: %u records, %u bytes of strings",
+	      priv->n_records, priv->strings.size);
+
+	return TRUE;
+
+fopen_error:
+	g_set_error(err, G_FILE_ERROR, g_file_error_from_errno(errno),
+	            "Failed to open history files: %s", g_strerror(errno));
+	return FALSE;
+}
+
+static gboolean
+write_compacted_files(GvHistory *self, guint first, const gchar *index_path,
+                      const gchar *strings_path, GError **err)
+{
+	GvHistoryPrivate *priv = self->priv;
+	const HistoryRecord *records;
+	StringTable strings = { 0 };
+	FILE *index_file = NULL;
+	gboolean ret = FALSE;
+	guint n_records;
+	guint i;
+
+	records = get_records(priv->index_map, &n_records);
+
+	index_file = g_fopen(index_path, "wb");
+	strings.file = g_fopen(strings_path, "wb");
+	strings.offsets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	strings.size = MAGIC_SIZE;
+
+	if (index_file == NULL || strings.file == NULL ||
+	    fwrite(INDEX_MAGIC, 1, MAGIC_SIZE, index_file) != MAGIC_SIZE ||
+	    fwrite(STRINGS_MAGIC, 1, MAGIC_SIZE, strings.file) != MAGIC_SIZE)
+		goto write_error;
+
+	for (i = first; i < n_records; i++) {
+		const HistoryRecord *old = &records[i];
+		HistoryRecord new;
+
+		new.timestamp = old->timestamp;
+
+		if (!string_table_add(&strings, get_string(priv->strings_map, old->station_uri),
+		                      &new.station_uri, err) ||
+		    !string_table_add(&strings, get_string(priv->strings_map, old->station_name),
+		                      &new.station_name, err) ||
+		    !string_table_add(&strings, get_string(priv->strings_map, old->title),
+		                      &new.title, err) ||
+		    !string_table_add(&strings, get_string(priv->strings_map, old->artist),
+		                      &new.artist, err))
+			goto cleanup;
+
+		if (fwrite(&new, sizeof(HistoryRecord), 1, index_file) != 1)
+			goto write_error;
+	}
+
+	if (fflush(index_file) != 0 || fflush(strings.file) != 0)
+		goto write_error;
+
+	ret = TRUE;
+	goto cleanup;
+
+write_error:
+	g_set_error(err, G_FILE_ERROR, g_file_error_from_errno(errno),
+	            "Failed to write history: %s", g_strerror(errno));
+
+cleanup:
+	if (index_file)
+		fclose(index_file);
+	string_table_clear(&strings);
+
+	return ret;
+}
+
+static gboolean
+needs_compaction(GvHistory *self)
+{
+	GvHistoryPrivate *priv = self->priv;
+	gint64 now;
+
+	if (priv->index_file == NULL || priv->n_records == 0)
+		return FALSE;
+
+	if (priv->n_records > priv->max_entries + ENTRIES_SLACK(priv->max_entries))
+		return TRUE;
+
+	if (priv->max_age > 0) {
+		now = g_get_real_time() / G_USEC_PER_SEC;
+		if (priv->first_timestamp <
+		    now - (gint64) (priv->max_age + AGE_SLACK) * SECONDS_PER_DAY)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static gboolean
+compact(GvHistory *self, GError **err)
+{
+	GvHistoryPrivate *priv = self->priv;
+	const HistoryRecord *records;
+	gchar *index_tmp = NULL;
+	gchar *strings_tmp = NULL;
+	gboolean ret = FALSE;
+	guint n_records;
+	guint first = 0;
+
+	/* Make sure everything is on disk, then map it */
+	fflush(priv->strings.file);
+	fflush(priv->index_file);
+	drop_maps(self);
+
+	if (!ensure_maps(self, err))
+		goto cleanup;
+
+	/* Find the first record to keep */
+	records = get_records(priv->index_map, &n_records);
+
+	if (n_records > priv->max_entries)
+		first = n_records - priv->max_entries;
+
+	if (priv->max_age > 0) {
+		gint64 oldest;
+
+		oldest = g_get_real_time() / G_USEC_PER_SEC -
+		         (gint64) priv->max_age * SECONDS_PER_DAY;
+		first = MAX(first, find_first_record(records, n_records, oldest));
+	}
+
+	if (first == 0) {
+		ret = TRUE;
+		goto cleanup;
+	}
+
+	DEBUG("Compacting history: dropping %u of %u records", first, n_records);
+
+	/* Write new files, then replace the old ones */
+	index_tmp = g_strconcat(priv->index_path, ".tmp", NULL);
+	strings_tmp = g_strconcat(priv->strings_path, ".tmp", NULL);
+
+	if (!write_compacted_files(self, first, index_tmp, strings_tmp, err))
+		goto cleanup;
+
+	close_files(self);
+
+	if (g_rename(strings_tmp, priv->strings_path) != 0 ||
+	    g_rename(index_tmp, priv->index_path) != 0) {
+		g_set_error(err, G_FILE_ERROR, g_file_error_from_errno(errno),
+		            "Failed to replace history files: %s", g_strerror(errno));
+		goto cleanup;
+	}
+
+	ret = open_files(self, err);
+
+cleanup:
+	if (index_tmp) {
+		g_unlink(index_tmp);
+		g_free(index_tmp);
+	}
+	if (strings_tmp) {
+		g_unlink(strings_tmp);
+		g_free(strings_tmp);
+	}
+
+	return ret;
+}
+
+static void
+apply_retention(GvHistory *self)
+{
+	GError *err = NULL;
+
+	if (!needs_compaction(self))
+		return;
+
+	if (compact(self, &err))
+		return;
+
+	/* Give up on the history for this session */
+	WARNING("Failed to compact history: %s", err->message);
+	gv_errorable_emit_error_printf(GV_ERRORABLE(self), "%s: %s",
+	                               _("Failed to write history"), err->message);
+	g_clear_error(&err);
+	close_files(self);
+}
+
+static void
+add_record(GvHistory *self, GvStation *station, GvMetadata *metadata)
+{
+	GvHistoryPrivate *priv = self->priv;
+	HistoryRecord record;
+	GvHistoryEntry entry;
+	GError *err = NULL;
+
+	if (priv->index_file == NULL || priv->max_entries == 0)
+		return;
+
+	if (!string_table_add(&priv->strings, gv_station_get_uri(station),
+	                      &record.station_uri, &err) ||
+	    !string_table_add(&priv->strings, gv_station_get_name(station),
+	                      &record.station_name, &err) ||
+	    !string_table_add(&priv->strings, gv_metadata_get_title(metadata),
+	                      &record.title, &err) ||
+	    !string_table_add(&priv->strings, gv_metadata_get_artist(metadata),
+	                      &record.artist, &err))
+		goto error;
+
+	/* Same song on the same station, nothing to record */
+	if (priv->n_records > 0 &&
+	    priv->last_record.station_uri == record.station_uri &&
+	    priv->last_record.title == record.title &&
+	    priv->last_record.artist == record.artist)
+		return;
+
+	/* Records must be in chronological order, even if the clock goes back */
+	record.timestamp = g_get_real_time() / G_USEC_PER_SEC;
+	if (priv->n_records > 0 && record.timestamp < priv->last_record.timestamp)
+		record.timestamp = priv->last_record.timestamp;
+
+	/* Strings first, so that records never refer to missing strings */
+	if (fflush(priv->strings.file) != 0 ||
+	    fwrite(&record, sizeof(HistoryRecord), 1, priv->index_file) != 1 ||
+	    fflush(priv->index_file) != 0) {
+		g_set_error(&err, G_FILE_ERROR, g_file_error_from_errno(errno),
+		            "Failed to write history: %s", g_strerror(errno));
+		goto error;
+	}
+
+	if (priv->n_records == 0)
+		priv->first_timestamp = record.timestamp;
+	priv->last_record = record;
+	priv->n_records++;
+
+	/* Files changed, mappings must be renewed */
+	drop_maps(self);
+
+	apply_retention(self);
+
+	/* The entry is only valid during the emission */
+	entry.timestamp = record.timestamp;
+	entry.station_uri = (gchar *) gv_station_get_uri(station);
+	entry.station_name = (gchar *) gv_station_get_name(station);
+	entry.title = (gchar *) gv_metadata_get_title(metadata);
+	entry.artist = (gchar *) gv_metadata_get_artist(metadata);
+	g_signal_emit(self, signals[SIGNAL_ENTRY_ADDED], 0, &entry);
+
+	return;
+
+error:
+	/* Give up on the history for this session */
+	WARNING("%s", err->message);
+	gv_errorable_emit_error_printf(GV_ERRORABLE(self), "%s: %s",
+	                               _("Failed to write history"), err->message);
+	g_clear_error(&err);
+	close_files(self);
+}
+
+/*
+ * Signal handlers
+ */
+
+static void
+on_player_notify(GvPlayer   *player,
+                 GParamSpec *pspec,
+                 GvHistory  *self)
+{
+	const gchar *property_name = g_param_spec_get_name(pspec);
+	GvMetadata *metadata;
+	GvStation *station;
+
+	if (g_strcmp0(property_name, "metadata"))
+		return;
+
+	metadata = gv_player_get_metadata(player);
+	station = gv_player_get_station(player);
+
+	if (metadata == NULL || station == NULL)
+		return;
+
+	if (gv_metadata_get_title(metadata) == NULL)
+		return;
+
+	add_record(self, station, metadata);
+}
+
+/*
+ * Property accessors
+ */
+
+static void
+gv_history_set_player(GvHistory *self, GvPlayer *player)
+{
+	GvHistoryPrivate *priv = self->priv;
+
+	/* This is a construct-only property */
+	g_assert_null(priv->player);
+	g_assert_nonnull(player);
+	priv->player = g_object_ref(player);
+	g_signal_connect(priv->player, "notify", G_CALLBACK(on_player_notify), self);
+}
+
+guint
+gv_history_get_max_entries(GvHistory *self)
+{
+	return self->priv->max_entries;
+}
+
+void
+gv_history_set_max_entries(GvHistory *self, guint max_entries)
+{
+	GvHistoryPrivate *priv = self->priv;
+
+	if (priv->max_entries == max_entries)
+		return;
+
+	priv->max_entries = max_entries;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MAX_ENTRIES]);
+
+	apply_retention(self);
+}
+
+guint
+gv_history_get_max_age(GvHistory *self)
+{
+	return self->priv->max_age;
+}
+
+void
+gv_history_set_max_age(GvHistory *self, guint max_age)
+{
+	GvHistoryPrivate *priv = self->priv;
+
+	if (priv->max_age == max_age)
+		return;
+
+	priv->max_age = max_age;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MAX_AGE]);
+
+	apply_retention(self);
+}
+
+static void
+gv_history_get_property(GObject    *object,
+                        guint       property_id,
+                        GValue     *value,
+                        GParamSpec *pspec)
+{
+	GvHistory *self = GV_HISTORY(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_MAX_ENTRIES:
+		g_value_set_uint(value, gv_history_get_max_entries(self));
+		break;
+	case PROP_MAX_AGE:
+		g_value_set_uint(value, gv_history_get_max_age(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_history_set_property(GObject      *object,
+                        guint         property_id,
+                        const GValue *value,
+                        GParamSpec   *pspec)
+{
+	GvHistory *self = GV_HISTORY(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_PLAYER:
+		gv_history_set_player(self, g_value_get_object(value));
+		break;
+	case PROP_MAX_ENTRIES:
+		gv_history_set_max_entries(self, g_value_get_uint(value));
+		break;
+	case PROP_MAX_AGE:
+		gv_history_set_max_age(self, g_value_get_uint(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Public methods
+ */
+
+void
+gv_history_entry_free(GvHistoryEntry *entry)
+{
+	if (entry == NULL)
+		return;
+
+	g_free(entry->station_uri);
+	g_free(entry->station_name);
+	g_free(entry->title);
+	g_free(entry->artist);
+	g_slice_free(GvHistoryEntry, entry);
+}
+
+GPtrArray *
+gv_history_query(GvHistory *self, const gchar *station_uri,
+                 gint64 start, gint64 end, guint max_entries,
+                 GError **err)
+{
+	GvHistoryPrivate *priv = self->priv;
+	const HistoryRecord *records;
+	GPtrArray *entries;
+	guint n_records;
+	guint first, last, i;
+
+	/* Returns the entries played in [start, end), in chronological order.
+	 * A NULL station uri means any station, an end of 0 means no end.
+	 * If there's a maximum number of entries, the most recent are kept.
+	 */
+
+	if (!ensure_maps(self, err))
+		return NULL;
+
+	records = get_records(priv->index_map, &n_records);
+	first = find_first_record(records, n_records, start);
+	last = end > 0 ? find_first_record(records, n_records, end) : n_records;
+
+	entries = g_ptr_array_new_with_free_func((GDestroyNotify) gv_history_entry_free);
+
+	for (i = last; i > first; i--) {
+		const HistoryRecord *record = &records[i - 1];
+		GvHistoryEntry *entry;
+		const gchar *uri;
+
+		uri = get_string(priv->strings_map, record->station_uri);
+		if (station_uri && g_strcmp0(uri, station_uri))
+			continue;
+
+		entry = g_slice_new0(GvHistoryEntry);
+		entry->timestamp = record->timestamp;
+		entry->station_uri = g_strdup(uri);
+		entry->station_name = g_strdup(get_string(priv->strings_map, record->station_name));
+		entry->title = g_strdup(get_string(priv->strings_map, record->title));
+		entry->artist = g_strdup(get_string(priv->strings_map, record->artist));
+		g_ptr_array_add(entries, entry);
+
+		if (max_entries > 0 && entries->len >= max_entries)
+			break;
+	}
+
+	/* Entries were collected backward */
+	for (i = 0; i < entries->len / 2; i++) {
+		gpointer tmp = entries->pdata[i];
+
+		entries->pdata[i] = entries->pdata[entries->len - 1 - i];
+		entries->pdata[entries->len - 1 - i] = tmp;
+	}
+
+	return entries;
+}
+
+GvHistory *
+gv_history_new(GvPlayer *player)
+{
+	return g_object_new(GV_TYPE_HISTORY,
+	                    "player", player,
+	                    NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_history_finalize(GObject *object)
+{
+	GvHistory *self = GV_HISTORY(object);
+	GvHistoryPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Close files */
+	close_files(self);
+	g_free(priv->index_path);
+	g_free(priv->strings_path);
+
+	/* Unref the player */
+	g_signal_handlers_disconnect_by_data(priv->player, self);
+	g_object_unref(priv->player);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_history, object);
+}
+
+static void
+gv_history_constructed(GObject *object)
+{
+	GvHistory *self = GV_HISTORY(object);
+	GvHistoryPrivate *priv = self->priv;
+	GError *err = NULL;
+
+	TRACE("%p", object);
+
+	/* Initialize properties */
+	priv->max_entries = DEFAULT_MAX_ENTRIES;
+	priv->max_age = DEFAULT_MAX_AGE;
+
+	/* Bind settings */
+	g_settings_bind(gv_core_settings, "history-max-entries",
+	                self, "max-entries", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "history-max-age",
+	                self, "max-age", G_SETTINGS_BIND_DEFAULT);
+
+	/* Open history files */
+	priv->index_path = g_build_filename(gv_get_user_data_dir(), INDEX_FILENAME, NULL);
+	priv->strings_path = g_build_filename(gv_get_user_data_dir(), STRINGS_FILENAME, NULL);
+
+	if (open_files(self, &err)) {
+		apply_retention(self);
+	} else {
+		WARNING("Failed to open history: %s", err->message);
+		g_clear_error(&err);
+		close_files(self);
+	}
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_history, object);
+}
+
+static void
+gv_history_init(GvHistory *self)
+{
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = gv_history_get_instance_private(self);
+}
+
+static void
+gv_history_class_init(GvHistoryClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_history_finalize;
+	object_class->constructed = gv_history_constructed;
+
+	/* Properties */
+	object_class->get_property = gv_history_get_property;
+	object_class->set_property = gv_history_set_property;
+
+	properties[PROP_PLAYER] =
+	        g_param_spec_object("player", "Player", NULL,
+	                            GV_TYPE_PLAYER,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_WRITABLE |
+	                            G_PARAM_CONSTRUCT_ONLY);
+
+	properties[PROP_MAX_ENTRIES] =
+	        g_param_spec_uint("max-entries", "Maximum number of entries", NULL,
+	                          0, G_MAXUINT, DEFAULT_MAX_ENTRIES,
+	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_MAX_AGE] =
+	        g_param_spec_uint("max-age", "Maximum age of entries, in days", NULL,
+	                          0, G_MAXUINT, DEFAULT_MAX_AGE,
+	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+
+	/* Signals */
+	signals[SIGNAL_ENTRY_ADDED] =
+	        g_signal_new("entry-added", G_TYPE_FROM_CLASS(class),
+	                     G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+	                     0, NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE,
+	                     1, G_TYPE_POINTER);
+}
@@ -0,0 +1,59 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GOODVIBES_CORE_GV_HISTORY_H__
+#define __GOODVIBES_CORE_GV_HISTORY_H__
+
+#include <glib-object.h>
+
+#include "core/gv-player.h"
+
+/* GObject declarations */
+
+#define GV_TYPE_HISTORY gv_history_get_type()
+
+G_DECLARE_FINAL_TYPE(GvHistory, gv_history, GV, HISTORY, GObject)
+
+/* Data types */
+
+typedef struct {
+	gint64  timestamp;
+	gchar  *station_uri;
+	gchar  *station_name;
+	gchar  *title;
+	gchar  *artist;
+} GvHistoryEntry;
+
+void gv_history_entry_free(GvHistoryEntry *entry);
+
+/* Methods */
+
+GvHistory *gv_history_new  (GvPlayer *player);
+GPtrArray *gv_history_query(GvHistory *self, const gchar *station_uri,
+                            gint64 start, gint64 end, guint max_entries,
+                            GError **err);
+
+/* Property accessors */
+
+guint gv_history_get_max_entries(GvHistory *self);
+void  gv_history_set_max_entries(GvHistory *self, guint max_entries);
+guint gv_history_get_max_age    (GvHistory *self);
+void  gv_history_set_max_age    (GvHistory *self, guint max_age);
+
+#endif /* __GOODVIBES_CORE_GV_HISTORY_H__ */
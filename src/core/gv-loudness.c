@@ -0,0 +1,310 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "core/gv-loudness.h"
+
+/*
+ * Integrated loudness, as defined by ITU-R BS.1770 and EBU R128.
+ *
+ * Audio is K-weighted (a high shelf followed by a high pass), then the mean
+ * square is measured over 400 ms blocks, overlapping by 75 %. Integrated
+ * loudness is the mean over the blocks that pass an absolute gate at
+ * -70 LUFS, and then a relative gate 10 LU below this first mean.
+ *
+ * Blocks are accumulated in a histogram rather than kept in memory, since
+ * a radio stream can play for hours. The resolution is 0.1 LU, which is
+ * more than enough for our purpose.
+ *
+ * All channels are weighted equally, which is exact for mono and stereo,
+ * and close enough for anything else.
+ */
+
+#define SUB_BLOCKS_PER_BLOCK 4          /* 400 ms blocks, 100 ms steps */
+#define ABSOLUTE_GATE        -70.0
+#define RELATIVE_GATE        -10.0
+#define HISTOGRAM_MIN        ABSOLUTE_GATE
+#define HISTOGRAM_STEP       0.1
+#define HISTOGRAM_SIZE       750        /* Up to +5 LUFS */
+
+typedef struct {
+	gdouble b0, b1, b2;
+	gdouble a1, a2;
+} Biquad;
+
+typedef struct {
+	gdouble z1, z2;
+} BiquadState;
+
+struct _GvLoudness {
+	guint        rate;
+	guint        channels;
+	/* K-weighting filters, one state per channel */
+	Biquad       shelf;
+	Biquad       highpass;
+	BiquadState *shelf_states;
+	BiquadState *highpass_states;
+	/* Sub-block being measured */
+	gsize        sub_block_size;
+	gsize        sub_block_frames;
+	gdouble      sub_block_sum;
+	/* Last sub-blocks measured */
+	gdouble      sub_blocks[SUB_BLOCKS_PER_BLOCK];
+	guint        n_sub_blocks;
+	/* Blocks that passed the absolute gate */
+	guint64      histogram_count[HISTOGRAM_SIZE];
+	gdouble      histogram_power[HISTOGRAM_SIZE];
+};
+
+/*
+ * Helpers
+ */
+
+static inline gdouble
+power_to_lufs(gdouble power)
+{
+	return -0.691 + 10.0 * log10(power);
+}
+
+static inline gdouble
+biquad_process(const Biquad *f, BiquadState *s, gdouble x)
+{
+	gdouble y;
+
+	/* Direct form II transposed */
+	y = f->b0 * x + s->z1;
+	s->z1 = f->b1 * x - f->a1 * y + s->z2;
+	s->z2 = f->b2 * x - f->a2 * y;
+
+	return y;
+}
+
+static void
+compute_filters(GvLoudness *self)
+{
+	gdouble f0, g, q, k, vh, vb, a0;
+
+	/* Coefficients are given for 48 kHz in the recommendation, we compute
+	 * them for any rate, the same way libebur128 does.
+	 */
+
+	/* Stage 1: high shelf, models the acoustic effects of the head */
+	f0 = 1681.974450955533;
+	g  = 3.999843853973347;
+	q  = 0.7071752369554196;
+
+	k  = tan(G_PI * f0 / self->rate);
+	vh = pow(10.0, g / 20.0);
+	vb = pow(vh, 0.4996667741545416);
+	a0 = 1.0 + k / q + k * k;
+
+	self->shelf.b0 = (vh + vb * k / q + k * k) / a0;
+	self->shelf.b1 = 2.0 * (k * k - vh) / a0;
+	self->shelf.b2 = (vh - vb * k / q + k * k) / a0;
+	self->shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+	self->shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+	/* Stage 2: high pass */
+	f0 = 38.13547087602444;
+	q  = 0.5003270373238773;
+
+	k  = tan(G_PI * f0 / self->rate);
+	a0 = 1.0 + k / q + k * k;
+
+	self->highpass.b0 = 1.0;
+	self->highpass.b1 = -2.0;
+	self->highpass.b2 = 1.0;
+	self->highpass.a1 = 2.0 * (k * k - 1.0) / a0;
+	self->highpass.a2 = (1.0 - k / q + k * k) / a0;
+}
+
+static void
+add_block(GvLoudness *self, gdouble power)
+{
+	gdouble lufs;
+	gint index;
+
+	if (power <= 0.0)
+		return;
+
+	lufs = power_to_lufs(power);
+	if (lufs < ABSOLUTE_GATE)
+		return;
+
+	index = (gint) ((lufs - HISTOGRAM_MIN) / HISTOGRAM_STEP);
+	index = CLAMP(index, 0, HISTOGRAM_SIZE - 1);
+
+	self->histogram_count[index]++;
+	self->histogram_power[index] += power;
+}
+
+static void
+end_sub_block(GvLoudness *self)
+{
+	gdouble power = 0;
+	guint i;
+
+	self->sub_blocks[self->n_sub_blocks % SUB_BLOCKS_PER_BLOCK] =
+	        self->sub_block_sum / self->sub_block_size;
+	self->n_sub_blocks++;
+
+	self->sub_block_sum = 0;
+	self->sub_block_frames = 0;
+
+	if (self->n_sub_blocks < SUB_BLOCKS_PER_BLOCK)
+		return;
+
+	/* Sub-blocks have the same length, the block is just the mean */
+	for (i = 0; i < SUB_BLOCKS_PER_BLOCK; i++)
+		power += self->sub_blocks[i];
+
+	add_block(self, power / SUB_BLOCKS_PER_BLOCK);
+}
+
+/*
+ * Accessors
+ */
+
+guint
+gv_loudness_get_rate(GvLoudness *self)
+{
+	return self->rate;
+}
+
+guint
+gv_loudness_get_channels(GvLoudness *self)
+{
+	return self->channels;
+}
+
+gboolean
+gv_loudness_get_integrated(GvLoudness *self, gdouble *lufs)
+{
+	guint64 count = 0;
+	gdouble power = 0;
+	gdouble relative_gate;
+	gint start, i;
+
+	/* Absolute gating is done when adding blocks */
+	for (i = 0; i < HISTOGRAM_SIZE; i++) {
+		count += self->histogram_count[i];
+		power += self->histogram_power[i];
+	}
+
+	if (count == 0)
+		return FALSE;
+
+	/* Relative gating */
+	relative_gate = power_to_lufs(power / count) + RELATIVE_GATE;
+	start = (gint) ceil((relative_gate - HISTOGRAM_MIN) / HISTOGRAM_STEP);
+	start = CLAMP(start, 0, HISTOGRAM_SIZE - 1);
+
+	count = 0;
+	power = 0;
+	for (i = start; i < HISTOGRAM_SIZE; i++) {
+		count += self->histogram_count[i];
+		power += self->histogram_power[i];
+	}
+
+	if (count == 0)
+		return FALSE;
+
+	*lufs = power_to_lufs(power / count);
+
+	return TRUE;
+}
+
+/*
+ * Public methods
+ */
+
+void
+gv_loudness_process(GvLoudness *self, const gfloat *samples, gsize n_frames)
+{
+	const guint channels = self->channels;
+	gsize i;
+	guint c;
+
+	/* Samples are interleaved. Filters are recursive, so there's not much
+	 * to gain from vectorizing, we just keep the inner loop tight.
+	 */
+	for (i = 0; i < n_frames; i++) {
+		gdouble sum = 0;
+
+		for (c = 0; c < channels; c++) {
+			gdouble y;
+
+			y = biquad_process(&self->shelf, &self->shelf_states[c], samples[c]);
+			y = biquad_process(&self->highpass, &self->highpass_states[c], y);
+			sum += y * y;
+		}
+
+		samples += channels;
+
+		self->sub_block_sum += sum;
+		if (++self->sub_block_frames == self->sub_block_size)
+			end_sub_block(self);
+	}
+}
+
+void
+gv_loudness_reset(GvLoudness *self)
+{
+	memset(self->shelf_states, 0, self->channels * sizeof(BiquadState));
+	memset(self->highpass_states, 0, self->channels * sizeof(BiquadState));
+
+	self->sub_block_frames = 0;
+	self->sub_block_sum = 0;
+	self->n_sub_blocks = 0;
+
+	memset(self->histogram_count, 0, sizeof(self->histogram_count));
+	memset(self->histogram_power, 0, sizeof(self->histogram_power));
+}
+
+void
+gv_loudness_free(GvLoudness *self)
+{
+	g_free(self->shelf_states);
+	g_free(self->highpass_states);
+	g_free(self);
+}
+
+GvLoudness *
+gv_loudness_new(guint rate, guint channels)
+{
+	GvLoudness *self;
+
+	g_return_val_if_fail(rate > 0, NULL);
+	g_return_val_if_fail(channels > 0, NULL);
+
+	self = g_new0(GvLoudness, 1);
+	self->rate = rate;
+	self->channels = channels;
+	self->shelf_states = g_new0(BiquadState, channels);
+	self->highpass_states = g_new0(BiquadState, channels);
+	self->sub_block_size = rate / 10;
+
+	compute_filters(self);
+
+	return self;
+}
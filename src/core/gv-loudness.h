@@ -0,0 +1,42 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GOODVIBES_CORE_GV_LOUDNESS_H__
+#define __GOODVIBES_CORE_GV_LOUDNESS_H__
+
+#include <glib.h>
+
+/* Data types */
+
+typedef struct _GvLoudness GvLoudness;
+
+/* Methods */
+
+GvLoudness *gv_loudness_new    (guint rate, guint channels);
+void        gv_loudness_free   (GvLoudness *self);
+void        gv_loudness_reset  (GvLoudness *self);
+void        gv_loudness_process(GvLoudness *self, const gfloat *samples, gsize n_frames);
+
+/* Accessors */
+
+guint       gv_loudness_get_rate      (GvLoudness *self);
+guint       gv_loudness_get_channels  (GvLoudness *self);
+gboolean    gv_loudness_get_integrated(GvLoudness *self, gdouble *lufs);
+
+#endif /* __GOODVIBES_CORE_GV_LOUDNESS_H__ */
@@ -20,318 +20,170 @@
 #include <glib.h>
 #include <glib-object.h>
 
-#include "additions/glib-object.h"
 #include "framework/gv-framework.h"
 
 #include "core/gv-metadata.h"
 
-// WISHED I think this doesn't need to be a GObject. A simple boxed type would do.
-
 /*
- * Properties
+ * Metadata is immutable, and shared by reference counting. It's created
+ * by the engine, then passed around to the player and everyone that
+ * listens to it, from any thread.
+ *
+ * The strings are interned in a string pool, shared by every metadata.
+ * A given string is stored only once, no matter how many times it's
+ * seen, and it's freed when no metadata uses it anymore. As a result,
+ * two strings are equal if and only if the pointers are equal.
  */
 
-enum {
-	/* Reserved */
-	PROP_0,
-	/* Properties */
-	PROP_TITLE,
-	PROP_ARTIST,
-	PROP_ALBUM,
-	PROP_GENRE,
-	PROP_YEAR,
-	PROP_COMMENT,
-	PROP_BITRATE,
-	// WISHED Label ?
-	// WISHED Cover ?
-	/* Number of properties */
-	PROP_N
+struct _GvMetadata {
+	gint         ref_count;
+	guint        hash;
+	const gchar *title;
+	const gchar *artist;
+	const gchar *album;
+	const gchar *genre;
+	const gchar *year;
+	const gchar *comment;
+	guint        bitrate;
 };
 
-static GParamSpec *properties[PROP_N];
+G_DEFINE_BOXED_TYPE(GvMetadata, gv_metadata, gv_metadata_ref, gv_metadata_unref)
 
 /*
- * GObject definitions
+ * String pool
  */
 
-struct _GvMetadataPrivate {
-	gchar *title;
-	gchar *artist;
-	gchar *album;
-	gchar *genre;
-	gchar *year;
-	gchar *comment;
-	guint  bitrate;
-};
+G_LOCK_DEFINE_STATIC(string_pool);
+static GHashTable *string_pool;
 
-typedef struct _GvMetadataPrivate GvMetadataPrivate;
+static const gchar *
+string_pool_acquire(const gchar *str)
+{
+	gpointer key, value;
 
-struct _GvMetadata {
-	/* Parent instance structure */
-	GObject             parent_instance;
-	/* Private data */
-	GvMetadataPrivate *priv;
-};
+	if (str == NULL)
+		return NULL;
 
-G_DEFINE_TYPE_WITH_PRIVATE(GvMetadata, gv_metadata, G_TYPE_OBJECT)
+	G_LOCK(string_pool);
 
-/*
- * Property accessors
- */
+	if (string_pool == NULL)
+		string_pool = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 
-const gchar *
-gv_metadata_get_title(GvMetadata *self)
-{
-	return self->priv->title;
-}
-
-void
-gv_metadata_set_title(GvMetadata *self, const gchar *title)
-{
-	GvMetadataPrivate *priv = self->priv;
+	if (g_hash_table_lookup_extended(string_pool, str, &key, &value)) {
+		g_hash_table_insert(string_pool, key, GUINT_TO_POINTER(GPOINTER_TO_UINT(value) + 1));
+	} else {
+		key = g_strdup(str);
+		g_hash_table_insert(string_pool, key, GUINT_TO_POINTER(1));
+	}
 
-	if (!g_strcmp0(priv->title, title))
-		return;
+	G_UNLOCK(string_pool);
 
-	g_free(priv->title);
-	priv->title = g_strdup(title);
-	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_TITLE]);
-}
-
-const gchar *
-gv_metadata_get_artist(GvMetadata *self)
-{
-	return self->priv->artist;
+	return key;
 }
 
-void
-gv_metadata_set_artist(GvMetadata *self, const gchar *artist)
+static void
+string_pool_release(const gchar *str)
 {
-	GvMetadataPrivate *priv = self->priv;
+	guint count;
 
-	if (!g_strcmp0(priv->artist, artist))
+	if (str == NULL)
 		return;
 
-	g_free(priv->artist);
-	priv->artist = g_strdup(artist);
-	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_ARTIST]);
-}
-const gchar *
-gv_metadata_get_album(GvMetadata *self)
-{
-	return self->priv->album;
-}
+	G_LOCK(string_pool);
 
-void
-gv_metadata_set_album(GvMetadata *self, const gchar *album)
-{
-	GvMetadataPrivate *priv = self->priv;
+	count = GPOINTER_TO_UINT(g_hash_table_lookup(string_pool, str));
+	g_assert(count > 0);
 
-	if (!g_strcmp0(priv->album, album))
-		return;
+	if (count > 1)
+		g_hash_table_insert(string_pool, (gpointer) str, GUINT_TO_POINTER(count - 1));
+	else
+		g_hash_table_remove(string_pool, str);
 
-	g_free(priv->album);
-	priv->album = g_strdup(album);
-	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_ALBUM]);
+	G_UNLOCK(string_pool);
 }
 
+/*
+ * Accessors
+ */
+
 const gchar *
-gv_metadata_get_genre(GvMetadata *self)
+gv_metadata_get_title(GvMetadata *self)
 {
-	return self->priv->genre;
+	return self->title;
 }
 
-void
-gv_metadata_set_genre(GvMetadata *self, const gchar *genre)
+const gchar *
+gv_metadata_get_artist(GvMetadata *self)
 {
-	GvMetadataPrivate *priv = self->priv;
-
-	if (!g_strcmp0(priv->genre, genre))
-		return;
-
-	g_free(priv->genre);
-	priv->genre = g_strdup(genre);
-	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_GENRE]);
+	return self->artist;
 }
 
 const gchar *
-gv_metadata_get_year(GvMetadata *self)
+gv_metadata_get_album(GvMetadata *self)
 {
-	return self->priv->year;
+	return self->album;
 }
 
-void
-gv_metadata_set_year(GvMetadata *self, const gchar *year)
+const gchar *
+gv_metadata_get_genre(GvMetadata *self)
 {
-	GvMetadataPrivate *priv = self->priv;
-
-	if (!g_strcmp0(priv->year, year))
-		return;
-
-	g_free(priv->year);
-	priv->year = g_strdup(year);
-	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_YEAR]);
+	return self->genre;
 }
 
 const gchar *
-gv_metadata_get_comment(GvMetadata *self)
+gv_metadata_get_year(GvMetadata *self)
 {
-	return self->priv->comment;
+	return self->year;
 }
 
-void
-gv_metadata_set_comment(GvMetadata *self, const gchar *comment)
+const gchar *
+gv_metadata_get_comment(GvMetadata *self)
 {
-	GvMetadataPrivate *priv = self->priv;
-
-	if (!g_strcmp0(priv->comment, comment))
-		return;
-
-	g_free(priv->comment);
-	priv->comment = g_strdup(comment);
-	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_COMMENT]);
+	return self->comment;
 }
 
 guint
 gv_metadata_get_bitrate(GvMetadata *self)
 {
-	return self->priv->bitrate;
-}
-
-void
-gv_metadata_set_bitrate(GvMetadata *self, guint bitrate)
-{
-	GvMetadataPrivate *priv = self->priv;
-
-	if (priv->bitrate == bitrate)
-		return;
-
-	priv->bitrate = bitrate;
-	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_BITRATE]);
-}
-
-static void
-gv_metadata_get_property(GObject    *object,
-                         guint       property_id,
-                         GValue     *value,
-                         GParamSpec *pspec)
-{
-	GvMetadata *self = GV_METADATA(object);
-
-	TRACE_GET_PROPERTY(object, property_id, value, pspec);
-
-	switch (property_id) {
-	case PROP_TITLE:
-		g_value_set_string(value, gv_metadata_get_title(self));
-		break;
-	case PROP_ARTIST:
-		g_value_set_string(value, gv_metadata_get_artist(self));
-		break;
-	case PROP_ALBUM:
-		g_value_set_string(value, gv_metadata_get_album(self));
-		break;
-	case PROP_GENRE:
-		g_value_set_string(value, gv_metadata_get_genre(self));
-		break;
-	case PROP_YEAR:
-		g_value_set_string(value, gv_metadata_get_year(self));
-		break;
-	case PROP_COMMENT:
-		g_value_set_string(value, gv_metadata_get_comment(self));
-		break;
-	case PROP_BITRATE:
-		g_value_set_uint(value, gv_metadata_get_bitrate(self));
-		break;
-	default:
-		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
-		break;
-	}
-}
-
-static void
-gv_metadata_set_property(GObject      *object,
-                         guint         property_id,
-                         const GValue *value,
-                         GParamSpec   *pspec)
-{
-	GvMetadata *self = GV_METADATA(object);
-
-	TRACE_SET_PROPERTY(object, property_id, value, pspec);
-
-	switch (property_id) {
-	case PROP_TITLE:
-		gv_metadata_set_title(self, g_value_get_string(value));
-		break;
-	case PROP_ARTIST:
-		gv_metadata_set_artist(self, g_value_get_string(value));
-		break;
-	case PROP_ALBUM:
-		gv_metadata_set_album(self, g_value_get_string(value));
-		break;
-	case PROP_GENRE:
-		gv_metadata_set_genre(self, g_value_get_string(value));
-		break;
-	case PROP_YEAR:
-		gv_metadata_set_year(self, g_value_get_string(value));
-		break;
-	case PROP_COMMENT:
-		gv_metadata_set_comment(self, g_value_get_string(value));
-		break;
-	case PROP_BITRATE:
-		gv_metadata_set_bitrate(self, g_value_get_uint(value));
-		break;
-	default:
-		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
-		break;
-	}
+	return self->bitrate;
 }
 
 /*
  * Public methods
  */
 
+guint
+gv_metadata_hash(GvMetadata *self)
+{
+	return self->hash;
+}
+
 gboolean
 gv_metadata_is_equal(GvMetadata *self, GvMetadata *against)
 {
-	GvMetadataPrivate *priv1 = self->priv;
-	GvMetadataPrivate *priv2 = against->priv;
-
-	if (g_strcmp0(priv1->title, priv2->title))
-		return FALSE;
-
-	if (g_strcmp0(priv1->artist, priv2->artist))
-		return FALSE;
-
-	if (g_strcmp0(priv1->album, priv2->album))
-		return FALSE;
-
-	if (g_strcmp0(priv1->genre, priv2->genre))
-		return FALSE;
-
-	if (g_strcmp0(priv1->year, priv2->year))
-		return FALSE;
-
-	if (g_strcmp0(priv1->comment, priv2->comment))
-		return FALSE;
-
-	if (priv1->bitrate != priv2->bitrate)
-		return FALSE;
-
-	return TRUE;
+	/* Strings are interned, so comparing pointers is enough */
+	return self == against ||
+	       (self->hash    == against->hash    &&
+	        self->title   == against->title   &&
+	        self->artist  == against->artist  &&
+	        self->album   == against->album   &&
+	        self->genre   == against->genre   &&
+	        self->year    == against->year    &&
+	        self->comment == against->comment &&
+	        self->bitrate == against->bitrate);
 }
 
 gchar *
 gv_metadata_make_title_artist(GvMetadata *self, gboolean escape)
 {
-	GvMetadataPrivate *priv = self->priv;
 	gchar *str, *str2;
 
-	if (priv->artist && priv->title)
-		str = g_strdup_printf("%s - %s", priv->title, priv->artist);
-	else if (priv->title)
-		str = g_strdup_printf("%s", priv->title);
-	else if (priv->artist)
-		str = g_strdup_printf("%s", priv->artist);
+	if (self->artist && self->title)
+		str = g_strdup_printf("%s - %s", self->title, self->artist);
+	else if (self->title)
+		str = g_strdup_printf("%s", self->title);
+	else if (self->artist)
+		str = g_strdup_printf("%s", self->artist);
 	else
 		str = NULL;
 
@@ -347,15 +199,14 @@ gv_metadata_make_title_artist(GvMetadata *self, gboolean escape)
 gchar *
 gv_metadata_make_album_year(GvMetadata *self, gboolean escape)
 {
-	GvMetadataPrivate *priv = self->priv;
 	gchar *str, *str2;
 
-	if (priv->album && priv->year)
-		str = g_strdup_printf("%s (%s)", priv->album, priv->year);
-	else if (priv->album)
-		str = g_strdup_printf("%s", priv->album);
-	else if (priv->year)
-		str = g_strdup_printf("(%s)", priv->year);
+	if (self->album && self->year)
+		str = g_strdup_printf("%s (%s)", self->album, self->year);
+	else if (self->album)
+		str = g_strdup_printf("%s", self->album);
+	else if (self->year)
+		str = g_strdup_printf("(%s)", self->year);
 	else
 		str = NULL;
 
@@ -369,84 +220,63 @@ gv_metadata_make_album_year(GvMetadata *self, gboolean escape)
 }
 
 GvMetadata *
-gv_metadata_new(void)
+gv_metadata_ref(GvMetadata *self)
 {
-	return g_object_new(GV_TYPE_METADATA, NULL);
-}
+	g_return_val_if_fail(self != NULL, NULL);
 
-/*
- * GObject methods
- */
+	g_atomic_int_inc(&self->ref_count);
 
-static void
-gv_metadata_finalize(GObject *object)
-{
-	GvMetadataPrivate *priv = GV_METADATA(object)->priv;
-
-	TRACE("%p", object);
-
-	/* Free any allocated resources */
-	g_free(priv->title);
-	g_free(priv->artist);
-	g_free(priv->album);
-	g_free(priv->genre);
-	g_free(priv->year);
-	g_free(priv->comment);
-
-	/* Chain up */
-	G_OBJECT_CHAINUP_FINALIZE(gv_metadata, object);
+	return self;
 }
 
-static void
-gv_metadata_init(GvMetadata *self)
-{
-	TRACE("%p", self);
-
-	/* Initialize private pointer */
-	self->priv = gv_metadata_get_instance_private(self);
-}
-
-static void
-gv_metadata_class_init(GvMetadataClass *class)
+void
+gv_metadata_unref(GvMetadata *self)
 {
-	GObjectClass *object_class = G_OBJECT_CLASS(class);
-
-	TRACE("%p", class);
-
-	/* Override GObject methods */
-	object_class->finalize = gv_metadata_finalize;
-
-	/* Properties */
-	object_class->get_property = gv_metadata_get_property;
-	object_class->set_property = gv_metadata_set_property;
+	g_return_if_fail(self != NULL);
 
-	properties[PROP_TITLE] =
-	        g_param_spec_string("title", "Title", NULL, NULL,
-	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
-
-	properties[PROP_ARTIST] =
-	        g_param_spec_string("artist", "Artist", NULL, NULL,
-	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+	if (!g_atomic_int_dec_and_test(&self->ref_count))
+		return;
 
-	properties[PROP_ALBUM] =
-	        g_param_spec_string("album", "Album", NULL, NULL,
-	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+	TRACE("%p", self);
 
-	properties[PROP_GENRE] =
-	        g_param_spec_string("genre", "Genre", NULL, NULL,
-	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+	string_pool_release(self->title);
+	string_pool_release(self->artist);
+	string_pool_release(self->album);
+	string_pool_release(self->genre);
+	string_pool_release(self->year);
+	string_pool_release(self->comment);
 
-	properties[PROP_YEAR] =
-	        g_param_spec_string("year", "Year", NULL, NULL,
-	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+	g_slice_free(GvMetadata, self);
+}
 
-	properties[PROP_COMMENT] =
-	        g_param_spec_string("comment", "Comment", NULL, NULL,
-	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+GvMetadata *
+gv_metadata_new(const gchar *title, const gchar *artist, const gchar *album,
+                const gchar *genre, const gchar *year, const gchar *comment,
+                guint bitrate)
+{
+	GvMetadata *self;
+	guint hash = 5381;
+
+	self = g_slice_new0(GvMetadata);
+	self->ref_count = 1;
+	self->title     = string_pool_acquire(title);
+	self->artist    = string_pool_acquire(artist);
+	self->album     = string_pool_acquire(album);
+	self->genre     = string_pool_acquire(genre);
+	self->year      = string_pool_acquire(year);
+	self->comment   = string_pool_acquire(comment);
+	self->bitrate   = bitrate;
+
+	/* Interned strings have a unique address, hashing it is enough */
+	hash = (hash * 33) ^ g_direct_hash(self->title);
+	hash = (hash * 33) ^ g_direct_hash(self->artist);
+	hash = (hash * 33) ^ g_direct_hash(self->album);
+	hash = (hash * 33) ^ g_direct_hash(self->genre);
+	hash = (hash * 33) ^ g_direct_hash(self->year);
+	hash = (hash * 33) ^ g_direct_hash(self->comment);
+	self->hash = (hash * 33) ^ bitrate;
 
-	properties[PROP_BITRATE] =
-	        g_param_spec_uint("bitrate", "Bitrate", NULL, 0, G_MAXUINT, 0,
-	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+	TRACE("%p", self);
 
-	g_object_class_install_properties(object_class, PROP_N, properties);
+	return self;
 }
@@ -37,11 +37,16 @@
  * Properties
  */
 
-#define DEFAULT_VOLUME   100
-#define DEFAULT_MUTE     FALSE
-#define DEFAULT_REPEAT   FALSE
-#define DEFAULT_SHUFFLE  FALSE
-#define DEFAULT_AUTOPLAY FALSE
+#define DEFAULT_VOLUME           100
+#define DEFAULT_MUTE             FALSE
+#define DEFAULT_REPEAT           FALSE
+#define DEFAULT_SHUFFLE          FALSE
+#define DEFAULT_AUTOPLAY         FALSE
+#define DEFAULT_SILENCE_FAILOVER FALSE
+#define DEFAULT_SMART_NEXT       FALSE
+
+/* Delay before saving the gains learnt for loudness normalization */
+#define SAVE_STATION_GAINS_DELAY 10
 
 enum {
 	/* Reserved */
@@ -49,6 +54,7 @@ enum {
 	/* Construct properties */
 	PROP_ENGINE,
 	PROP_STATION_LIST,
+	PROP_ZONE,
 	/* Properties */
 	PROP_STATE,
 	PROP_VOLUME,
@@ -56,6 +62,8 @@ enum {
 	PROP_REPEAT,
 	PROP_SHUFFLE,
 	PROP_AUTOPLAY,
+	PROP_SILENCE_FAILOVER,
+	PROP_SMART_NEXT,
 	PROP_METADATA,
 	PROP_STATION,
 	PROP_STATION_URI,
@@ -81,6 +89,7 @@ struct _GvPlayerPrivate {
 	/* Construct-only properties */
 	GvEngine      *engine;
 	GvStationList *station_list;
+	gchar         *zone;
 	/* Properties */
 	GvPlayerState  state;
 	guint           volume;
@@ -88,11 +97,24 @@ struct _GvPlayerPrivate {
 	gboolean        repeat;
 	gboolean        shuffle;
 	gboolean        autoplay;
+	gboolean        silence_failover;
+	gboolean        smart_next;
 	/* Current station */
 	GvStation     *station;
 	GvMetadata    *metadata;
-	/* Wished state */
+	/* Connection quality tracking */
+	gint64         connect_start;
+	/* Stream to play, and how many times we failed over to another one */
+	guint          stream_index;
+	guint          n_failovers;
+	/* Wished state, and the operation in flight to reach it */
 	GvPlayerWish   wish;
+	guint          apply_wish_id;
+	guint          n_commands;
+	GCancellable  *cancellable;
+	/* Loudness normalization gains, per station uri */
+	GHashTable    *station_gains;
+	guint          save_station_gains_id;
 };
 
 typedef struct _GvPlayerPrivate GvPlayerPrivate;
@@ -108,11 +130,249 @@ G_DEFINE_TYPE_WITH_CODE(GvPlayer, gv_player, G_TYPE_OBJECT,
                         G_ADD_PRIVATE(GvPlayer)
                         G_IMPLEMENT_INTERFACE(GV_TYPE_ERRORABLE, NULL))
 
+/*
+ * Station gains helpers
+ */
+
+static void
+load_station_gains(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+	GVariant *gains;
+	GVariantIter iter;
+	const gchar *uri;
+	gdouble gain;
+
+	gains = g_settings_get_value(gv_core_settings, "station-gains");
+
+	g_variant_iter_init(&iter, gains);
+	while (g_variant_iter_next(&iter, "{&sd}", &uri, &gain)) {
+		gdouble *value = g_new(gdouble, 1);
+
+		*value = gain;
+		g_hash_table_insert(priv->station_gains, g_strdup(uri), value);
+	}
+
+	g_variant_unref(gains);
+}
+
+static void
+save_station_gains(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+	GVariantBuilder b;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	g_variant_builder_init(&b, G_VARIANT_TYPE("a{sd}"));
+
+	g_hash_table_iter_init(&iter, priv->station_gains);
+	while (g_hash_table_iter_next(&iter, &key, &value))
+		g_variant_builder_add(&b, "{sd}", key, *(gdouble *) value);
+
+	g_settings_set_value(gv_core_settings, "station-gains", g_variant_builder_end(&b));
+}
+
+static gboolean
+when_timeout_save_station_gains(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	save_station_gains(self);
+	priv->save_station_gains_id = 0;
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_save_station_gains(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	/* The gain changes slowly but often, no need to save every change */
+	if (priv->save_station_gains_id == 0)
+		priv->save_station_gains_id = g_timeout_add_seconds
+		                              (SAVE_STATION_GAINS_DELAY,
+		                               (GSourceFunc) when_timeout_save_station_gains,
+		                               self);
+}
+
+static void
+remember_station_gain(GvPlayer *self, gdouble gain)
+{
+	GvPlayerPrivate *priv = self->priv;
+	const gchar *uri;
+	gdouble *value;
+
+	/* Gains are only saved for the main player, zones are not persistent */
+	if (priv->zone || priv->station == NULL)
+		return;
+
+	uri = gv_station_get_uri(priv->station);
+	if (uri == NULL)
+		return;
+
+	value = g_hash_table_lookup(priv->station_gains, uri);
+	if (value && *value == gain)
+		return;
+
+	if (value == NULL) {
+		value = g_new(gdouble, 1);
+		g_hash_table_insert(priv->station_gains, g_strdup(uri), value);
+	}
+
+	*value = gain;
+
+	schedule_save_station_gains(self);
+}
+
+static void
+forget_station_gain(GvPlayer *self, const gchar *uri)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	/* Another station might play the same stream */
+	if (gv_station_list_find_by_uri(priv->station_list, uri))
+		return;
+
+	if (g_hash_table_remove(priv->station_gains, uri))
+		schedule_save_station_gains(self);
+}
+
+static gdouble
+lookup_station_gain(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+	const gchar *uri;
+	gdouble *value;
+
+	if (priv->station == NULL)
+		return 0.0;
+
+	uri = gv_station_get_uri(priv->station);
+	if (uri == NULL)
+		return 0.0;
+
+	value = g_hash_table_lookup(priv->station_gains, uri);
+
+	return value ? *value : 0.0;
+}
+
+static void
+update_station_stats(GvPlayer *self, GvEngineState engine_state)
+{
+	GvPlayerPrivate *priv = self->priv;
+	GvStation *station = priv->station;
+
+	if (station == NULL)
+		return;
+
+	switch (engine_state) {
+	case GV_ENGINE_STATE_CONNECTING:
+		priv->connect_start = g_get_monotonic_time();
+		break;
+	case GV_ENGINE_STATE_PLAYING:
+		/* First time we play since we connected */
+		if (priv->connect_start > 0) {
+			gint64 elapsed = g_get_monotonic_time() - priv->connect_start;
+
+			gv_station_report_success(station, (guint) (elapsed / 1000));
+			priv->connect_start = 0;
+		}
+		break;
+	case GV_ENGINE_STATE_STOPPED:
+	default:
+		priv->connect_start = 0;
+		break;
+	}
+}
+
+/*
+ * Command pipeline. Commands (play, stop, next, and so on) only record
+ * what's wished, and the wish is applied later on, from an idle callback.
+ * Therefore a burst of commands results in a single operation, the last
+ * command wins. The operation in flight, if any, is cancelled when a new
+ * wish is applied.
+ */
+
+static void
+apply_wish(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+	GvStation *station = priv->station;
+	GSList *uris;
+
+	/* Cancel the previous operation */
+	g_cancellable_cancel(priv->cancellable);
+	g_object_unref(priv->cancellable);
+	priv->cancellable = g_cancellable_new();
+
+	/* Stop playing */
+	gv_engine_stop(priv->engine);
+
+	if (priv->wish == GV_PLAYER_WISH_TO_STOP || station == NULL)
+		return;
+
+	/* Get station data */
+	uris = gv_station_get_stream_uris(station);
+
+	/* If there's no uris, that probably means that the station uri
+	 * points to a playlist, and we need to download it.
+	 */
+	if (uris == NULL) {
+		/* Download the playlist that contains the stream uris */
+		if (!gv_station_download_playlist(station, priv->cancellable))
+			WARNING("Can't download playlist");
+
+		/* Downloading a playlist is an asynchronous operation.
+		 * We have nothing left to do here.
+		 */
+		return;
+	} else {
+		const gchar *uri;
+
+		/* Play the first uri, unless we failed over to another one */
+		uri = g_slist_nth_data(uris, priv->stream_index);
+		if (uri == NULL)
+			uri = uris->data;
+
+		gv_engine_set_normalization_gain(priv->engine, lookup_station_gain(self));
+		gv_engine_play(priv->engine, uri);
+	}
+}
+
+static gboolean
+when_idle_apply_wish(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	priv->apply_wish_id = 0;
+
+	DEBUG("Applying wish, %u command(s) received", priv->n_commands);
+	priv->n_commands = 0;
+
+	apply_wish(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_wish(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	priv->n_commands++;
+
+	if (priv->apply_wish_id == 0)
+		priv->apply_wish_id = g_idle_add((GSourceFunc) when_idle_apply_wish, self);
+}
+
 /*
  * Signal handlers
  */
 
 static void gv_player_set_state(GvPlayer *self, GvPlayerState value);
+static void gv_player_failover(GvPlayer *self);
 
 static void
 on_station_notify(GvStation *station,
@@ -132,7 +392,7 @@ on_station_notify(GvStation *station,
 		/* Check if there are some streams, and start playing if needed */
 		if (gv_station_get_stream_uris(station))
 			if (priv->wish == GV_PLAYER_WISH_TO_PLAY)
-				gv_player_play(self);
+				schedule_wish(self);
 	}
 
 	/* In any case, we notify if something was changed in the station */
@@ -155,6 +415,9 @@ on_engine_notify(GvEngine  *engine,
 
 		engine_state = gv_engine_get_state(priv->engine);
 
+		/* Feed the station stats */
+		update_station_stats(self, engine_state);
+
 		/* Map engine state to player state - trivial */
 		switch (engine_state) {
 		case GV_ENGINE_STATE_STOPPED:
@@ -184,14 +447,59 @@ on_engine_notify(GvEngine  *engine,
 
 		metadata = gv_engine_get_metadata(engine);
 		gv_player_set_metadata(self, metadata);
+
+	} else if (!g_strcmp0(property_name, "silent")) {
+		/* Dead air, either try another stream, or let the user know */
+		if (gv_engine_get_silent(engine) == FALSE)
+			return;
+
+		if (priv->silence_failover)
+			gv_player_failover(self);
+		else
+			gv_errorable_emit_error(GV_ERRORABLE(self),
+			                        _("No sound from the station"));
+
+	} else if (!g_strcmp0(property_name, "normalization-gain")) {
+		/* Remember the gain, so that it applies on the next play */
+		remember_station_gain(self, gv_engine_get_normalization_gain(engine));
 	}
 }
 
+static void
+on_station_list_station_removed(GvStationList *station_list G_GNUC_UNUSED,
+                                GvStation     *station,
+                                GvPlayer      *self)
+{
+	const gchar *uri = gv_station_get_uri(station);
+
+	/* Don't keep the gain of a station that is gone */
+	if (uri)
+		forget_station_gain(self, uri);
+}
+
+/* The engine keeps playing, but the buffer ran low */
+static void
+on_engine_rebuffering(GvEngine *engine G_GNUC_UNUSED,
+                      GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	if (priv->station)
+		gv_station_report_rebuffer(priv->station);
+}
+
 static void
 on_engine_error(GvEngine *engine G_GNUC_UNUSED,
-                const gchar *error_string G_GNUC_UNUSED,
+                const gchar *error_string,
                 GvPlayer *self)
 {
+	GvPlayerPrivate *priv = self->priv;
+
+	/* Remember the failure */
+	if (priv->station)
+		gv_station_report_failure(priv->station, error_string);
+	priv->connect_start = 0;
+
 	/* Whatever the error, just stop */
 	gv_player_stop(self);
 }
@@ -211,6 +519,7 @@ gv_player_set_engine(GvPlayer *self, GvEngine *engine)
 	priv->engine = g_object_ref(engine);
 	g_signal_connect(priv->engine, "notify", G_CALLBACK(on_engine_notify), self);
 	g_signal_connect(priv->engine, "error", G_CALLBACK(on_engine_error), self);
+	g_signal_connect(priv->engine, "rebuffering", G_CALLBACK(on_engine_rebuffering), self);
 }
 
 static void
@@ -224,6 +533,22 @@ gv_player_set_station_list(GvPlayer *self, GvStationList *station_list)
 	priv->station_list = g_object_ref(station_list);
 }
 
+static void
+gv_player_set_zone(GvPlayer *self, const gchar *zone)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	/* This is a construct-only property */
+	g_assert_null(priv->zone);
+	priv->zone = g_strdup(zone);
+}
+
+const gchar *
+gv_player_get_zone(GvPlayer *self)
+{
+	return self->priv->zone;
+}
+
 GvPlayerState
 gv_player_get_state(GvPlayer *self)
 {
@@ -373,6 +698,42 @@ gv_player_set_autoplay(GvPlayer *self, gboolean autoplay)
 	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_AUTOPLAY]);
 }
 
+gboolean
+gv_player_get_silence_failover(GvPlayer *self)
+{
+	return self->priv->silence_failover;
+}
+
+void
+gv_player_set_silence_failover(GvPlayer *self, gboolean failover)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	if (priv->silence_failover == failover)
+		return;
+
+	priv->silence_failover = failover;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SILENCE_FAILOVER]);
+}
+
+gboolean
+gv_player_get_smart_next(GvPlayer *self)
+{
+	return self->priv->smart_next;
+}
+
+void
+gv_player_set_smart_next(GvPlayer *self, gboolean smart)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	if (priv->smart_next == smart)
+		return;
+
+	priv->smart_next = smart;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SMART_NEXT]);
+}
+
 GvMetadata *
 gv_player_get_metadata(GvPlayer *self)
 {
@@ -384,8 +745,14 @@ gv_player_set_metadata(GvPlayer *self, GvMetadata *metadata)
 {
 	GvPlayerPrivate *priv = self->priv;
 
-	if (g_set_object(&priv->metadata, metadata))
-		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_METADATA]);
+	if (priv->metadata == metadata)
+		return;
+
+	if (priv->metadata)
+		gv_metadata_unref(priv->metadata);
+	priv->metadata = metadata ? gv_metadata_ref(metadata) : NULL;
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_METADATA]);
 }
 
 GvStation *
@@ -400,7 +767,8 @@ gv_player_get_prev_station(GvPlayer *self)
 	GvPlayerPrivate *priv = self->priv;
 
 	return gv_station_list_prev(priv->station_list, priv->station,
-	                            priv->repeat, priv->shuffle);
+	                            priv->repeat, priv->shuffle,
+	                            priv->smart_next);
 }
 
 GvStation *
@@ -409,7 +777,8 @@ gv_player_get_next_station(GvPlayer *self)
 	GvPlayerPrivate *priv = self->priv;
 
 	return gv_station_list_next(priv->station_list, priv->station,
-	                            priv->repeat, priv->shuffle);
+	                            priv->repeat, priv->shuffle,
+	                            priv->smart_next);
 }
 
 static const gchar *
@@ -521,6 +890,9 @@ gv_player_get_property(GObject    *object,
 	TRACE_GET_PROPERTY(object, property_id, value, pspec);
 
 	switch (property_id) {
+	case PROP_ZONE:
+		g_value_set_string(value, gv_player_get_zone(self));
+		break;
 	case PROP_STATE:
 		g_value_set_enum(value, gv_player_get_state(self));
 		break;
@@ -539,8 +911,14 @@ gv_player_get_property(GObject    *object,
 	case PROP_AUTOPLAY:
 		g_value_set_boolean(value, gv_player_get_autoplay(self));
 		break;
+	case PROP_SILENCE_FAILOVER:
+		g_value_set_boolean(value, gv_player_get_silence_failover(self));
+		break;
+	case PROP_SMART_NEXT:
+		g_value_set_boolean(value, gv_player_get_smart_next(self));
+		break;
 	case PROP_METADATA:
-		g_value_set_object(value, gv_player_get_metadata(self));
+		g_value_set_boxed(value, gv_player_get_metadata(self));
 		break;
 	case PROP_STATION:
 		g_value_set_object(value, gv_player_get_station(self));
@@ -580,6 +958,9 @@ gv_player_set_property(GObject      *object,
 	case PROP_STATION_LIST:
 		gv_player_set_station_list(self, g_value_get_object(value));
 		break;
+	case PROP_ZONE:
+		gv_player_set_zone(self, g_value_get_string(value));
+		break;
 	case PROP_VOLUME:
 		gv_player_set_volume(self, g_value_get_uint(value));
 		break;
@@ -595,8 +976,14 @@ gv_player_set_property(GObject      *object,
 	case PROP_AUTOPLAY:
 		gv_player_set_autoplay(self, g_value_get_boolean(value));
 		break;
+	case PROP_SILENCE_FAILOVER:
+		gv_player_set_silence_failover(self, g_value_get_boolean(value));
+		break;
+	case PROP_SMART_NEXT:
+		gv_player_set_smart_next(self, g_value_get_boolean(value));
+		break;
 	case PROP_METADATA:
-		gv_player_set_metadata(self, g_value_get_object(value));
+		gv_player_set_metadata(self, g_value_get_boxed(value));
 		break;
 	case PROP_STATION:
 		gv_player_set_station(self, g_value_get_object(value));
@@ -621,17 +1008,17 @@ gv_player_stop(GvPlayer *self)
 
 	/* To remember what we're doing */
 	priv->wish = GV_PLAYER_WISH_TO_STOP;
+	priv->stream_index = 0;
+	priv->n_failovers = 0;
 
 	/* Stop playing */
-	gv_engine_stop(priv->engine);
+	schedule_wish(self);
 }
 
 void
 gv_player_play(GvPlayer *self)
 {
 	GvPlayerPrivate *priv = self->priv;
-	GvStation *station;
-	GSList *uris;
 
 	/* If no station is set yet, take the first from the station list */
 	if (priv->station == NULL) {
@@ -642,38 +1029,52 @@ gv_player_play(GvPlayer *self)
 	}
 
 	/* If there's still no station, return */
-	station = priv->station;
-	if (station == NULL)
+	if (priv->station == NULL)
 		return;
 
 	/* To remember what we're doing */
 	priv->wish = GV_PLAYER_WISH_TO_PLAY;
+	priv->stream_index = 0;
+	priv->n_failovers = 0;
 
-	/* Stop playing */
-	gv_engine_stop(priv->engine);
+	/* Start playing */
+	schedule_wish(self);
+}
 
-	/* Get station data */
-	uris = gv_station_get_stream_uris(station);
+static void
+gv_player_failover(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+	GSList *uris;
+	guint n_uris;
 
-	/* If there's no uris, that probably means that the station uri
-	 * points to a playlist, and we need to download it.
-	 */
-	if (uris == NULL) {
-		/* Download the playlist that contains the stream uris */
-		if (!gv_station_download_playlist(station))
-			WARNING("Can't download playlist");
+	if (priv->station == NULL || priv->wish != GV_PLAYER_WISH_TO_PLAY)
+		return;
 
-		/* Downloading a playlist is an asynchronous operation.
-		 * We have nothing left to do here.
-		 */
+	uris = gv_station_get_stream_uris(priv->station);
+	if (uris == NULL)
 		return;
-	} else {
-		const gchar *first_uri;
 
-		/* Play the first uri */
-		first_uri = (gchar *) uris->data;
-		gv_engine_play(priv->engine, first_uri);
+	/* Make one pass over the streams, then give up */
+	n_uris = g_slist_length(uris);
+	if (priv->n_failovers + 1 >= n_uris) {
+		INFO("No more stream to fail over to");
+		gv_errorable_emit_error(GV_ERRORABLE(self),
+		                        _("No sound from the station"));
+		gv_player_stop(self);
+		return;
 	}
+
+	/* Take the stream that comes after the current one, and go through
+	 * the command pipeline, so that the operation in flight is cancelled
+	 * and the station gain is applied, as for any other play.
+	 */
+	priv->n_failovers++;
+	priv->stream_index = (priv->stream_index + 1) % n_uris;
+
+	INFO("Failing over to stream '%s'",
+	     (gchar *) g_slist_nth_data(uris, priv->stream_index));
+	schedule_wish(self);
 }
 
 gboolean
@@ -792,6 +1193,16 @@ gv_player_new(GvEngine *engine, GvStationList *station_list)
 	                    NULL);
 }
 
+GvPlayer *
+gv_player_new_for_zone(GvEngine *engine, GvStationList *station_list, const gchar *zone)
+{
+	return g_object_new(GV_TYPE_PLAYER,
+	                    "engine", engine,
+	                    "station-list", station_list,
+	                    "zone", zone,
+	                    NULL);
+}
+
 /*
  * GObject methods
  */
@@ -804,9 +1215,15 @@ gv_player_finalize(GObject *object)
 
 	TRACE("%p", object);
 
+	/* Cancel pending operations */
+	if (priv->apply_wish_id)
+		g_source_remove(priv->apply_wish_id);
+	g_cancellable_cancel(priv->cancellable);
+	g_object_unref(priv->cancellable);
+
 	/* Unref the metadata */
 	if (priv->metadata)
-		g_object_unref(priv->metadata);
+		gv_metadata_unref(priv->metadata);
 
 	/* Unref the current station */
 	if (priv->station) {
@@ -815,8 +1232,19 @@ gv_player_finalize(GObject *object)
 	}
 
 	/* Unref the station list */
+	g_signal_handlers_disconnect_by_data(priv->station_list, self);
 	g_object_unref(priv->station_list);
 
+	/* Free zone name */
+	g_free(priv->zone);
+
+	/* Save and free station gains */
+	if (priv->save_station_gains_id) {
+		g_source_remove(priv->save_station_gains_id);
+		save_station_gains(self);
+	}
+	g_hash_table_unref(priv->station_gains);
+
 	/* Unref the engine */
 	g_signal_handlers_disconnect_by_data(priv->engine, self);
 	g_object_unref(priv->engine);
@@ -834,26 +1262,43 @@ gv_player_constructed(GObject *object)
 	TRACE("%p", object);
 
 	/* Initialize properties */
-	priv->volume   = DEFAULT_VOLUME;
-	priv->mute     = DEFAULT_MUTE;
-	priv->repeat   = DEFAULT_REPEAT;
-	priv->shuffle  = DEFAULT_SHUFFLE;
-	priv->autoplay = DEFAULT_AUTOPLAY;
-	priv->station  = NULL;
-
-	/* Bind settings */
-	g_settings_bind(gv_core_settings, "volume",
-	                self, "volume", G_SETTINGS_BIND_DEFAULT);
-	g_settings_bind(gv_core_settings, "mute",
-	                self, "mute", G_SETTINGS_BIND_DEFAULT);
-	g_settings_bind(gv_core_settings, "repeat",
-	                self, "repeat", G_SETTINGS_BIND_DEFAULT);
-	g_settings_bind(gv_core_settings, "shuffle",
-	                self, "shuffle", G_SETTINGS_BIND_DEFAULT);
-	g_settings_bind(gv_core_settings, "autoplay",
-	                self, "autoplay", G_SETTINGS_BIND_DEFAULT);
-	g_settings_bind(gv_core_settings, "station-uri",
-	                self, "station-uri", G_SETTINGS_BIND_DEFAULT);
+	priv->volume           = DEFAULT_VOLUME;
+	priv->mute             = DEFAULT_MUTE;
+	priv->repeat           = DEFAULT_REPEAT;
+	priv->shuffle          = DEFAULT_SHUFFLE;
+	priv->autoplay         = DEFAULT_AUTOPLAY;
+	priv->silence_failover = DEFAULT_SILENCE_FAILOVER;
+	priv->smart_next       = DEFAULT_SMART_NEXT;
+	priv->station          = NULL;
+
+	/* Load station gains */
+	priv->station_gains = g_hash_table_new_full(g_str_hash, g_str_equal,
+	                                            g_free, g_free);
+	if (priv->zone == NULL) {
+		load_station_gains(self);
+		g_signal_connect(priv->station_list, "station-removed",
+		                 G_CALLBACK(on_station_list_station_removed), self);
+	}
+
+	/* Bind settings, zones are not persistent */
+	if (priv->zone == NULL) {
+		g_settings_bind(gv_core_settings, "volume",
+		                self, "volume", G_SETTINGS_BIND_DEFAULT);
+		g_settings_bind(gv_core_settings, "mute",
+		                self, "mute", G_SETTINGS_BIND_DEFAULT);
+		g_settings_bind(gv_core_settings, "repeat",
+		                self, "repeat", G_SETTINGS_BIND_DEFAULT);
+		g_settings_bind(gv_core_settings, "shuffle",
+		                self, "shuffle", G_SETTINGS_BIND_DEFAULT);
+		g_settings_bind(gv_core_settings, "autoplay",
+		                self, "autoplay", G_SETTINGS_BIND_DEFAULT);
+		g_settings_bind(gv_core_settings, "station-uri",
+		                self, "station-uri", G_SETTINGS_BIND_DEFAULT);
+		g_settings_bind(gv_core_settings, "silence-failover",
+		                self, "silence-failover", G_SETTINGS_BIND_DEFAULT);
+		g_settings_bind(gv_core_settings, "smart-next",
+		                self, "smart-next", G_SETTINGS_BIND_DEFAULT);
+	}
 
 	/* Chain up */
 	G_OBJECT_CHAINUP_CONSTRUCTED(gv_player, object);
@@ -866,6 +1311,9 @@ gv_player_init(GvPlayer *self)
 
 	/* Initialize private pointer */
 	self->priv = gv_player_get_instance_private(self);
+
+	/* Initialize internal state */
+	self->priv->cancellable = g_cancellable_new();
 }
 
 static void
@@ -895,6 +1343,13 @@ gv_player_class_init(GvPlayerClass *class)
 	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_WRITABLE |
 	                            G_PARAM_CONSTRUCT_ONLY);
 
+	properties[PROP_ZONE] =
+	        g_param_spec_string("zone", "Zone",
+	                            "Name of the zone, NULL for the main player",
+	                            NULL,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE |
+	                            G_PARAM_CONSTRUCT_ONLY);
+
 	properties[PROP_STATE] =
 	        g_param_spec_enum("state", "Playback State", NULL,
 	                          GV_PLAYER_STATE_ENUM_TYPE,
@@ -926,10 +1381,22 @@ gv_player_class_init(GvPlayerClass *class)
 	                             DEFAULT_AUTOPLAY,
 	                             GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
 
+	properties[PROP_SILENCE_FAILOVER] =
+	        g_param_spec_boolean("silence-failover", "Failover On Silence",
+	                             "Whether to try another stream when the station is silent",
+	                             DEFAULT_SILENCE_FAILOVER,
+	                             GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_SMART_NEXT] =
+	        g_param_spec_boolean("smart-next", "Smart Next",
+	                             "Whether to skip dead stations and favor healthy ones",
+	                             DEFAULT_SMART_NEXT,
+	                             GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
 	properties[PROP_METADATA] =
-	        g_param_spec_object("metadata", "Current Metadata", NULL,
-	                            GV_TYPE_METADATA,
-	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+	        g_param_spec_boxed("metadata", "Current Metadata", NULL,
+	                           GV_TYPE_METADATA,
+	                           GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
 
 	properties[PROP_STATION] =
 	        g_param_spec_object("station", "Current Station", NULL,
@@ -45,6 +45,8 @@ typedef enum {
 /* Methods */
 
 GvPlayer    *gv_player_new              (GvEngine *engine, GvStationList *station_list);
+GvPlayer    *gv_player_new_for_zone     (GvEngine *engine, GvStationList *station_list,
+                                          const gchar *zone);
 
 void          gv_player_go               (GvPlayer *self, const gchar *string_to_play);
 
@@ -56,6 +58,7 @@ gboolean      gv_player_next             (GvPlayer *self);
 
 /* Property accessors */
 
+const gchar   *gv_player_get_zone        (GvPlayer *self);
 GvPlayerState gv_player_get_state       (GvPlayer *self);
 gboolean       gv_player_get_repeat      (GvPlayer *self);
 void           gv_player_set_repeat      (GvPlayer *self, gboolean repeat);
@@ -63,6 +66,10 @@ gboolean       gv_player_get_shuffle     (GvPlayer *self);
 void           gv_player_set_shuffle     (GvPlayer *self, gboolean shuffle);
 gboolean       gv_player_get_autoplay    (GvPlayer *self);
 void           gv_player_set_autoplay    (GvPlayer *self, gboolean autoplay);
+gboolean       gv_player_get_silence_failover(GvPlayer *self);
+void           gv_player_set_silence_failover(GvPlayer *self, gboolean failover);
+gboolean       gv_player_get_smart_next  (GvPlayer *self);
+void           gv_player_set_smart_next  (GvPlayer *self, gboolean smart);
 guint          gv_player_get_volume      (GvPlayer *self);
 void           gv_player_set_volume      (GvPlayer *self, guint volume);
 void           gv_player_lower_volume    (GvPlayer *self);
@@ -80,6 +80,9 @@ struct _GvPlaylistPrivate {
 	gchar             *uri;
 	GvPlaylistFormat format;
 	GSList           *streams;
+	/* Download in progress */
+	SoupSession      *session;
+	SoupMessage      *message;
 };
 
 typedef struct _GvPlaylistPrivate GvPlaylistPrivate;
@@ -354,6 +357,18 @@ on_message_completed(SoupSession *session,
 
 	TRACE("%p, %p, %p", session, msg, self);
 
+	/* Download is over */
+	priv->session = NULL;
+	priv->message = NULL;
+
+	/* Cancelled downloads are not reported */
+	if (msg->status_code == SOUP_STATUS_CANCELLED) {
+		DEBUG("Playlist download cancelled");
+		g_object_unref(session);
+		g_object_unref(self);
+		return;
+	}
+
 	/* Check the response */
 	if (!SOUP_STATUS_IS_SUCCESSFUL(msg->status_code)) {
 		WARNING("Failed to download playlist: %s", msg->reason_phrase);
@@ -411,6 +426,9 @@ end:
 
 	/* Emit completion signal */
 	g_signal_emit(self, signals[SIGNAL_DOWNLOADED], 0);
+
+	/* Release the reference taken for the download */
+	g_object_unref(self);
 }
 
 /*
@@ -502,14 +520,36 @@ gv_playlist_download(GvPlaylist *self)
 	SoupSession *session;
 	SoupMessage *msg;
 
+	if (priv->message) {
+		DEBUG("Playlist download already in progress");
+		return;
+	}
+
 	session = soup_session_new_with_options(SOUP_SESSION_USER_AGENT,
 	                                        gv_core_user_agent,
 	                                        NULL);
 	msg = soup_message_new("GET", priv->uri);
 
+	priv->session = session;
+	priv->message = msg;
+
+	/* Keep the playlist alive until the download is over */
 	soup_session_queue_message(session, msg,
 	                           (SoupSessionCallback) on_message_completed,
-	                           self);
+	                           g_object_ref(self));
+}
+
+void
+gv_playlist_cancel(GvPlaylist *self)
+{
+	GvPlaylistPrivate *priv = self->priv;
+
+	if (priv->message == NULL)
+		return;
+
+	/* The completion callback is invoked, and doesn't emit any signal */
+	soup_session_cancel_message(priv->session, priv->message,
+	                            SOUP_STATUS_CANCELLED);
 }
 
 GvPlaylist *
@@ -46,6 +46,7 @@ GvPlaylistFormat gv_playlist_get_format(const gchar *uri);
 
 GvPlaylist *gv_playlist_new     (const gchar *uri);
 void         gv_playlist_download(GvPlaylist *playlist);
+void         gv_playlist_cancel  (GvPlaylist *playlist);
 
 /* Property accessors */
 
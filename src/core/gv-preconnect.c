@@ -0,0 +1,376 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "additions/glib-object.h"
+#include "framework/gv-framework.h"
+#include "core/gv-station.h"
+
+#include "core/gv-preconnect.h"
+
+/*
+ * Speculative work for a station that the user is likely to play soon,
+ * typically because it's hovered or selected in the station list: the
+ * playlist is downloaded, and the host names of the streams are resolved.
+ * That's the part of the job that can be done in advance: the audio
+ * pipeline opens its own connections, there's no way to hand it over
+ * an established one.
+ *
+ * Only the last hint is relevant. When the hint changes, the work for the
+ * previous station is cancelled. On top of that, a cap on the number of
+ * jobs protects against hints coming in too fast.
+ */
+
+/* How long a station must be hinted before starting the work */
+#define PRECONNECT_DELAY 200 /* ms */
+
+/* Maximum number of jobs in progress */
+#define MAX_JOBS 2
+
+typedef struct {
+	GvPreconnect *self;
+	GvStation    *station;
+	GCancellable *cancellable;
+	/* Waiting for the playlist */
+	gulong        stream_uris_handler;
+	/* Waiting for the resolver */
+	gboolean      lookup_pending;
+} Job;
+
+/*
+ * GObject definitions
+ */
+
+struct _GvPreconnectPrivate {
+	/* Station hinted */
+	GvStation *station;
+	guint      timeout_id;
+	/* Jobs in progress, oldest first */
+	GQueue     jobs;
+};
+
+typedef struct _GvPreconnectPrivate GvPreconnectPrivate;
+
+struct _GvPreconnect {
+	/* Parent instance structure */
+	GObject              parent_instance;
+	/* Private data */
+	GvPreconnectPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GvPreconnect, gv_preconnect, G_TYPE_OBJECT)
+
+/*
+ * Jobs
+ */
+
+static Job *
+job_new(GvPreconnect *self, GvStation *station)
+{
+	Job *job;
+
+	job = g_new0(Job, 1);
+	job->self = self;
+	job->station = g_object_ref(station);
+	job->cancellable = g_cancellable_new();
+
+	return job;
+}
+
+static void
+job_free(Job *job)
+{
+	g_object_unref(job->cancellable);
+	g_object_unref(job->station);
+	g_free(job);
+}
+
+static Job *
+find_job(GvPreconnect *self, GvStation *station)
+{
+	GvPreconnectPrivate *priv = self->priv;
+	GList *item;
+
+	for (item = priv->jobs.head; item; item = item->next) {
+		Job *job = item->data;
+
+		if (job->station == station)
+			return job;
+	}
+
+	return NULL;
+}
+
+/* Remove a job that is over. If a lookup is pending, the job is freed
+ * in the lookup callback.
+ */
+static void
+finish_job(GvPreconnect *self, Job *job)
+{
+	GvPreconnectPrivate *priv = self->priv;
+
+	g_queue_remove(&priv->jobs, job);
+
+	if (job->stream_uris_handler) {
+		g_signal_handler_disconnect(job->station, job->stream_uris_handler);
+		job->stream_uris_handler = 0;
+	}
+
+	if (job->lookup_pending == FALSE)
+		job_free(job);
+}
+
+static void
+cancel_job(GvPreconnect *self, Job *job)
+{
+	DEBUG("Cancelling preconnect for station %p", job->station);
+
+	/* This also cancels the playlist download, unless someone else
+	 * is waiting for it.
+	 */
+	g_cancellable_cancel(job->cancellable);
+
+	finish_job(self, job);
+}
+
+static void
+on_lookup_done(GResolver    *resolver,
+               GAsyncResult *result,
+               gpointer      data)
+{
+	Job *job = data;
+	GError *err = NULL;
+	GList *addresses;
+
+	job->lookup_pending = FALSE;
+
+	addresses = g_resolver_lookup_by_name_finish(resolver, result, &err);
+
+	/* If the job was cancelled, it's not in the queue anymore,
+	 * and job->self might be gone already.
+	 */
+	if (g_cancellable_is_cancelled(job->cancellable)) {
+		g_clear_error(&err);
+		if (addresses)
+			g_resolver_free_addresses(addresses);
+		job_free(job);
+		return;
+	}
+
+	if (addresses) {
+		DEBUG("Station %p: stream host resolved", job->station);
+		g_resolver_free_addresses(addresses);
+	} else {
+		DEBUG("Station %p: failed to resolve stream host: %s",
+		      job->station, err->message);
+		g_clear_error(&err);
+	}
+
+	finish_job(job->self, job);
+}
+
+static void
+lookup_stream_host(GvPreconnect *self, Job *job)
+{
+	GResolver *resolver;
+	GSList *uris;
+	SoupURI *uri;
+	const gchar *host;
+
+	uris = gv_station_get_stream_uris(job->station);
+	uri = uris ? soup_uri_new(uris->data) : NULL;
+	host = uri ? soup_uri_get_host(uri) : NULL;
+
+	if (host == NULL || g_hostname_is_ip_address(host)) {
+		if (uri)
+			soup_uri_free(uri);
+		finish_job(self, job);
+		return;
+	}
+
+	/* The resolver result is thrown away, but it leaves the host in the
+	 * system's cache, if there's one.
+	 */
+	DEBUG("Station %p: resolving stream host '%s'", job->station, host);
+
+	job->lookup_pending = TRUE;
+	resolver = g_resolver_get_default();
+	g_resolver_lookup_by_name_async(resolver, host, job->cancellable,
+	                                (GAsyncReadyCallback) on_lookup_done, job);
+	g_object_unref(resolver);
+
+	soup_uri_free(uri);
+}
+
+static void
+on_station_notify_stream_uris(GvStation  *station G_GNUC_UNUSED,
+                              GParamSpec *pspec G_GNUC_UNUSED,
+                              gpointer    data)
+{
+	Job *job = data;
+
+	g_signal_handler_disconnect(job->station, job->stream_uris_handler);
+	job->stream_uris_handler = 0;
+
+	lookup_stream_host(job->self, job);
+}
+
+static void
+start_job(GvPreconnect *self, GvStation *station)
+{
+	GvPreconnectPrivate *priv = self->priv;
+	Job *job;
+
+	if (find_job(self, station))
+		return;
+
+	/* Make room, the oldest job is the least relevant */
+	while (priv->jobs.length >= MAX_JOBS)
+		cancel_job(self, g_queue_peek_head(&priv->jobs));
+
+	DEBUG("Preconnecting station %p", station);
+
+	job = job_new(self, station);
+	g_queue_push_tail(&priv->jobs, job);
+
+	/* Streams are known, or they will be once the playlist is downloaded */
+	if (gv_station_get_stream_uris(station)) {
+		lookup_stream_host(self, job);
+	} else if (gv_station_download_playlist(station, job->cancellable)) {
+		job->stream_uris_handler =
+		        g_signal_connect(station, "notify::stream-uris",
+		                         G_CALLBACK(on_station_notify_stream_uris), job);
+	} else {
+		finish_job(self, job);
+	}
+}
+
+/*
+ * Signal handlers & callbacks
+ */
+
+static gboolean
+when_timeout_start_job(GvPreconnect *self)
+{
+	GvPreconnectPrivate *priv = self->priv;
+
+	priv->timeout_id = 0;
+
+	if (priv->station)
+		start_job(self, priv->station);
+
+	return G_SOURCE_REMOVE;
+}
+
+/*
+ * Public methods
+ */
+
+/* Let the preconnect know which station is likely to be played next,
+ * or NULL if there's none anymore.
+ */
+void
+gv_preconnect_hint(GvPreconnect *self, GvStation *station)
+{
+	GvPreconnectPrivate *priv = self->priv;
+	Job *job;
+
+	if (priv->station == station)
+		return;
+
+	/* Forget about the previous station */
+	if (priv->station) {
+		job = find_job(self, priv->station);
+		if (job)
+			cancel_job(self, job);
+		g_clear_object(&priv->station);
+	}
+
+	if (priv->timeout_id) {
+		g_source_remove(priv->timeout_id);
+		priv->timeout_id = 0;
+	}
+
+	if (station == NULL)
+		return;
+
+	/* Wait a bit before doing anything, the hint might not last */
+	priv->station = g_object_ref(station);
+	priv->timeout_id = g_timeout_add(PRECONNECT_DELAY,
+	                                 (GSourceFunc) when_timeout_start_job, self);
+}
+
+GvPreconnect *
+gv_preconnect_new(void)
+{
+	return g_object_new(GV_TYPE_PRECONNECT, NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_preconnect_finalize(GObject *object)
+{
+	GvPreconnect *self = GV_PRECONNECT(object);
+	GvPreconnectPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Cancel everything */
+	if (priv->timeout_id)
+		g_source_remove(priv->timeout_id);
+
+	while (!g_queue_is_empty(&priv->jobs))
+		cancel_job(self, g_queue_peek_head(&priv->jobs));
+
+	if (priv->station)
+		g_object_unref(priv->station);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_preconnect, object);
+}
+
+static void
+gv_preconnect_init(GvPreconnect *self)
+{
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = gv_preconnect_get_instance_private(self);
+
+	/* Initialize internal state */
+	g_queue_init(&self->priv->jobs);
+}
+
+static void
+gv_preconnect_class_init(GvPreconnectClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_preconnect_finalize;
+}
@@ -0,0 +1,38 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GOODVIBES_CORE_GV_PRECONNECT_H__
+#define __GOODVIBES_CORE_GV_PRECONNECT_H__
+
+#include <glib-object.h>
+
+#include "core/gv-station.h"
+
+/* GObject declarations */
+
+#define GV_TYPE_PRECONNECT gv_preconnect_get_type()
+
+G_DECLARE_FINAL_TYPE(GvPreconnect, gv_preconnect, GV, PRECONNECT, GObject)
+
+/* Methods */
+
+GvPreconnect *gv_preconnect_new (void);
+void          gv_preconnect_hint(GvPreconnect *self, GvStation *station);
+
+#endif /* __GOODVIBES_CORE_GV_PRECONNECT_H__ */
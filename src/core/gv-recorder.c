@@ -0,0 +1,723 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <gst/gst.h>
+
+#include "additions/glib-object.h"
+#include "framework/gv-framework.h"
+#include "core/gv-core-internal.h"
+#include "core/gv-engine.h"
+#include "core/gv-metadata.h"
+
+#include "core/gv-recorder.h"
+
+/* Maximum amount of data waiting to be written to disk. If the disk can't
+ * keep up, incoming data is dropped, so that the streaming thread is never
+ * blocked and playback is not affected.
+ */
+
+#define MAX_QUEUED_BYTES (2 * 1024 * 1024)
+
+/*
+ * Properties
+ */
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Construct properties */
+	PROP_ENGINE,
+	/* Properties */
+	PROP_RECORDING,
+	PROP_DIRECTORY,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+/*
+ * Writer queue items
+ */
+
+typedef enum {
+	ITEM_DATA,
+	ITEM_SPLIT,
+	ITEM_NEW_STREAM,
+	ITEM_QUIT
+} ItemType;
+
+typedef struct {
+	ItemType   type;
+	GstBuffer *buffer;
+	gchar     *title;
+} Item;
+
+static Item *
+item_new(ItemType type, GstBuffer *buffer, const gchar *title)
+{
+	Item *item;
+
+	item = g_slice_new0(Item);
+	item->type = type;
+	item->buffer = buffer;
+	item->title = g_strdup(title);
+
+	return item;
+}
+
+static void
+item_free(Item *item)
+{
+	if (item->buffer)
+		gst_buffer_unref(item->buffer);
+	g_free(item->title);
+	g_slice_free(Item, item);
+}
+
+/*
+ * GObject definitions
+ */
+
+struct _GvRecorderPrivate {
+	/* Construct-only properties */
+	GvEngine    *engine;
+	/* Properties */
+	gboolean     recording;
+	gchar       *directory;
+	/* Writer thread */
+	GThread     *thread;
+	GAsyncQueue *queue;
+	gchar       *thread_directory;
+	const gchar *thread_extension;
+	gint         queued_bytes;
+	gint         dropped_bytes;
+};
+
+typedef struct _GvRecorderPrivate GvRecorderPrivate;
+
+struct _GvRecorder {
+	/* Parent instance structure */
+	GObject            parent_instance;
+	/* Private data */
+	GvRecorderPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GvRecorder, gv_recorder, G_TYPE_OBJECT,
+                        G_ADD_PRIVATE(GvRecorder)
+                        G_IMPLEMENT_INTERFACE(GV_TYPE_ERRORABLE, NULL))
+
+/*
+ * Helpers
+ */
+
+static const struct {
+	const gchar *mime_type;
+	const gchar *extension;
+} extensions[] = {
+	{ "audio/mpeg",         "mp3"  },
+	{ "audio/aac",          "aac"  },
+	{ "audio/x-aac",        "aac"  },
+	{ "audio/ogg",          "ogg"  },
+	{ "application/ogg",    "ogg"  },
+	{ "audio/x-vorbis+ogg", "ogg"  },
+	{ "audio/x-opus+ogg",   "opus" },
+	{ "audio/flac",         "flac" },
+	{ "audio/x-flac",       "flac" },
+	{ NULL,                 NULL   }
+};
+
+static const gchar *
+guess_extension(GstBuffer *buffer)
+{
+	const gchar *extension = "bin";
+	gchar *content_type;
+	gchar *mime_type;
+	GstMapInfo map;
+	guint i;
+
+	/* The stream is written as it is, so we sniff the data to find out
+	 * what it is, and give the file a meaningful extension.
+	 */
+	if (!gst_buffer_map(buffer, &map, GST_MAP_READ))
+		return extension;
+
+	content_type = g_content_type_guess(NULL, map.data, map.size, NULL);
+	gst_buffer_unmap(buffer, &map);
+
+	mime_type = g_content_type_get_mime_type(content_type);
+	if (mime_type == NULL)
+		goto out;
+
+	for (i = 0; extensions[i].mime_type; i++) {
+		if (!g_strcmp0(mime_type, extensions[i].mime_type)) {
+			extension = extensions[i].extension;
+			break;
+		}
+	}
+
+out:
+	DEBUG("Stream content type: %s (%s)", content_type, mime_type);
+	g_free(mime_type);
+	g_free(content_type);
+
+	return extension;
+}
+
+static gchar *
+make_filename(const gchar *title, const gchar *extension)
+{
+	GDateTime *now;
+	gchar *timestamp;
+	gchar *filename;
+
+	now = g_date_time_new_now_local();
+	timestamp = g_date_time_format(now, "%Y-%m-%d %H.%M.%S");
+	g_date_time_unref(now);
+
+	if (title && title[0] != '\0') {
+		gchar *safe_title;
+
+		safe_title = g_strdelimit(g_strdup(title), G_DIR_SEPARATOR_S, '-');
+		filename = g_strdup_printf("%s - %s.%s", timestamp, safe_title, extension);
+		g_free(safe_title);
+	} else {
+		filename = g_strdup_printf("%s.%s", timestamp, extension);
+	}
+
+	g_free(timestamp);
+
+	return filename;
+}
+
+static gchar *
+make_recording_directory(const gchar *directory)
+{
+	const gchar *music_dir;
+
+	if (directory && directory[0] != '\0')
+		return g_strdup(directory);
+
+	music_dir = g_get_user_special_dir(G_USER_DIRECTORY_MUSIC);
+	if (music_dir == NULL)
+		music_dir = g_get_home_dir();
+
+	return g_build_filename(music_dir, PACKAGE_CAMEL_NAME, NULL);
+}
+
+/*
+ * Writer thread
+ */
+
+typedef struct {
+	GvRecorder *recorder;
+	gchar      *message;
+} ErrorReport;
+
+static gboolean
+when_idle_report_error(ErrorReport *report)
+{
+	gv_errorable_emit_error(GV_ERRORABLE(report->recorder), report->message);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+error_report_free(ErrorReport *report)
+{
+	g_object_unref(report->recorder);
+	g_free(report->message);
+	g_free(report);
+}
+
+static void
+report_error(GvRecorder *self, const gchar *message)
+{
+	ErrorReport *report;
+
+	/* Errors must be emitted from the main thread */
+	report = g_new0(ErrorReport, 1);
+	report->recorder = g_object_ref(self);
+	report->message = g_strdup(message);
+
+	g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, (GSourceFunc) when_idle_report_error,
+	                report, (GDestroyNotify) error_report_free);
+}
+
+static FILE *
+open_file(const gchar *directory, const gchar *title, const gchar *extension, GError **err)
+{
+	FILE *file;
+	gchar *filename;
+	gchar *path;
+
+	if (g_mkdir_with_parents(directory, 0755) != 0) {
+		g_set_error(err, G_FILE_ERROR, g_file_error_from_errno(errno),
+		            "Failed to create directory '%s': %s",
+		            directory, g_strerror(errno));
+		return NULL;
+	}
+
+	filename = make_filename(title, extension);
+	path = g_build_filename(directory, filename, NULL);
+
+	file = g_fopen(path, "wb");
+	if (file == NULL)
+		g_set_error(err, G_FILE_ERROR, g_file_error_from_errno(errno),
+		            "Failed to open file '%s': %s",
+		            path, g_strerror(errno));
+	else
+		INFO("Recording to '%s'", path);
+
+	g_free(path);
+	g_free(filename);
+
+	return file;
+}
+
+static gboolean
+write_buffer(FILE *file, GstBuffer *buffer, GError **err)
+{
+	guint i, n;
+
+	/* Write memory blocks one by one, mapping the whole buffer
+	 * at once might involve a copy if there's several blocks.
+	 */
+	n = gst_buffer_n_memory(buffer);
+	for (i = 0; i < n; i++) {
+		GstMemory *memory = gst_buffer_peek_memory(buffer, i);
+		GstMapInfo map;
+		gsize written;
+
+		if (!gst_memory_map(memory, &map, GST_MAP_READ))
+			continue;
+
+		written = fwrite(map.data, 1, map.size, file);
+		gst_memory_unmap(memory, &map);
+
+		if (written < map.size) {
+			g_set_error(err, G_FILE_ERROR, g_file_error_from_errno(errno),
+			            "Failed to write: %s", g_strerror(errno));
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static void
+close_file(FILE **file)
+{
+	if (*file == NULL)
+		return;
+
+	fclose(*file);
+	*file = NULL;
+}
+
+static gpointer
+writer_thread(GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+	FILE *file = NULL;
+	gchar *title = NULL;
+	gboolean failed = FALSE;
+	gboolean quit = FALSE;
+
+	while (quit == FALSE) {
+		GError *err = NULL;
+		Item *item;
+
+		item = g_async_queue_pop(priv->queue);
+
+		switch (item->type) {
+		case ITEM_DATA:
+			g_atomic_int_add(&priv->queued_bytes,
+			                 - (gint) gst_buffer_get_size(item->buffer));
+
+			/* After a failure, data is discarded until the next split */
+			if (failed)
+				break;
+
+			/* Only the beginning of a stream can be sniffed, so the
+			 * extension is guessed once, and kept for every split.
+			 */
+			if (priv->thread_extension == NULL)
+				priv->thread_extension = guess_extension(item->buffer);
+
+			if (file == NULL)
+				file = open_file(priv->thread_directory, title,
+				                 priv->thread_extension, &err);
+
+			if (file && !write_buffer(file, item->buffer, &err))
+				close_file(&file);
+
+			if (err) {
+				WARNING("%s", err->message);
+				report_error(self, err->message);
+				g_error_free(err);
+				failed = TRUE;
+			}
+			break;
+
+		case ITEM_NEW_STREAM:
+			priv->thread_extension = NULL;
+			/* fall through */
+		case ITEM_SPLIT:
+			close_file(&file);
+			g_free(title);
+			title = g_strdup(item->title);
+			failed = FALSE;
+			break;
+
+		case ITEM_QUIT:
+			quit = TRUE;
+			break;
+		}
+
+		item_free(item);
+	}
+
+	close_file(&file);
+	g_free(title);
+
+	return NULL;
+}
+
+static void on_engine_tap(GstBuffer *buffer, GvRecorder *self);
+
+static void
+stop_writer(GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+	gint dropped_bytes;
+
+	/* Once the tap is removed, nothing is pushed to the queue anymore */
+	gv_engine_remove_tap(priv->engine, (GvEngineTapFunc) on_engine_tap, self);
+
+	/* Let the writer thread flush the queue and terminate */
+	g_async_queue_push(priv->queue, item_new(ITEM_QUIT, NULL, NULL));
+	g_thread_join(priv->thread);
+	priv->thread = NULL;
+
+	g_async_queue_unref(priv->queue);
+	priv->queue = NULL;
+
+	g_free(priv->thread_directory);
+	priv->thread_directory = NULL;
+	priv->thread_extension = NULL;
+
+	dropped_bytes = g_atomic_int_get(&priv->dropped_bytes);
+	if (dropped_bytes > 0)
+		WARNING("Disk too slow, %d bytes were dropped", dropped_bytes);
+}
+
+/*
+ * Signal handlers
+ */
+
+static void
+on_engine_tap(GstBuffer *buffer, GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+	gint size = gst_buffer_get_size(buffer);
+
+	/* This is invoked from the streaming thread, we must never block here */
+	if (g_atomic_int_get(&priv->queued_bytes) + size > MAX_QUEUED_BYTES) {
+		g_atomic_int_add(&priv->dropped_bytes, size);
+		return;
+	}
+
+	g_atomic_int_add(&priv->queued_bytes, size);
+	g_async_queue_push(priv->queue, item_new(ITEM_DATA, gst_buffer_ref(buffer), NULL));
+}
+
+static void
+split(GvRecorder *self, ItemType type)
+{
+	GvRecorderPrivate *priv = self->priv;
+	GvMetadata *metadata;
+	gchar *title = NULL;
+
+	metadata = gv_engine_get_metadata(priv->engine);
+	if (metadata)
+		title = gv_metadata_make_title_artist(metadata, FALSE);
+
+	g_async_queue_push(priv->queue, item_new(type, NULL, title));
+
+	g_free(title);
+}
+
+static void
+on_engine_notify(GvEngine   *engine G_GNUC_UNUSED,
+                 GParamSpec *pspec,
+                 GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+	const gchar *property_name = g_param_spec_get_name(pspec);
+
+	if (priv->recording == FALSE)
+		return;
+
+	/* A new song or a new stream means a new file. Notice that the data
+	 * already queued still goes to the previous file, since the split is
+	 * queued behind it.
+	 */
+	if (!g_strcmp0(property_name, "metadata")) {
+		if (gv_engine_get_metadata(priv->engine))
+			split(self, ITEM_SPLIT);
+	} else if (!g_strcmp0(property_name, "stream-uri")) {
+		split(self, ITEM_NEW_STREAM);
+	}
+}
+
+/*
+ * Property accessors
+ */
+
+static void
+gv_recorder_set_engine(GvRecorder *self, GvEngine *engine)
+{
+	GvRecorderPrivate *priv = self->priv;
+
+	/* This is a construct-only property */
+	g_assert_null(priv->engine);
+	g_assert_nonnull(engine);
+	priv->engine = g_object_ref(engine);
+	g_signal_connect(priv->engine, "notify", G_CALLBACK(on_engine_notify), self);
+}
+
+gboolean
+gv_recorder_get_recording(GvRecorder *self)
+{
+	return self->priv->recording;
+}
+
+const gchar *
+gv_recorder_get_directory(GvRecorder *self)
+{
+	return self->priv->directory;
+}
+
+void
+gv_recorder_set_directory(GvRecorder *self, const gchar *directory)
+{
+	GvRecorderPrivate *priv = self->priv;
+
+	if (!g_strcmp0(priv->directory, directory))
+		return;
+
+	g_free(priv->directory);
+	priv->directory = g_strdup(directory);
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_DIRECTORY]);
+}
+
+static void
+gv_recorder_get_property(GObject    *object,
+                         guint       property_id,
+                         GValue     *value,
+                         GParamSpec *pspec)
+{
+	GvRecorder *self = GV_RECORDER(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_RECORDING:
+		g_value_set_boolean(value, gv_recorder_get_recording(self));
+		break;
+	case PROP_DIRECTORY:
+		g_value_set_string(value, gv_recorder_get_directory(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_recorder_set_property(GObject      *object,
+                         guint         property_id,
+                         const GValue *value,
+                         GParamSpec   *pspec)
+{
+	GvRecorder *self = GV_RECORDER(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_ENGINE:
+		gv_recorder_set_engine(self, g_value_get_object(value));
+		break;
+	case PROP_DIRECTORY:
+		gv_recorder_set_directory(self, g_value_get_string(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Public methods
+ */
+
+void
+gv_recorder_start(GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+
+	if (priv->recording)
+		return;
+
+	/* Start the writer thread */
+	priv->thread_directory = make_recording_directory(priv->directory);
+	priv->queue = g_async_queue_new_full((GDestroyNotify) item_free);
+	priv->queued_bytes = 0;
+	priv->dropped_bytes = 0;
+	priv->thread = g_thread_new("recorder", (GThreadFunc) writer_thread, self);
+
+	/* Name the first file after the current song */
+	split(self, ITEM_NEW_STREAM);
+
+	/* Get the data flowing */
+	gv_engine_add_tap(priv->engine, (GvEngineTapFunc) on_engine_tap, self);
+
+	priv->recording = TRUE;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_RECORDING]);
+
+	INFO("Recording started (%s)", priv->thread_directory);
+}
+
+void
+gv_recorder_stop(GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+
+	if (priv->recording == FALSE)
+		return;
+
+	stop_writer(self);
+
+	priv->recording = FALSE;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_RECORDING]);
+
+	INFO("Recording stopped");
+}
+
+GvRecorder *
+gv_recorder_new(GvEngine *engine)
+{
+	return g_object_new(GV_TYPE_RECORDER,
+	                    "engine", engine,
+	                    NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_recorder_finalize(GObject *object)
+{
+	GvRecorder *self = GV_RECORDER(object);
+	GvRecorderPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Stop recording */
+	if (priv->recording)
+		stop_writer(self);
+
+	/* Free properties */
+	g_free(priv->directory);
+
+	/* Unref the engine */
+	g_signal_handlers_disconnect_by_data(priv->engine, self);
+	g_object_unref(priv->engine);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_recorder, object);
+}
+
+static void
+gv_recorder_constructed(GObject *object)
+{
+	GvRecorder *self = GV_RECORDER(object);
+
+	TRACE("%p", object);
+
+	/* Bind settings */
+	g_settings_bind(gv_core_settings, "recording-directory",
+	                self, "directory", G_SETTINGS_BIND_DEFAULT);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_recorder, object);
+}
+
+static void
+gv_recorder_init(GvRecorder *self)
+{
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = gv_recorder_get_instance_private(self);
+}
+
+static void
+gv_recorder_class_init(GvRecorderClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_recorder_finalize;
+	object_class->constructed = gv_recorder_constructed;
+
+	/* Properties */
+	object_class->get_property = gv_recorder_get_property;
+	object_class->set_property = gv_recorder_set_property;
+
+	properties[PROP_ENGINE] =
+	        g_param_spec_object("engine", "Engine", NULL,
+	                            GV_TYPE_ENGINE,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_WRITABLE |
+	                            G_PARAM_CONSTRUCT_ONLY);
+
+	properties[PROP_RECORDING] =
+	        g_param_spec_boolean("recording", "Recording", NULL,
+	                             FALSE,
+	                             GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
+
+	properties[PROP_DIRECTORY] =
+	        g_param_spec_string("directory", "Recording Directory",
+	                            "Where to save recordings, empty for the default",
+	                            NULL,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+}
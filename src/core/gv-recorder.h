@@ -0,0 +1,45 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GOODVIBES_CORE_GV_RECORDER_H__
+#define __GOODVIBES_CORE_GV_RECORDER_H__
+
+#include <glib-object.h>
+
+#include "core/gv-engine.h"
+
+/* GObject declarations */
+
+#define GV_TYPE_RECORDER gv_recorder_get_type()
+
+G_DECLARE_FINAL_TYPE(GvRecorder, gv_recorder, GV, RECORDER, GObject)
+
+/* Methods */
+
+GvRecorder *gv_recorder_new  (GvEngine *engine);
+void        gv_recorder_start(GvRecorder *self);
+void        gv_recorder_stop (GvRecorder *self);
+
+/* Property accessors */
+
+gboolean     gv_recorder_get_recording(GvRecorder *self);
+const gchar *gv_recorder_get_directory(GvRecorder *self);
+void         gv_recorder_set_directory(GvRecorder *self, const gchar *directory);
+
+#endif /* __GOODVIBES_CORE_GV_RECORDER_H__ */
@@ -0,0 +1,126 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "core/gv-ring-buffer.h"
+
+/*
+ * Lock-free ring buffer of fixed-size frames, for exactly one producer
+ * thread and one consumer thread. Neither side ever waits: the producer
+ * drops the frame if the buffer is full, the consumer returns if it's
+ * empty.
+ *
+ * The read and write counters only ever increase, and wrap around
+ * naturally. Each counter is only written by one side, and the atomic
+ * accesses act as full memory barriers, so that a frame is completely
+ * written before the consumer can see it, and completely read before
+ * the producer can overwrite it.
+ */
+
+struct _GvRingBuffer {
+	guint   n_frames;   /* Power of two */
+	gsize   frame_size;
+	guint8 *frames;
+	/* Written by the producer only */
+	guint   write_count;
+	/* Written by the consumer only */
+	guint   read_count;
+};
+
+/*
+ * Public methods
+ */
+
+/* Write a frame, returns FALSE if the buffer is full */
+gboolean
+gv_ring_buffer_write(GvRingBuffer *self, gconstpointer frame)
+{
+	guint write_count = g_atomic_int_get(&self->write_count);
+	guint read_count = g_atomic_int_get(&self->read_count);
+	guint index;
+
+	if (write_count - read_count >= self->n_frames)
+		return FALSE;
+
+	index = write_count & (self->n_frames - 1);
+	memcpy(self->frames + index * self->frame_size, frame, self->frame_size);
+
+	g_atomic_int_set(&self->write_count, write_count + 1);
+
+	return TRUE;
+}
+
+/* Read a frame, returns FALSE if the buffer is empty */
+gboolean
+gv_ring_buffer_read(GvRingBuffer *self, gpointer frame)
+{
+	guint read_count = g_atomic_int_get(&self->read_count);
+	guint write_count = g_atomic_int_get(&self->write_count);
+	guint index;
+
+	if (write_count == read_count)
+		return FALSE;
+
+	index = read_count & (self->n_frames - 1);
+	memcpy(frame, self->frames + index * self->frame_size, self->frame_size);
+
+	g_atomic_int_set(&self->read_count, read_count + 1);
+
+	return TRUE;
+}
+
+gsize
+gv_ring_buffer_get_frame_size(GvRingBuffer *self)
+{
+	return self->frame_size;
+}
+
+void
+gv_ring_buffer_free(GvRingBuffer *self)
+{
+	if (self == NULL)
+		return;
+
+	g_free(self->frames);
+	g_free(self);
+}
+
+/* Create a ring buffer that holds at least n_frames frames */
+GvRingBuffer *
+gv_ring_buffer_new(guint n_frames, gsize frame_size)
+{
+	GvRingBuffer *self;
+	guint size = 1;
+
+	g_return_val_if_fail(n_frames > 0, NULL);
+	g_return_val_if_fail(frame_size > 0, NULL);
+
+	while (size < n_frames)
+		size <<= 1;
+
+	self = g_new0(GvRingBuffer, 1);
+	self->n_frames = size;
+	self->frame_size = frame_size;
+	self->frames = g_malloc0(size * frame_size);
+
+	return self;
+}
@@ -0,0 +1,40 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GOODVIBES_CORE_GV_RING_BUFFER_H__
+#define __GOODVIBES_CORE_GV_RING_BUFFER_H__
+
+#include <glib.h>
+
+/* Data types */
+
+typedef struct _GvRingBuffer GvRingBuffer;
+
+/* Methods */
+
+GvRingBuffer *gv_ring_buffer_new  (guint n_frames, gsize frame_size);
+void          gv_ring_buffer_free (GvRingBuffer *self);
+gboolean      gv_ring_buffer_write(GvRingBuffer *self, gconstpointer frame);
+gboolean      gv_ring_buffer_read (GvRingBuffer *self, gpointer frame);
+
+/* Accessors */
+
+gsize         gv_ring_buffer_get_frame_size(GvRingBuffer *self);
+
+#endif /* __GOODVIBES_CORE_GV_RING_BUFFER_H__ */
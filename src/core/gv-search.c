@@ -0,0 +1,1003 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <glib-object.h>
+
+#include "additions/glib-object.h"
+#include "framework/gv-framework.h"
+#include "core/gv-history.h"
+#include "core/gv-station.h"
+#include "core/gv-station-list.h"
+
+#include "core/gv-search.h"
+
+/*
+ * The search works with an in-memory inverted index. A document is either a
+ * station (indexed by name and uri), or a track that was played, as recorded
+ * by the history (indexed by title and artist). Documents are split in terms,
+ * and each term keeps the list of documents it appears in.
+ *
+ * Terms are also kept in a sorted array, so that prefix matching is a binary
+ * search. For fuzzy matching, the terms coming from names, titles and artists
+ * are also indexed by their deletions (the term with one character removed):
+ * two terms within an edit distance of one have a deletion in common, or one
+ * is a deletion of the other.
+ *
+ * The index is updated incrementally, according to the signals of the
+ * station list and the history. The number of tracks is capped: the tracks
+ * that were played least recently are dropped, along with their terms.
+ */
+
+#define SCORE_EXACT  3
+#define SCORE_PREFIX 2
+#define SCORE_FUZZY  1
+
+/* Fuzzy matching on short terms gives too much noise */
+#define FUZZY_MIN_LENGTH 4
+
+/* Maximum number of tracks in the index */
+#define MAX_TRACK_DOCS 5000
+
+typedef enum {
+	DOC_STATION,
+	DOC_TRACK
+} DocType;
+
+typedef struct {
+	DocType      type;
+	/* Station documents, the station is owned by the station list */
+	GvStation   *station;
+	/* Track documents, the key is owned by the track table */
+	const gchar *key;
+	GList       *lru_link;
+	gchar       *title;
+	gchar       *artist;
+	gchar       *station_uri;
+	gchar       *station_name;
+	/* Terms that refer to this document */
+	GPtrArray   *terms;
+} Doc;
+
+typedef struct {
+	gchar     *string;
+	GPtrArray *docs;
+	gboolean   fuzzy;
+} Term;
+
+typedef struct {
+	Doc   *doc;
+	guint  score;
+} Match;
+
+/*
+ * Properties
+ */
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Construct properties */
+	PROP_STATION_LIST,
+	PROP_HISTORY,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+/*
+ * GObject definitions
+ */
+
+struct _GvSearchPrivate {
+	/* Construct-only properties */
+	GvStationList *station_list;
+	GvHistory     *history;
+	/* Documents */
+	GHashTable    *station_docs;
+	GHashTable    *track_docs;
+	GQueue        *track_lru;
+	/* Terms */
+	GHashTable    *terms;
+	GPtrArray     *sorted_terms;
+	GHashTable    *deletions;
+	/* While building the index, terms are sorted once at the end */
+	gboolean       building;
+};
+
+typedef struct _GvSearchPrivate GvSearchPrivate;
+
+struct _GvSearch {
+	/* Parent instance structure */
+	GObject          parent_instance;
+	/* Private data */
+	GvSearchPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GvSearch, gv_search, G_TYPE_OBJECT,
+                        G_ADD_PRIVATE(GvSearch))
+
+/*
+ * Documents and terms
+ */
+
+static Doc *
+doc_new(DocType type)
+{
+	Doc *doc;
+
+	doc = g_new0(Doc, 1);
+	doc->type = type;
+	doc->terms = g_ptr_array_new();
+
+	return doc;
+}
+
+static void
+doc_free(Doc *doc)
+{
+	g_ptr_array_free(doc->terms, TRUE);
+	g_free(doc->title);
+	g_free(doc->artist);
+	g_free(doc->station_uri);
+	g_free(doc->station_name);
+	g_free(doc);
+}
+
+static const gchar *
+doc_get_sort_key(Doc *doc)
+{
+	const gchar *key;
+
+	if (doc->type == DOC_STATION)
+		key = gv_station_get_name_or_uri(doc->station);
+	else
+		key = doc->title;
+
+	return key ? key : "";
+}
+
+static void
+term_free(Term *term)
+{
+	g_ptr_array_free(term->docs, TRUE);
+	g_free(term->string);
+	g_free(term);
+}
+
+static gint
+compare_terms(gconstpointer a, gconstpointer b)
+{
+	const Term *term1 = *((Term **) a);
+	const Term *term2 = *((Term **) b);
+
+	return strcmp(term1->string, term2->string);
+}
+
+/* Index of the first term that is greater or equal to the string */
+static guint
+find_sorted_term(GPtrArray *sorted_terms, const gchar *string)
+{
+	guint lo = 0, hi = sorted_terms->len;
+
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		Term *term = g_ptr_array_index(sorted_terms, mid);
+
+		if (strcmp(term->string, string) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static gchar **
+make_deletions(const gchar *string)
+{
+	GPtrArray *deletions;
+	const gchar *p;
+
+	deletions = g_ptr_array_new();
+
+	for (p = string; *p; p = g_utf8_next_char(p)) {
+		const gchar *next = g_utf8_next_char(p);
+		gsize head_len = p - string;
+		gchar *deletion;
+
+		deletion = g_malloc(head_len + strlen(next) + 1);
+		memcpy(deletion, string, head_len);
+		strcpy(deletion + head_len, next);
+		g_ptr_array_add(deletions, deletion);
+	}
+
+	g_ptr_array_add(deletions, NULL);
+
+	return (gchar **) g_ptr_array_free(deletions, FALSE);
+}
+
+static void
+add_term_deletions(GvSearch *self, Term *term)
+{
+	GvSearchPrivate *priv = self->priv;
+	gchar **deletions, **d;
+
+	deletions = make_deletions(term->string);
+
+	for (d = deletions; *d; d++) {
+		GPtrArray *terms;
+
+		terms = g_hash_table_lookup(priv->deletions, *d);
+		if (terms == NULL) {
+			terms = g_ptr_array_new();
+			g_hash_table_insert(priv->deletions, g_strdup(*d), terms);
+		}
+
+		g_ptr_array_add(terms, term);
+	}
+
+	g_strfreev(deletions);
+}
+
+static void
+remove_term_deletions(GvSearch *self, Term *term)
+{
+	GvSearchPrivate *priv = self->priv;
+	gchar **deletions, **d;
+
+	deletions = make_deletions(term->string);
+
+	for (d = deletions; *d; d++) {
+		GPtrArray *terms;
+
+		terms = g_hash_table_lookup(priv->deletions, *d);
+		if (terms == NULL)
+			continue;
+
+		g_ptr_array_remove_fast(terms, term);
+		if (terms->len == 0)
+			g_hash_table_remove(priv->deletions, *d);
+	}
+
+	g_strfreev(deletions);
+}
+
+static Term *
+get_term(GvSearch *self, const gchar *string, gboolean fuzzy)
+{
+	GvSearchPrivate *priv = self->priv;
+	Term *term;
+
+	term = g_hash_table_lookup(priv->terms, string);
+
+	if (term == NULL) {
+		term = g_new0(Term, 1);
+		term->string = g_strdup(string);
+		term->docs = g_ptr_array_new();
+		g_hash_table_insert(priv->terms, term->string, term);
+
+		if (priv->building) {
+			g_ptr_array_add(priv->sorted_terms, term);
+		} else {
+			guint index = find_sorted_term(priv->sorted_terms, string);
+			g_ptr_array_insert(priv->sorted_terms, index, term);
+		}
+	}
+
+	if (fuzzy && term->fuzzy == FALSE &&
+	    g_utf8_strlen(string, -1) >= FUZZY_MIN_LENGTH) {
+		add_term_deletions(self, term);
+		term->fuzzy = TRUE;
+	}
+
+	return term;
+}
+
+static void
+drop_term(GvSearch *self, Term *term)
+{
+	GvSearchPrivate *priv = self->priv;
+	guint index;
+
+	index = find_sorted_term(priv->sorted_terms, term->string);
+	g_assert(g_ptr_array_index(priv->sorted_terms, index) == term);
+	g_ptr_array_remove_index(priv->sorted_terms, index);
+
+	if (term->fuzzy)
+		remove_term_deletions(self, term);
+
+	/* Frees the term */
+	g_hash_table_remove(priv->terms, term->string);
+}
+
+static void
+index_doc_term(GvSearch *self, Doc *doc, const gchar *string, gboolean fuzzy)
+{
+	Term *term;
+	guint i;
+
+	term = get_term(self, string, fuzzy);
+
+	/* A document might contain the same term several times */
+	for (i = 0; i < doc->terms->len; i++)
+		if (g_ptr_array_index(doc->terms, i) == term)
+			return;
+
+	g_ptr_array_add(doc->terms, term);
+	g_ptr_array_add(term->docs, doc);
+}
+
+static void
+index_doc_text(GvSearch *self, Doc *doc, const gchar *text, gboolean fuzzy)
+{
+	gchar **tokens, **alternates, **t;
+
+	if (text == NULL)
+		return;
+
+	/* Tokens are case-folded, ascii alternates allow to match
+	 * accented terms when the query has no accent.
+	 */
+	tokens = g_str_tokenize_and_fold(text, NULL, &alternates);
+
+	for (t = tokens; *t; t++)
+		index_doc_term(self, doc, *t, fuzzy);
+	for (t = alternates; *t; t++)
+		index_doc_term(self, doc, *t, fuzzy);
+
+	g_strfreev(tokens);
+	g_strfreev(alternates);
+}
+
+static void
+unindex_doc(GvSearch *self, Doc *doc)
+{
+	guint i;
+
+	for (i = 0; i < doc->terms->len; i++) {
+		Term *term = g_ptr_array_index(doc->terms, i);
+
+		g_ptr_array_remove_fast(term->docs, doc);
+		if (term->docs->len == 0)
+			drop_term(self, term);
+	}
+
+	g_ptr_array_set_size(doc->terms, 0);
+}
+
+/*
+ * Index updates
+ */
+
+static void
+index_station(GvSearch *self, GvStation *station)
+{
+	GvSearchPrivate *priv = self->priv;
+	const gchar *uri;
+	Doc *doc;
+
+	doc = g_hash_table_lookup(priv->station_docs, station);
+
+	if (doc == NULL) {
+		doc = doc_new(DOC_STATION);
+		doc->station = station;
+		g_hash_table_insert(priv->station_docs, station, doc);
+	} else {
+		unindex_doc(self, doc);
+	}
+
+	index_doc_text(self, doc, gv_station_get_name(station), TRUE);
+
+	/* The uri scheme would match every station */
+	uri = gv_station_get_uri(station);
+	if (uri && strstr(uri, "://"))
+		uri = strstr(uri, "://") + 3;
+	index_doc_text(self, doc, uri, FALSE);
+}
+
+static void
+unindex_station(GvSearch *self, GvStation *station)
+{
+	GvSearchPrivate *priv = self->priv;
+	Doc *doc;
+
+	doc = g_hash_table_lookup(priv->station_docs, station);
+	if (doc == NULL)
+		return;
+
+	unindex_doc(self, doc);
+	g_hash_table_remove(priv->station_docs, station);
+}
+
+static void
+trim_tracks(GvSearch *self)
+{
+	GvSearchPrivate *priv = self->priv;
+
+	/* Drop the tracks that were played least recently */
+	while (g_queue_get_length(priv->track_lru) > MAX_TRACK_DOCS) {
+		Doc *doc = g_queue_pop_head(priv->track_lru);
+
+		unindex_doc(self, doc);
+
+		/* Frees the document */
+		g_hash_table_remove(priv->track_docs, doc->key);
+	}
+}
+
+static void
+index_track(GvSearch *self, GvHistoryEntry *entry)
+{
+	GvSearchPrivate *priv = self->priv;
+	gchar *key;
+	Doc *doc;
+
+	if (entry->title == NULL)
+		return;
+
+	/* A track is identified by its title and artist, and remembers the
+	 * station where it was played last.
+	 */
+	key = g_strdup_printf("%s\n%s", entry->title,
+	                      entry->artist ? entry->artist : "");
+	doc = g_hash_table_lookup(priv->track_docs, key);
+
+	if (doc != NULL) {
+		g_free(doc->station_uri);
+		g_free(doc->station_name);
+		doc->station_uri = g_strdup(entry->station_uri);
+		doc->station_name = g_strdup(entry->station_name);
+		g_free(key);
+
+		/* Played again, it's the most recent track now */
+		g_queue_unlink(priv->track_lru, doc->lru_link);
+		g_queue_push_tail_link(priv->track_lru, doc->lru_link);
+		return;
+	}
+
+	doc = doc_new(DOC_TRACK);
+	doc->key = key;
+	doc->title = g_strdup(entry->title);
+	doc->artist = g_strdup(entry->artist);
+	doc->station_uri = g_strdup(entry->station_uri);
+	doc->station_name = g_strdup(entry->station_name);
+	g_hash_table_insert(priv->track_docs, key, doc);
+	g_queue_push_tail(priv->track_lru, doc);
+	doc->lru_link = g_queue_peek_tail_link(priv->track_lru);
+
+	index_doc_text(self, doc, doc->title, TRUE);
+	index_doc_text(self, doc, doc->artist, TRUE);
+
+	/* Terms can't be dropped while the index is built, as they're
+	 * not sorted yet. The tracks are trimmed at the end.
+	 */
+	if (priv->building == FALSE)
+		trim_tracks(self);
+}
+
+static void
+build_index(GvSearch *self)
+{
+	GvSearchPrivate *priv = self->priv;
+	GvStationListIter *iter;
+	GvStation *station;
+
+	priv->building = TRUE;
+
+	iter = gv_station_list_iter_new(priv->station_list);
+	while (gv_station_list_iter_loop(iter, &station))
+		index_station(self, station);
+	gv_station_list_iter_free(iter);
+
+	if (priv->history) {
+		GPtrArray *entries;
+		GError *err = NULL;
+		guint i;
+
+		entries = gv_history_query(priv->history, NULL, 0, 0, 0, &err);
+		if (entries == NULL) {
+			WARNING("Failed to query history: %s", err->message);
+			g_clear_error(&err);
+		} else {
+			for (i = 0; i < entries->len; i++)
+				index_track(self, g_ptr_array_index(entries, i));
+			g_ptr_array_unref(entries);
+		}
+	}
+
+	g_ptr_array_sort(priv->sorted_terms, compare_terms);
+
+	priv->building = FALSE;
+
+	trim_tracks(self);
+
+	DEBUG("Search index built: %u stations, %u tracks, %u terms",
+	      g_hash_table_size(priv->station_docs),
+	      g_hash_table_size(priv->track_docs),
+	      g_hash_table_size(priv->terms));
+}
+
+/*
+ * Query helpers
+ */
+
+static void
+add_matches(GHashTable *matches, GPtrArray *docs, guint score)
+{
+	guint i;
+
+	for (i = 0; i < docs->len; i++) {
+		Doc *doc = g_ptr_array_index(docs, i);
+		guint prev_score = GPOINTER_TO_UINT(g_hash_table_lookup(matches, doc));
+
+		if (score > prev_score)
+			g_hash_table_insert(matches, doc, GUINT_TO_POINTER(score));
+	}
+}
+
+static void
+add_fuzzy_term_matches(GHashTable *matches, GPtrArray *terms)
+{
+	guint i;
+
+	if (terms == NULL)
+		return;
+
+	for (i = 0; i < terms->len; i++) {
+		Term *term = g_ptr_array_index(terms, i);
+
+		add_matches(matches, term->docs, SCORE_FUZZY);
+	}
+}
+
+static void
+add_fuzzy_matches(GvSearch *self, GHashTable *matches, const gchar *token)
+{
+	GvSearchPrivate *priv = self->priv;
+	gchar **deletions, **d;
+
+	/* Terms with one more character */
+	add_fuzzy_term_matches(matches, g_hash_table_lookup(priv->deletions, token));
+
+	deletions = make_deletions(token);
+
+	for (d = deletions; *d; d++) {
+		Term *term;
+
+		/* Terms with one less character */
+		term = g_hash_table_lookup(priv->terms, *d);
+		if (term && term->fuzzy)
+			add_matches(matches, term->docs, SCORE_FUZZY);
+
+		/* Terms with one different character */
+		add_fuzzy_term_matches(matches, g_hash_table_lookup(priv->deletions, *d));
+	}
+
+	g_strfreev(deletions);
+}
+
+static GHashTable *
+match_token(GvSearch *self, const gchar *token)
+{
+	GvSearchPrivate *priv = self->priv;
+	GPtrArray *sorted_terms = priv->sorted_terms;
+	GHashTable *matches;
+	guint i;
+
+	matches = g_hash_table_new(NULL, NULL);
+
+	/* Exact and prefix matches are contiguous in the sorted terms */
+	for (i = find_sorted_term(sorted_terms, token); i < sorted_terms->len; i++) {
+		Term *term = g_ptr_array_index(sorted_terms, i);
+
+		if (!g_str_has_prefix(term->string, token))
+			break;
+
+		add_matches(matches, term->docs, strcmp(term->string, token) == 0 ?
+		            SCORE_EXACT : SCORE_PREFIX);
+	}
+
+	if (g_utf8_strlen(token, -1) >= FUZZY_MIN_LENGTH)
+		add_fuzzy_matches(self, matches, token);
+
+	return matches;
+}
+
+static gint
+compare_matches(gconstpointer a, gconstpointer b)
+{
+	const Match *match1 = a;
+	const Match *match2 = b;
+
+	if (match1->score != match2->score)
+		return match1->score > match2->score ? -1 : 1;
+
+	if (match1->doc->type != match2->doc->type)
+		return match1->doc->type == DOC_STATION ? -1 : 1;
+
+	return g_ascii_strcasecmp(doc_get_sort_key(match1->doc),
+	                          doc_get_sort_key(match2->doc));
+}
+
+static GvSearchResult *
+make_result(Match *match)
+{
+	GvSearchResult *result;
+	Doc *doc = match->doc;
+
+	result = g_new0(GvSearchResult, 1);
+	result->score = match->score;
+
+	if (doc->type == DOC_STATION) {
+		result->type = GV_SEARCH_RESULT_STATION;
+		result->station = g_object_ref(doc->station);
+	} else {
+		result->type = GV_SEARCH_RESULT_TRACK;
+		result->title = g_strdup(doc->title);
+		result->artist = g_strdup(doc->artist);
+		result->station_uri = g_strdup(doc->station_uri);
+		result->station_name = g_strdup(doc->station_name);
+	}
+
+	return result;
+}
+
+/*
+ * Signal handlers
+ */
+
+static void
+on_station_list_station_added(GvStationList *station_list G_GNUC_UNUSED,
+                              GvStation     *station,
+                              GvSearch      *self)
+{
+	index_station(self, station);
+}
+
+static void
+on_station_list_stations_added(GvStationList *station_list G_GNUC_UNUSED,
+                               GList         *stations,
+                               GvSearch      *self)
+{
+	GList *item;
+
+	for (item = stations; item; item = item->next)
+		index_station(self, item->data);
+}
+
+static void
+on_station_list_station_removed(GvStationList *station_list G_GNUC_UNUSED,
+                                GvStation     *station,
+                                GvSearch      *self)
+{
+	unindex_station(self, station);
+}
+
+static void
+on_station_list_station_modified(GvStationList *station_list G_GNUC_UNUSED,
+                                 GvStation     *station,
+                                 GvSearch      *self)
+{
+	index_station(self, station);
+}
+
+static void
+on_history_entry_added(GvHistory      *history G_GNUC_UNUSED,
+                       GvHistoryEntry *entry,
+                       GvSearch       *self)
+{
+	index_track(self, entry);
+}
+
+/*
+ * Property accessors
+ */
+
+static void
+gv_search_set_station_list(GvSearch *self, GvStationList *station_list)
+{
+	GvSearchPrivate *priv = self->priv;
+
+	/* This is a construct-only property */
+	g_assert_null(priv->station_list);
+	g_assert_nonnull(station_list);
+	priv->station_list = g_object_ref(station_list);
+	g_signal_connect(station_list, "station-added",
+	                 G_CALLBACK(on_station_list_station_added), self);
+	g_signal_connect(station_list, "stations-added",
+	                 G_CALLBACK(on_station_list_stations_added), self);
+	g_signal_connect(station_list, "station-removed",
+	                 G_CALLBACK(on_station_list_station_removed), self);
+	g_signal_connect(station_list, "station-modified",
+	                 G_CALLBACK(on_station_list_station_modified), self);
+}
+
+static void
+gv_search_set_history(GvSearch *self, GvHistory *history)
+{
+	GvSearchPrivate *priv = self->priv;
+
+	/* This is a construct-only property, and it's optional */
+	g_assert_null(priv->history);
+	if (history == NULL)
+		return;
+
+	priv->history = g_object_ref(history);
+	g_signal_connect(history, "entry-added",
+	                 G_CALLBACK(on_history_entry_added), self);
+}
+
+static void
+gv_search_get_property(GObject    *object,
+                       guint       property_id,
+                       GValue     *value G_GNUC_UNUSED,
+                       GParamSpec *pspec)
+{
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	/* Handle properties */
+	switch (property_id) {
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_search_set_property(GObject      *object,
+                       guint         property_id,
+                       const GValue *value,
+                       GParamSpec   *pspec)
+{
+	GvSearch *self = GV_SEARCH(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	/* Handle properties */
+	switch (property_id) {
+	case PROP_STATION_LIST:
+		gv_search_set_station_list(self, g_value_get_object(value));
+		break;
+	case PROP_HISTORY:
+		gv_search_set_history(self, g_value_get_object(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Public methods
+ */
+
+void
+gv_search_result_free(GvSearchResult *result)
+{
+	if (result == NULL)
+		return;
+
+	if (result->station)
+		g_object_unref(result->station);
+	g_free(result->title);
+	g_free(result->artist);
+	g_free(result->station_uri);
+	g_free(result->station_name);
+	g_free(result);
+}
+
+/* Search for stations and tracks matching every word of the query.
+ * Results are sorted by relevance, and paged with offset and limit,
+ * a limit of 0 meaning no limit. The total number of matches is returned
+ * in n_matches.
+ */
+GPtrArray *
+gv_search_query(GvSearch *self, const gchar *query, guint offset, guint limit,
+                guint *n_matches)
+{
+	GPtrArray *results;
+	GHashTable *matches = NULL;
+	GHashTableIter iter;
+	gpointer key, value;
+	gchar **tokens, **t;
+	GArray *sorted;
+	guint i, end;
+
+	g_return_val_if_fail(query != NULL, NULL);
+
+	results = g_ptr_array_new_with_free_func((GDestroyNotify) gv_search_result_free);
+
+	/* Every token must match */
+	tokens = g_str_tokenize_and_fold(query, NULL, NULL);
+
+	for (t = tokens; *t; t++) {
+		GHashTable *token_matches;
+
+		token_matches = match_token(self, *t);
+
+		if (matches == NULL) {
+			matches = token_matches;
+			continue;
+		}
+
+		g_hash_table_iter_init(&iter, matches);
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			guint score;
+
+			score = GPOINTER_TO_UINT(g_hash_table_lookup(token_matches, key));
+			if (score == 0) {
+				g_hash_table_iter_remove(&iter);
+				continue;
+			}
+
+			score += GPOINTER_TO_UINT(value);
+			g_hash_table_iter_replace(&iter, GUINT_TO_POINTER(score));
+		}
+
+		g_hash_table_unref(token_matches);
+	}
+
+	g_strfreev(tokens);
+
+	if (n_matches)
+		*n_matches = matches ? g_hash_table_size(matches) : 0;
+
+	if (matches == NULL)
+		return results;
+
+	/* Rank matches */
+	sorted = g_array_sized_new(FALSE, FALSE, sizeof(Match),
+	                           g_hash_table_size(matches));
+
+	g_hash_table_iter_init(&iter, matches);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		Match match = { key, GPOINTER_TO_UINT(value) };
+		g_array_append_val(sorted, match);
+	}
+
+	g_array_sort(sorted, compare_matches);
+
+	/* Page results */
+	end = sorted->len;
+	if (offset > end)
+		offset = end;
+	if (limit > 0 && limit < end - offset)
+		end = offset + limit;
+
+	for (i = offset; i < end; i++)
+		g_ptr_array_add(results, make_result(&g_array_index(sorted, Match, i)));
+
+	g_array_free(sorted, TRUE);
+	g_hash_table_unref(matches);
+
+	return results;
+}
+
+GvSearch *
+gv_search_new(GvStationList *station_list, GvHistory *history)
+{
+	return g_object_new(GV_TYPE_SEARCH,
+	                    "station-list", station_list,
+	                    "history", history,
+	                    NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_search_finalize(GObject *object)
+{
+	GvSearch *self = GV_SEARCH(object);
+	GvSearchPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Disconnect */
+	g_signal_handlers_disconnect_by_data(priv->station_list, self);
+	if (priv->history)
+		g_signal_handlers_disconnect_by_data(priv->history, self);
+
+	/* Free the index, documents and terms only refer to each other */
+	g_hash_table_unref(priv->station_docs);
+	g_queue_free(priv->track_lru);
+	g_hash_table_unref(priv->track_docs);
+	g_hash_table_unref(priv->deletions);
+	g_hash_table_unref(priv->terms);
+	g_ptr_array_free(priv->sorted_terms, TRUE);
+
+	/* Unref */
+	if (priv->history)
+		g_object_unref(priv->history);
+	g_object_unref(priv->station_list);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_search, object);
+}
+
+static void
+gv_search_constructed(GObject *object)
+{
+	GvSearch *self = GV_SEARCH(object);
+
+	TRACE("%p", object);
+
+	/* Build the index */
+	build_index(self);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_search, object);
+}
+
+static void
+gv_search_init(GvSearch *self)
+{
+	GvSearchPrivate *priv;
+
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = priv = gv_search_get_instance_private(self);
+
+	/* Initialize the index */
+	priv->station_docs = g_hash_table_new_full(NULL, NULL, NULL,
+	                                           (GDestroyNotify) doc_free);
+	priv->track_docs = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+	                                         (GDestroyNotify) doc_free);
+	priv->track_lru = g_queue_new();
+	priv->terms = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+	                                    (GDestroyNotify) term_free);
+	priv->sorted_terms = g_ptr_array_new();
+	priv->deletions = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+	                                        (GDestroyNotify) g_ptr_array_unref);
+}
+
+static void
+gv_search_class_init(GvSearchClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_search_finalize;
+	object_class->constructed = gv_search_constructed;
+
+	/* Properties */
+	object_class->get_property = gv_search_get_property;
+	object_class->set_property = gv_search_set_property;
+
+	properties[PROP_STATION_LIST] =
+	        g_param_spec_object("station-list", "Station list", NULL,
+	                            GV_TYPE_STATION_LIST,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_WRITABLE |
+	                            G_PARAM_CONSTRUCT_ONLY);
+
+	properties[PROP_HISTORY] =
+	        g_param_spec_object("history", "History", NULL,
+	                            GV_TYPE_HISTORY,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_WRITABLE |
+	                            G_PARAM_CONSTRUCT_ONLY);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+}
@@ -0,0 +1,62 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GOODVIBES_CORE_GV_SEARCH_H__
+#define __GOODVIBES_CORE_GV_SEARCH_H__
+
+#include <glib-object.h>
+
+#include "core/gv-history.h"
+#include "core/gv-station.h"
+#include "core/gv-station-list.h"
+
+/* GObject declarations */
+
+#define GV_TYPE_SEARCH gv_search_get_type()
+
+G_DECLARE_FINAL_TYPE(GvSearch, gv_search, GV, SEARCH, GObject)
+
+/* Data types */
+
+typedef enum {
+	GV_SEARCH_RESULT_STATION,
+	GV_SEARCH_RESULT_TRACK
+} GvSearchResultType;
+
+typedef struct {
+	GvSearchResultType  type;
+	guint               score;
+	/* Station results */
+	GvStation          *station;
+	/* Track results */
+	gchar              *title;
+	gchar              *artist;
+	gchar              *station_uri;
+	gchar              *station_name;
+} GvSearchResult;
+
+void gv_search_result_free(GvSearchResult *result);
+
+/* Methods */
+
+GvSearch  *gv_search_new  (GvStationList *station_list, GvHistory *history);
+GPtrArray *gv_search_query(GvSearch *self, const gchar *query,
+                           guint offset, guint limit, guint *n_matches);
+
+#endif /* __GOODVIBES_CORE_GV_SEARCH_H__ */
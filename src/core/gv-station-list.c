@@ -17,6 +17,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
 #include <string.h>
 #include <glib.h>
 #include <glib-object.h>
@@ -153,6 +154,21 @@
 
 #define SAVE_DELAY 1
 
+/*
+ * Change log - how many changes we remember
+ */
+
+#define CHANGE_LOG_SIZE 256
+
+/*
+ * Revision - the upper bits are an epoch, picked at random for each process,
+ * and the lower bits are a counter, incremented on every change. Revisions
+ * from another epoch can't be compared, and clients must resync.
+ */
+
+#define REVISION_EPOCH_SHIFT 32
+#define REVISION_EPOCH(rev)  ((rev) >> REVISION_EPOCH_SHIFT)
+
 /*
  * Signals
  */
@@ -162,6 +178,7 @@ enum {
 	SIGNAL_STATION_REMOVED,
 	SIGNAL_STATION_MODIFIED,
 	SIGNAL_STATION_MOVED,
+	SIGNAL_STATIONS_ADDED,
 	/* Number of signals */
 	SIGNAL_N
 };
@@ -177,6 +194,7 @@ enum {
 	PROP_0,
 	/* Properties */
 	PROP_LENGTH,
+	PROP_REVISION,
 	/* Number of properties */
 	PROP_N
 };
@@ -199,6 +217,18 @@ struct _GvStationListPrivate {
 	 * and destroyed when needed.
 	 */
 	GList  *shuffled;
+	/* Whether the shuffled list favors healthy stations */
+	gboolean smart;
+	/* Stations sorted alphabetically, kept up to date incrementally,
+	 * a map to find a station in there, and a map to find a station
+	 * by uid.
+	 */
+	GSequence  *sorted;
+	GHashTable *sorted_iters;
+	GHashTable *uids;
+	/* Revision, incremented on every change, and log of the latest changes */
+	guint64     revision;
+	GQueue     *changes;
 };
 
 typedef struct _GvStationListPrivate GvStationListPrivate;
@@ -225,7 +255,8 @@ struct _GvMarkupParsing {
 	gchar **cur;
 	gchar  *name;
 	gchar  *uri;
-
+	GvStationStats stats;
+	gboolean       has_stats;
 };
 
 typedef struct _GvMarkupParsing GvMarkupParsing;
@@ -274,6 +305,8 @@ markup_on_end_element(GMarkupParseContext  *context G_GNUC_UNUSED,
 
 	/* Create a new station */
 	station = gv_station_new(parsing->name, parsing->uri);
+	if (parsing->has_stats)
+		gv_station_set_stats(station, &parsing->stats);
 
 	/* Add to list, use prepend for efficiency */
 	parsing->list = g_list_prepend(parsing->list, station);
@@ -282,15 +315,63 @@ cleanup:
 	/* Cleanup */
 	g_free(parsing->name);
 	g_free(parsing->uri);
+	g_free(parsing->stats.last_error);
 	parsing->name = NULL;
 	parsing->uri = NULL;
+	memset(&parsing->stats, 0, sizeof(GvStationStats));
+	parsing->has_stats = FALSE;
+}
+
+static void
+markup_parse_stats(GvMarkupParsing  *parsing,
+                   const gchar     **attribute_names,
+                   const gchar     **attribute_values)
+{
+	GvStationStats *stats = &parsing->stats;
+	guint i;
+
+	for (i = 0; attribute_names[i]; i++) {
+		const gchar *name = attribute_names[i];
+		const gchar *value = attribute_values[i];
+
+		if (!g_strcmp0(name, "successes"))
+			stats->successes = g_ascii_strtoull(value, NULL, 10);
+		else if (!g_strcmp0(name, "failures"))
+			stats->failures = g_ascii_strtoull(value, NULL, 10);
+		else if (!g_strcmp0(name, "failures-in-row"))
+			stats->failures_in_row = g_ascii_strtoull(value, NULL, 10);
+		else if (!g_strcmp0(name, "rebuffers"))
+			stats->rebuffers = g_ascii_strtoull(value, NULL, 10);
+		else if (!g_strcmp0(name, "last-error-time"))
+			stats->last_error_time = g_ascii_strtoll(value, NULL, 10);
+		else if (!g_strcmp0(name, "last-error")) {
+			g_free(stats->last_error);
+			stats->last_error = g_strdup(value);
+		} else if (!g_strcmp0(name, "connect-times")) {
+			const gchar *ptr = value;
+			gchar *end;
+
+			stats->n_connect_times = 0;
+			while (stats->n_connect_times < GV_STATION_STATS_N_CONNECT_TIMES) {
+				guint64 connect_time = g_ascii_strtoull(ptr, &end, 10);
+
+				if (end == ptr)
+					break;
+
+				stats->connect_times[stats->n_connect_times++] = connect_time;
+				ptr = end;
+			}
+		}
+	}
+
+	parsing->has_stats = TRUE;
 }
 
 static void
 markup_on_start_element(GMarkupParseContext  *context G_GNUC_UNUSED,
                         const gchar          *element_name,
-                        const gchar         **attribute_names G_GNUC_UNUSED,
-                        const gchar         **attribute_values G_GNUC_UNUSED,
+                        const gchar         **attribute_names,
+                        const gchar         **attribute_values,
                         gpointer              user_data,
                         GError              **error G_GNUC_UNUSED)
 {
@@ -321,6 +402,12 @@ markup_on_start_element(GMarkupParseContext  *context G_GNUC_UNUSED,
 		return;
 	}
 
+	/* Connection quality statistics */
+	if (!g_strcmp0(element_name, "stats")) {
+		markup_parse_stats(parsing, attribute_names, attribute_values);
+		return;
+	}
+
 	WARNING("Unexpected element: '%s'", element_name);
 }
 
@@ -336,6 +423,8 @@ markup_on_error(GMarkupParseContext *context G_GNUC_UNUSED,
 	parsing->name = NULL;
 	g_free(parsing->uri);
 	parsing->uri = NULL;
+	g_free(parsing->stats.last_error);
+	parsing->stats.last_error = NULL;
 }
 
 static GList *
@@ -349,12 +438,9 @@ parse_markup(const gchar *text, GError **err)
 		NULL,
 		markup_on_error,
 	};
-	GvMarkupParsing parsing = {
-		NULL,
-		NULL,
-		NULL,
-		NULL
-	};
+	GvMarkupParsing parsing;
+
+	memset(&parsing, 0, sizeof(GvMarkupParsing));
 
 	context = g_markup_parse_context_new(&parser, 0, &parsing, NULL);
 	g_markup_parse_context_parse(context, text, -1, err);
@@ -363,6 +449,41 @@ parse_markup(const gchar *text, GError **err)
 	return g_list_reverse(parsing.list);
 }
 
+static void
+print_markup_stats(GString *string, GvStation *station)
+{
+	const GvStationStats *stats = gv_station_get_stats(station);
+	guint i;
+
+	if (stats->successes == 0 && stats->failures == 0)
+		return;
+
+	g_string_append_printf(string,
+	                       "    <stats successes=\"%u\" failures=\"%u\""
+	                       " failures-in-row=\"%u\" rebuffers=\"%u\"",
+	                       stats->successes, stats->failures,
+	                       stats->failures_in_row, stats->rebuffers);
+
+	if (stats->n_connect_times > 0) {
+		g_string_append(string, " connect-times=\"");
+		for (i = 0; i < stats->n_connect_times; i++)
+			g_string_append_printf(string, i ? " %u" : "%u",
+			                       stats->connect_times[i]);
+		g_string_append(string, "\"");
+	}
+
+	if (stats->last_error) {
+		gchar *error_escaped = g_markup_escape_text(stats->last_error, -1);
+
+		g_string_append_printf(string,
+		                       " last-error=\"%s\" last-error-time=\"%" G_GINT64_FORMAT "\"",
+		                       error_escaped, stats->last_error_time);
+		g_free(error_escaped);
+	}
+
+	g_string_append(string, "/>\n");
+}
+
 static gchar *
 print_markup(GList *list, GError **err G_GNUC_UNUSED)
 {
@@ -388,17 +509,17 @@ print_markup(GList *list, GError **err G_GNUC_UNUSED)
 		if (name_escaped)
 			text = g_strdup_printf("  <Station>\n"
 			                       "    <name>%s</name>\n"
-			                       "    <uri>%s</uri>\n"
-			                       "  </Station>\n",
+			                       "    <uri>%s</uri>\n",
 			                       name_escaped, uri_escaped);
 		else
 			text = g_strdup_printf("  <Station>\n"
-			                       "    <uri>%s</uri>\n"
-			                       "  </Station>\n",
+			                       "    <uri>%s</uri>\n",
 			                       uri_escaped);
 
 		/* Append */
 		g_string_append(string, text);
+		print_markup_stats(string, station);
+		g_string_append(string, "  </Station>\n");
 		g_free(text);
 		g_free(uri_escaped);
 		g_free(name_escaped);
@@ -481,11 +602,53 @@ g_list_shuffle(GList *list)
 	return list;
 }
 
+typedef struct {
+	GvStation *station;
+	gdouble    key;
+} WeightedStation;
+
+static gint
+compare_weighted_stations(gconstpointer a, gconstpointer b)
+{
+	const WeightedStation *ws1 = a;
+	const WeightedStation *ws2 = b;
+
+	if (ws1->key == ws2->key)
+		return 0;
+
+	return ws1->key > ws2->key ? -1 : 1;
+}
+
+/* Weighted shuffle, where the weight is the health of the station. Each
+ * station gets a random key u^(1/w), and stations are sorted by decreasing
+ * key (Efraimidis & Spirakis). Healthy stations tend to come first, but
+ * no station is left out.
+ */
 static GList *
-g_list_copy_deep_shuffle(GList *list, GCopyFunc func, gpointer user_data)
+g_list_shuffle_weighted(GList *list)
 {
-	list = g_list_copy_deep(list, func, user_data);
-	list = g_list_shuffle(list);
+	GArray *array;
+	GList *item;
+	guint i;
+
+	array = g_array_sized_new(FALSE, FALSE, sizeof(WeightedStation),
+	                          g_list_length(list));
+
+	for (item = list; item; item = item->next) {
+		WeightedStation ws;
+
+		ws.station = item->data;
+		ws.key = pow(g_random_double(), 1.0 / gv_station_get_health(ws.station));
+		g_array_append_val(array, ws);
+	}
+
+	g_array_sort(array, compare_weighted_stations);
+
+	for (item = list, i = 0; item; item = item->next, i++)
+		item->data = g_array_index(array, WeightedStation, i).station;
+
+	g_array_free(array, TRUE);
+
 	return list;
 }
 
@@ -493,6 +656,28 @@ g_list_copy_deep_shuffle(GList *list, GCopyFunc func, gpointer user_data)
  * Helpers
  */
 
+static GList *
+shuffle_stations(GvStationList *self, GList *list)
+{
+	GvStationListPrivate *priv = self->priv;
+
+	if (priv->smart)
+		return g_list_shuffle_weighted(list);
+	else
+		return g_list_shuffle(list);
+}
+
+static GList *
+copy_shuffled_stations(GvStationList *self)
+{
+	GvStationListPrivate *priv = self->priv;
+	GList *list;
+
+	list = g_list_copy_deep(priv->stations, (GCopyFunc) g_object_ref, NULL);
+
+	return shuffle_stations(self, list);
+}
+
 static gint
 are_stations_similar(GvStation *s1, GvStation *s2)
 {
@@ -542,6 +727,154 @@ are_stations_similar(GvStation *s1, GvStation *s2)
 	return -1;
 }
 
+/*
+ * Alphabetical order
+ */
+
+typedef struct {
+	GvStation *station;
+	gchar     *key;
+} GvSortedStation;
+
+static void
+gv_sorted_station_free(GvSortedStation *sorted)
+{
+	g_free(sorted->key);
+	g_free(sorted);
+}
+
+static gint
+compare_sorted_stations(gconstpointer a, gconstpointer b, gpointer user_data G_GNUC_UNUSED)
+{
+	const GvSortedStation *sorted1 = a;
+	const GvSortedStation *sorted2 = b;
+	gint ret;
+
+	ret = strcmp(sorted1->key, sorted2->key);
+	if (ret != 0)
+		return ret;
+
+	/* Keep a stable order for stations with the same name */
+	return g_strcmp0(gv_station_get_uid(sorted1->station),
+	                 gv_station_get_uid(sorted2->station));
+}
+
+static gchar *
+make_sort_key(GvStation *station)
+{
+	const gchar *name = gv_station_get_name_or_uri(station);
+
+	return g_utf8_collate_key(name ? name : "", -1);
+}
+
+static void
+sorted_add(GvStationList *self, GvStation *station)
+{
+	GvStationListPrivate *priv = self->priv;
+	GvSortedStation *sorted;
+	GSequenceIter *iter;
+
+	sorted = g_new0(GvSortedStation, 1);
+	sorted->station = station;
+	sorted->key = make_sort_key(station);
+
+	iter = g_sequence_insert_sorted(priv->sorted, sorted, compare_sorted_stations, NULL);
+	g_hash_table_insert(priv->sorted_iters, station, iter);
+	g_hash_table_insert(priv->uids, (gpointer) gv_station_get_uid(station), station);
+}
+
+static void
+sorted_remove(GvStationList *self, GvStation *station)
+{
+	GvStationListPrivate *priv = self->priv;
+	GSequenceIter *iter;
+
+	iter = g_hash_table_lookup(priv->sorted_iters, station);
+	g_return_if_fail(iter != NULL);
+
+	g_hash_table_remove(priv->uids, gv_station_get_uid(station));
+	g_hash_table_remove(priv->sorted_iters, station);
+	g_sequence_remove(iter);
+}
+
+static void
+sorted_update(GvStationList *self, GvStation *station)
+{
+	GvStationListPrivate *priv = self->priv;
+	GvSortedStation *sorted;
+	GSequenceIter *iter;
+	gchar *key;
+
+	iter = g_hash_table_lookup(priv->sorted_iters, station);
+	g_return_if_fail(iter != NULL);
+
+	sorted = g_sequence_get(iter);
+	key = make_sort_key(station);
+
+	if (!g_strcmp0(sorted->key, key)) {
+		g_free(key);
+		return;
+	}
+
+	g_free(sorted->key);
+	sorted->key = key;
+	g_sequence_sort_changed(iter, compare_sorted_stations, NULL);
+}
+
+/*
+ * Change log
+ */
+
+GvStationChange *
+gv_station_change_copy(const GvStationChange *change)
+{
+	GvStationChange *copy;
+
+	copy = g_new0(GvStationChange, 1);
+	copy->revision = change->revision;
+	copy->type = change->type;
+	copy->uid = g_strdup(change->uid);
+	copy->name = g_strdup(change->name);
+	copy->uri = g_strdup(change->uri);
+	copy->position = change->position;
+
+	return copy;
+}
+
+void
+gv_station_change_free(GvStationChange *change)
+{
+	g_free(change->uid);
+	g_free(change->name);
+	g_free(change->uri);
+	g_free(change);
+}
+
+static void
+log_change(GvStationList *self, GvStationChangeType type, GvStation *station,
+           gint position)
+{
+	GvStationListPrivate *priv = self->priv;
+	GvStationChange *change;
+
+	change = g_new0(GvStationChange, 1);
+	change->revision = ++priv->revision;
+	change->type = type;
+	change->uid = g_strdup(gv_station_get_uid(station));
+	change->position = position;
+
+	if (type != GV_STATION_CHANGE_REMOVED) {
+		change->name = g_strdup(gv_station_get_name(station));
+		change->uri = g_strdup(gv_station_get_uri(station));
+	}
+
+	g_queue_push_tail(priv->changes, change);
+	if (g_queue_get_length(priv->changes) > CHANGE_LOG_SIZE)
+		gv_station_change_free(g_queue_pop_head(priv->changes));
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_REVISION]);
+}
+
 /*
  * Signal handlers
  */
@@ -580,6 +913,28 @@ on_station_notify(GvStation     *station,
 
 	TRACE("%s, %s, %p", gv_station_get_uid(station), property_name, self);
 
+	/* The check time changes at every health check, whatever the result,
+	 * it's not worth telling the whole world. A change of the check error
+	 * goes through.
+	 */
+	if (!g_strcmp0(property_name, "check-time"))
+		return;
+
+	/* Stats change each time the station is played. They must be saved,
+	 * but they're only read on demand, there's no need to tell anyone.
+	 */
+	if (!g_strcmp0(property_name, "stats")) {
+		gv_station_list_schedule_save(self);
+		return;
+	}
+
+	/* The alphabetical order might have changed */
+	if (!g_strcmp0(property_name, "uri") ||
+	    !g_strcmp0(property_name, "name")) {
+		sorted_update(self, station);
+		log_change(self, GV_STATION_CHANGE_MODIFIED, station, -1);
+	}
+
 	/* We might want to save changes */
 	if (!g_strcmp0(property_name, "uri") ||
 	    !g_strcmp0(property_name, "name")) {
@@ -625,15 +980,16 @@ gv_station_list_remove(GvStationList *self, GvStation *station)
 	/* Remove from list */
 	priv->stations = g_list_remove_link(priv->stations, item);
 	g_list_free(item);
+	sorted_remove(self, station);
+	log_change(self, GV_STATION_CHANGE_REMOVED, station, -1);
 
 	/* Unown the station */
 	g_object_unref(station);
 
-	/* Rebuild the shuffled station list */
+	/* Drop the shuffled station list, it's rebuilt when needed */
 	if (priv->shuffled) {
 		g_list_free_full(priv->shuffled, g_object_unref);
-		priv->shuffled = g_list_copy_deep_shuffle(priv->stations,
-		                 (GCopyFunc) g_object_ref, NULL);
+		priv->shuffled = NULL;
 	}
 
 	/* Emit a signal */
@@ -674,15 +1030,17 @@ gv_station_list_insert(GvStationList *self, GvStation *station, gint pos)
 
 	/* Add to the list at the right position */
 	priv->stations = g_list_insert(priv->stations, station, pos);
+	sorted_add(self, station);
+	log_change(self, GV_STATION_CHANGE_ADDED, station,
+	           g_list_index(priv->stations, station));
 
 	/* Connect to notify signal */
 	g_signal_connect(station, "notify", G_CALLBACK(on_station_notify), self);
 
-	/* Rebuild the shuffled station list */
+	/* Drop the shuffled station list, it's rebuilt when needed */
 	if (priv->shuffled) {
 		g_list_free_full(priv->shuffled, g_object_unref);
-		priv->shuffled = g_list_copy_deep_shuffle(priv->stations,
-		                 (GCopyFunc) g_object_ref, NULL);
+		priv->shuffled = NULL;
 	}
 
 	/* Emit a signal */
@@ -731,6 +1089,120 @@ gv_station_list_append(GvStationList *self, GvStation *station)
 	gv_station_list_insert_before(self, station, NULL);
 }
 
+/* Insert several stations at once, in the given order, starting at 'pos'.
+ * If 'pos' is negative or larger than the list, stations are appended.
+ * Stations similar to one already in the list are skipped. A single
+ * 'stations-added' signal is emitted, 'station-added' is not emitted.
+ */
+void
+gv_station_list_insert_many(GvStationList *self, GList *stations, gint pos)
+{
+	GvStationListPrivate *priv = self->priv;
+	GHashTable *names;
+	GHashTable *uris;
+	GList *added = NULL;
+	GList *sibling;
+	GList *item;
+	guint length;
+	gint position;
+
+	/* Lookup tables to find similar stations, see are_stations_similar() */
+	names = g_hash_table_new(g_str_hash, g_str_equal);
+	uris = g_hash_table_new(g_str_hash, g_str_equal);
+	length = 0;
+
+	for (item = priv->stations; item; item = item->next) {
+		GvStation *station = item->data;
+		const gchar *name = gv_station_get_name(station);
+		const gchar *uri = gv_station_get_uri(station);
+
+		if (name)
+			g_hash_table_add(names, (gpointer) name);
+		if (uri)
+			g_hash_table_add(uris, (gpointer) uri);
+		length++;
+	}
+
+	/* Keep new stations, in order, and own them */
+	for (item = stations; item; item = item->next) {
+		GvStation *station = item->data;
+		const gchar *name = gv_station_get_name(station);
+		const gchar *uri = gv_station_get_uri(station);
+
+		if ((name && g_hash_table_contains(names, name)) ||
+		    (uri && g_hash_table_contains(uris, uri))) {
+			DEBUG("Station '%s' is already part of the list",
+			      gv_station_get_name_or_uri(station));
+			continue;
+		}
+
+		if (name)
+			g_hash_table_add(names, (gpointer) name);
+		if (uri)
+			g_hash_table_add(uris, (gpointer) uri);
+
+		added = g_list_prepend(added, g_object_ref(station));
+	}
+
+	g_hash_table_destroy(uris);
+	g_hash_table_destroy(names);
+
+	if (added == NULL)
+		return;
+
+	added = g_list_reverse(added);
+
+	INFO("Inserting %u stations", g_list_length(added));
+
+	/* Link the new stations in the list, in one go */
+	if (pos < 0 || (guint) pos > length)
+		pos = length;
+
+	sibling = g_list_nth(priv->stations, pos);
+	if (sibling == NULL) {
+		priv->stations = g_list_concat(priv->stations, g_list_copy(added));
+	} else {
+		GList *first = g_list_copy(added);
+		GList *last = g_list_last(first);
+
+		first->prev = sibling->prev;
+		if (sibling->prev)
+			sibling->prev->next = first;
+		else
+			priv->stations = first;
+		last->next = sibling;
+		sibling->prev = last;
+	}
+
+	/* Bookkeeping, there's a single notify for the revision */
+	g_object_freeze_notify(G_OBJECT(self));
+
+	for (item = added, position = pos; item; item = item->next, position++) {
+		GvStation *station = item->data;
+
+		sorted_add(self, station);
+		log_change(self, GV_STATION_CHANGE_ADDED, station, position);
+		g_signal_connect(station, "notify", G_CALLBACK(on_station_notify), self);
+	}
+
+	g_object_thaw_notify(G_OBJECT(self));
+
+	/* Drop the shuffled station list, it's rebuilt when needed */
+	if (priv->shuffled) {
+		g_list_free_full(priv->shuffled, g_object_unref);
+		priv->shuffled = NULL;
+	}
+
+	/* Emit a signal */
+	g_signal_emit(self, signals[SIGNAL_STATIONS_ADDED], 0, added);
+
+	/* The list owns the stations now */
+	g_list_free(added);
+
+	/* Save */
+	gv_station_list_schedule_save(self);
+}
+
 void
 gv_station_list_move(GvStationList *self, GvStation *station, gint pos)
 {
@@ -749,6 +1221,8 @@ gv_station_list_move(GvStationList *self, GvStation *station, gint pos)
 	priv->stations = g_list_remove_link(priv->stations, item);
 	g_list_free(item);
 	priv->stations = g_list_insert(priv->stations, station, pos);
+	log_change(self, GV_STATION_CHANGE_MOVED, station,
+	           g_list_index(priv->stations, station));
 
 	/* Emit a signal */
 	g_signal_emit(self, signals[SIGNAL_STATION_MOVED], 0, station);
@@ -757,6 +1231,63 @@ gv_station_list_move(GvStationList *self, GvStation *station, gint pos)
 	gv_station_list_schedule_save(self);
 }
 
+/* Move the given stations at the beginning of the list, in the given order.
+ * Other stations keep their relative order, and come after. Stations that
+ * are not part of the list are ignored.
+ */
+void
+gv_station_list_reorder(GvStationList *self, GList *stations)
+{
+	GvStationListPrivate *priv = self->priv;
+	GHashTable *moved;
+	GList *ordered = NULL;
+	GList *others = NULL;
+	GList *item;
+	gint position;
+
+	moved = g_hash_table_new(NULL, NULL);
+
+	for (item = stations; item; item = item->next) {
+		GvStation *station = item->data;
+
+		if (!g_hash_table_contains(priv->sorted_iters, station))
+			continue;
+
+		if (!g_hash_table_add(moved, station))
+			continue;
+
+		ordered = g_list_prepend(ordered, station);
+	}
+
+	for (item = priv->stations; item; item = item->next) {
+		if (!g_hash_table_contains(moved, item->data))
+			others = g_list_prepend(others, item->data);
+	}
+
+	/* Replace the list, stations are still owned */
+	g_list_free(priv->stations);
+	ordered = g_list_reverse(ordered);
+	priv->stations = g_list_concat(ordered, g_list_reverse(others));
+
+	/* Log changes and emit signals */
+	for (item = priv->stations, position = 0;
+	     item && g_hash_table_size(moved) > 0;
+	     item = item->next, position++) {
+		GvStation *station = item->data;
+
+		if (!g_hash_table_remove(moved, station))
+			continue;
+
+		log_change(self, GV_STATION_CHANGE_MOVED, station, position);
+		g_signal_emit(self, signals[SIGNAL_STATION_MOVED], 0, station);
+	}
+
+	g_hash_table_destroy(moved);
+
+	/* Save */
+	gv_station_list_schedule_save(self);
+}
+
 /* Move a station before another.
  * If 'before' is NULL or not found, the station is inserted at the end of the list.
  */
@@ -793,19 +1324,22 @@ gv_station_list_move_last(GvStationList *self, GvStation *station)
 	gv_station_list_move_before(self, station, NULL);
 }
 
-GvStation *
-gv_station_list_prev(GvStationList *self, GvStation *station,
-                     gboolean repeat, gboolean shuffle)
+static GvStation *
+station_list_prev(GvStationList *self, GvStation *station,
+                  gboolean repeat, gboolean shuffle, gboolean smart)
 {
 	GvStationListPrivate *priv = self->priv;
 	GList *stations, *item;
 
 	/* Pickup the right station list, create shuffle list if needed */
 	if (shuffle) {
-		if (priv->shuffled == NULL) {
-			priv->shuffled = g_list_copy_deep_shuffle(priv->stations,
-			                 (GCopyFunc) g_object_ref, NULL);
+		if (priv->shuffled && priv->smart != smart) {
+			g_list_free_full(priv->shuffled, g_object_unref);
+			priv->shuffled = NULL;
 		}
+		priv->smart = smart;
+		if (priv->shuffled == NULL)
+			priv->shuffled = copy_shuffled_stations(self);
 		stations = priv->shuffled;
 	} else {
 		if (priv->shuffled) {
@@ -837,7 +1371,7 @@ gv_station_list_prev(GvStationList *self, GvStation *station,
 	if (shuffle) {
 		GList *last_item;
 
-		stations = g_list_shuffle(priv->shuffled);
+		stations = shuffle_stations(self, priv->shuffled);
 
 		/* In case the last station (that we're about to return) happens to be
 		 * the same as the current station, we do a little a magic trick.
@@ -855,19 +1389,22 @@ gv_station_list_prev(GvStationList *self, GvStation *station,
 	return g_list_last(stations)->data;
 }
 
-GvStation *
-gv_station_list_next(GvStationList *self, GvStation *station,
-                     gboolean repeat, gboolean shuffle)
+static GvStation *
+station_list_next(GvStationList *self, GvStation *station,
+                  gboolean repeat, gboolean shuffle, gboolean smart)
 {
 	GvStationListPrivate *priv = self->priv;
 	GList *stations, *item;
 
 	/* Pickup the right station list, create shuffle list if needed */
 	if (shuffle) {
-		if (priv->shuffled == NULL) {
-			priv->shuffled = g_list_copy_deep_shuffle(priv->stations,
-			                 (GCopyFunc) g_object_ref, NULL);
+		if (priv->shuffled && priv->smart != smart) {
+			g_list_free_full(priv->shuffled, g_object_unref);
+			priv->shuffled = NULL;
 		}
+		priv->smart = smart;
+		if (priv->shuffled == NULL)
+			priv->shuffled = copy_shuffled_stations(self);
 		stations = priv->shuffled;
 	} else {
 		if (priv->shuffled) {
@@ -899,7 +1436,7 @@ gv_station_list_next(GvStationList *self, GvStation *station,
 	if (shuffle) {
 		GList *first_item;
 
-		stations = g_list_shuffle(priv->shuffled);
+		stations = shuffle_stations(self, priv->shuffled);
 
 		/* In case the first station (that we're about to return) happens to be
 		 * the same as the current station, we do a little a magic trick.
@@ -917,6 +1454,58 @@ gv_station_list_next(GvStationList *self, GvStation *station,
 	return stations->data;
 }
 
+/* Skip the stations that are known to be dead, unless they're all dead */
+static GvStation *
+skip_dead_stations(GvStationList *self, GvStation *station,
+                   gboolean repeat, gboolean shuffle, gboolean forward)
+{
+	GvStationListPrivate *priv = self->priv;
+	GvStation *candidate = station;
+	guint n_tries = g_list_length(priv->stations);
+
+	while (candidate && gv_station_is_dead(candidate) && n_tries-- > 0) {
+		if (forward)
+			candidate = station_list_next(self, candidate, repeat, shuffle, TRUE);
+		else
+			candidate = station_list_prev(self, candidate, repeat, shuffle, TRUE);
+	}
+
+	if (candidate == NULL || gv_station_is_dead(candidate))
+		return station;
+
+	return candidate;
+}
+
+/* Get the previous station. In smart mode, stations known to be dead are
+ * skipped, and the shuffled list favors healthy stations.
+ */
+GvStation *
+gv_station_list_prev(GvStationList *self, GvStation *station,
+                     gboolean repeat, gboolean shuffle, gboolean smart)
+{
+	GvStation *prev;
+
+	prev = station_list_prev(self, station, repeat, shuffle, smart);
+	if (smart)
+		prev = skip_dead_stations(self, prev, repeat, shuffle, FALSE);
+
+	return prev;
+}
+
+/* Get the next station. See gv_station_list_prev() for the smart mode. */
+GvStation *
+gv_station_list_next(GvStationList *self, GvStation *station,
+                     gboolean repeat, gboolean shuffle, gboolean smart)
+{
+	GvStation *next;
+
+	next = station_list_next(self, station, repeat, shuffle, smart);
+	if (smart)
+		next = skip_dead_stations(self, next, repeat, shuffle, TRUE);
+
+	return next;
+}
+
 GvStation *
 gv_station_list_first(GvStationList *self)
 {
@@ -999,22 +1588,13 @@ gv_station_list_find_by_uri(GvStationList *self, const gchar *uri)
 GvStation *
 gv_station_list_find_by_uid(GvStationList *self, const gchar *uid)
 {
-	GList *item;
-
 	/* Ensure station name is valid */
 	if (uid == NULL) {
 		WARNING("Attempting to find a station with NULL uid");
 		return NULL;
 	}
 
-	/* Iterate on station list */
-	for (item = self->priv->stations; item; item = item->next) {
-		GvStation *station = item->data;
-		if (!g_strcmp0(uid, gv_station_get_uid(station)))
-			return station;
-	}
-
-	return NULL;
+	return g_hash_table_lookup(self->priv->uids, uid);
 }
 
 GvStation  *
@@ -1120,6 +1700,7 @@ gv_station_list_load(GvStationList *self)
 		GvStation *station = sta_item->data;
 
 		g_signal_connect(station, "notify", G_CALLBACK(on_station_notify), self);
+		sorted_add(self, station);
 	}
 }
 
@@ -1129,16 +1710,122 @@ gv_station_list_new(void)
 	return g_object_new(GV_TYPE_STATION_LIST, NULL);
 }
 
+/* Get a range of stations, in alphabetical order. The stations
+ * are not referenced, the list must be freed with g_list_free().
+ */
+GList *
+gv_station_list_get_sorted_range(GvStationList *self, guint start, guint count,
+                                 gboolean reverse)
+{
+	GvStationListPrivate *priv = self->priv;
+	GSequenceIter *iter;
+	GList *list = NULL;
+	guint length;
+
+	length = g_sequence_get_length(priv->sorted);
+	if (start >= length)
+		return NULL;
+
+	if (count > length - start)
+		count = length - start;
+
+	if (reverse)
+		iter = g_sequence_get_iter_at_pos(priv->sorted, length - 1 - start);
+	else
+		iter = g_sequence_get_iter_at_pos(priv->sorted, start);
+
+	for (; count > 0; count--) {
+		GvSortedStation *sorted = g_sequence_get(iter);
+
+		list = g_list_prepend(list, sorted->station);
+		iter = reverse ? g_sequence_iter_prev(iter) : g_sequence_iter_next(iter);
+	}
+
+	return g_list_reverse(list);
+}
+
+/* Get the station that comes after a given one in alphabetical order,
+ * or the first one if the given station is NULL.
+ */
+GvStation *
+gv_station_list_get_sorted_next(GvStationList *self, GvStation *station)
+{
+	GvStationListPrivate *priv = self->priv;
+	GSequenceIter *iter;
+	GvSortedStation *sorted;
+
+	if (station == NULL) {
+		iter = g_sequence_get_begin_iter(priv->sorted);
+	} else {
+		iter = g_hash_table_lookup(priv->sorted_iters, station);
+		g_return_val_if_fail(iter != NULL, NULL);
+		iter = g_sequence_iter_next(iter);
+	}
+
+	if (g_sequence_iter_is_end(iter))
+		return NULL;
+
+	sorted = g_sequence_get(iter);
+
+	return sorted->station;
+}
+
+/* Get the changes that happened after a given revision, oldest first.
+ * Returns FALSE if the changes are not known anymore, or if the revision
+ * comes from another epoch (ie. another run of the program), in which case
+ * the whole list must be fetched again. The changes must be freed with
+ * gv_station_change_free().
+ */
+gboolean
+gv_station_list_get_changes(GvStationList *self, guint64 since, GList **changes)
+{
+	GvStationListPrivate *priv = self->priv;
+	GvStationChange *oldest;
+	GList *item;
+
+	*changes = NULL;
+
+	if (REVISION_EPOCH(since) != REVISION_EPOCH(priv->revision))
+		return FALSE;
+
+	if (since > priv->revision)
+		return FALSE;
+
+	if (since == priv->revision)
+		return TRUE;
+
+	oldest = g_queue_peek_head(priv->changes);
+	if (oldest == NULL || oldest->revision > since + 1)
+		return FALSE;
+
+	for (item = g_queue_peek_tail_link(priv->changes); item; item = item->prev) {
+		GvStationChange *change = item->data;
+
+		if (change->revision <= since)
+			break;
+
+		*changes = g_list_prepend(*changes, gv_station_change_copy(change));
+	}
+
+	return TRUE;
+}
+
 /*
  * Property accessors
  */
 
+guint64
+gv_station_list_get_revision(GvStationList *self)
+{
+	return self->priv->revision;
+}
+
 guint
 gv_station_list_get_length(GvStationList *self)
 {
 	GvStationListPrivate *priv = self->priv;
 
-	return g_list_length(priv->stations);
+	return g_sequence_get_length(priv->sorted);
 }
 
 static void
@@ -1155,6 +1842,9 @@ gv_station_list_get_property(GObject    *object,
 	case PROP_LENGTH:
 		g_value_set_uint(value, gv_station_list_get_length(self));
 		break;
+	case PROP_REVISION:
+		g_value_set_uint64(value, gv_station_list_get_revision(self));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
 		break;
@@ -1199,7 +1889,13 @@ gv_station_list_finalize(GObject *object)
 		g_signal_handlers_disconnect_by_data(station, self);
 	}
 
+	/* Free change log */
+	g_queue_free_full(priv->changes, (GDestroyNotify) gv_station_change_free);
+
 	/* Free station lists */
+	g_hash_table_destroy(priv->uids);
+	g_hash_table_destroy(priv->sorted_iters);
+	g_sequence_free(priv->sorted);
 	g_list_free_full(priv->stations, g_object_unref);
 	g_list_free_full(priv->shuffled, g_object_unref);
 
@@ -1233,6 +1929,18 @@ gv_station_list_init(GvStationList *self)
 
 	/* Initialize private pointer */
 	self->priv = gv_station_list_get_instance_private(self);
+
+	/* Initialize alphabetical order */
+	self->priv->sorted = g_sequence_new((GDestroyNotify) gv_sorted_station_free);
+	self->priv->sorted_iters = g_hash_table_new(NULL, NULL);
+	self->priv->uids = g_hash_table_new(g_str_hash, g_str_equal);
+
+	/* Initialize change log. The epoch is never zero, so that a client
+	 * that never synced can't be mistaken for an up-to-date one.
+	 */
+	self->priv->changes = g_queue_new();
+	self->priv->revision = (guint64) g_random_int_range(1, G_MAXINT32)
+	                       << REVISION_EPOCH_SHIFT;
 }
 
 static void
@@ -1255,6 +1963,11 @@ gv_station_list_class_init(GvStationListClass *class)
 	                          0, G_MAXUINT, 0,
 	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
 
+	properties[PROP_REVISION] =
+	        g_param_spec_uint64("revision", "Revision", NULL,
+	                            0, G_MAXUINT64, 0,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
+
 	g_object_class_install_properties(object_class, PROP_N, properties);
 
 	/* Signals */
@@ -1281,4 +1994,11 @@ gv_station_list_class_init(GvStationListClass *class)
 	                     G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
 	                     0, NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE,
 	                     1, G_TYPE_OBJECT);
+
+	/* Several stations added at once, as a GList of GvStation, in order */
+	signals[SIGNAL_STATIONS_ADDED] =
+	        g_signal_new("stations-added", G_TYPE_FROM_CLASS(class),
+	                     G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+	                     0, NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE,
+	                     1, G_TYPE_POINTER);
 }
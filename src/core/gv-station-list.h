@@ -34,6 +34,27 @@ G_DECLARE_FINAL_TYPE(GvStationList, gv_station_list, GV, STATION_LIST, GObject)
 
 typedef struct _GvStationListIter GvStationListIter;
 
+typedef enum {
+	GV_STATION_CHANGE_ADDED,
+	GV_STATION_CHANGE_REMOVED,
+	GV_STATION_CHANGE_MOVED,
+	GV_STATION_CHANGE_MODIFIED
+} GvStationChangeType;
+
+typedef struct {
+	guint64              revision;
+	GvStationChangeType type;
+	gchar               *uid;
+	/* Station fields at the time of the change, unset for removals */
+	gchar               *name;
+	gchar               *uri;
+	/* New position, for additions and moves, -1 otherwise */
+	gint                 position;
+} GvStationChange;
+
+GvStationChange *gv_station_change_copy(const GvStationChange *change);
+void             gv_station_change_free(GvStationChange *change);
+
 /* Methods */
 
 GvStationList *gv_station_list_new (void);
@@ -45,6 +66,7 @@ void gv_station_list_append       (GvStationList *self, GvStation *station);
 void gv_station_list_insert       (GvStationList *self, GvStation *station, gint position);
 void gv_station_list_insert_before(GvStationList *self, GvStation *station, GvStation *before);
 void gv_station_list_insert_after (GvStationList *self, GvStation *station, GvStation *after);
+void gv_station_list_insert_many  (GvStationList *self, GList *stations, gint position);
 void gv_station_list_remove       (GvStationList *self, GvStation *station);
 
 void gv_station_list_move       (GvStationList *self, GvStation *station, gint position);
@@ -52,13 +74,14 @@ void gv_station_list_move_before(GvStationList *self, GvStation *station, GvStat
 void gv_station_list_move_after (GvStationList *self, GvStation *station, GvStation *after);
 void gv_station_list_move_first (GvStationList *self, GvStation *station);
 void gv_station_list_move_last  (GvStationList *self, GvStation *station);
+void gv_station_list_reorder    (GvStationList *self, GList *stations);
 
 GvStation *gv_station_list_first(GvStationList *self);
 GvStation *gv_station_list_last (GvStationList *self);
 GvStation *gv_station_list_prev (GvStationList *self, GvStation *station, gboolean repeat,
-                                 gboolean shuffle);
+                                 gboolean shuffle, gboolean smart);
 GvStation *gv_station_list_next (GvStationList *self, GvStation *station, gboolean repeat,
-                                 gboolean shuffle);
+                                 gboolean shuffle, gboolean smart);
 
 GvStation *gv_station_list_find            (GvStationList *self, GvStation *station);
 GvStation *gv_station_list_find_by_name    (GvStationList *self, const gchar *name);
@@ -66,9 +89,15 @@ GvStation *gv_station_list_find_by_uri     (GvStationList *self, const gchar *ur
 GvStation *gv_station_list_find_by_uid     (GvStationList *self, const gchar *uid);
 GvStation *gv_station_list_find_by_guessing(GvStationList *self, const gchar *string);
 
+GList *gv_station_list_get_sorted_range(GvStationList *self, guint start, guint count,
+                                        gboolean reverse);
+GvStation *gv_station_list_get_sorted_next(GvStationList *self, GvStation *station);
+gboolean gv_station_list_get_changes(GvStationList *self, guint64 since, GList **changes);
+
 /* Properties */
 
-guint gv_station_list_get_length(GvStationList *self);
+guint   gv_station_list_get_length  (GvStationList *self);
+guint64 gv_station_list_get_revision(GvStationList *self);
 
 /* Iterator methods */
 
@@ -17,8 +17,10 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include <glib.h>
 #include <glib-object.h>
+#include <gio/gio.h>
 
 #include "additions/glib-object.h"
 #include "framework/gv-framework.h"
@@ -38,12 +40,28 @@ enum {
 	PROP_NAME,
 	PROP_URI,
 	PROP_STREAM_URIS,
+	PROP_STATS,
+	PROP_CHECK_TIME,
+	PROP_CHECK_ERROR,
 	/* Number of properties */
 	PROP_N
 };
 
 static GParamSpec *properties[PROP_N];
 
+/*
+ * Connection quality
+ */
+
+/* A station is considered dead after a few failures in a row, but it
+ * gets a new chance after a while.
+ */
+#define DEAD_FAILURES_IN_ROW 3
+#define DEAD_RETRY_DELAY     (24 * 60 * 60) /* seconds */
+
+/* Minimum health, so that no station is ever left out for good */
+#define MIN_HEALTH 0.05
+
 /*
  * Signals
  */
@@ -66,6 +84,17 @@ struct _GvStationPrivate {
 	gchar  *name;
 	gchar  *uri;
 	GSList *stream_uris;
+	GvStationStats stats;
+	/* Result of the last health check */
+	gint64  check_time;
+	gchar  *check_error;
+	/* Playlist download in progress. It goes on as long as someone
+	 * wants it: a caller that can't cancel, or a cancellable that is
+	 * not cancelled yet.
+	 */
+	GvPlaylist *playlist;
+	gboolean    playlist_wanted;
+	GPtrArray  *playlist_cancellables;
 };
 
 typedef struct _GvStationPrivate GvStationPrivate;
@@ -105,6 +134,70 @@ gv_station_set_stream_uri(GvStation *self, const gchar *uri)
 	g_slist_free_full(list, g_free);
 }
 
+static void on_playlist_downloaded(GvPlaylist *playlist, GvStation *self);
+
+static gboolean
+start_playlist_download(GvStation *self)
+{
+	GvStationPrivate *priv = self->priv;
+
+	if (priv->playlist)
+		return TRUE;
+
+	if (priv->uri == NULL) {
+		WARNING("No uri to download");
+		return FALSE;
+	}
+
+	if (gv_playlist_get_format(priv->uri) == GV_PLAYLIST_FORMAT_UNKNOWN) {
+		WARNING("Uri doesn't seem to be a playlist");
+		return FALSE;
+	}
+
+	priv->playlist = gv_playlist_new(priv->uri);
+	g_signal_connect(priv->playlist, "downloaded",
+	                 G_CALLBACK(on_playlist_downloaded), self);
+	gv_playlist_download(priv->playlist);
+
+	return TRUE;
+}
+
+static void
+clear_playlist_cancellables(GvStation *self)
+{
+	GvStationPrivate *priv = self->priv;
+	guint i;
+
+	priv->playlist_wanted = FALSE;
+
+	if (priv->playlist_cancellables == NULL)
+		return;
+
+	for (i = 0; i < priv->playlist_cancellables->len; i++) {
+		GCancellable *cancellable = g_ptr_array_index(priv->playlist_cancellables, i);
+
+		g_signal_handlers_disconnect_by_data(cancellable, self);
+	}
+
+	g_ptr_array_unref(priv->playlist_cancellables);
+	priv->playlist_cancellables = NULL;
+}
+
+static void
+stop_playlist_download(GvStation *self)
+{
+	GvStationPrivate *priv = self->priv;
+
+	if (priv->playlist == NULL)
+		return;
+
+	clear_playlist_cancellables(self);
+
+	g_signal_handlers_disconnect_by_data(priv->playlist, self);
+	gv_playlist_cancel(priv->playlist);
+	g_clear_object(&priv->playlist);
+}
+
 /*
  * Signal handlers
  */
@@ -113,16 +206,43 @@ static void
 on_playlist_downloaded(GvPlaylist *playlist,
                        GvStation  *self)
 {
+	GvStationPrivate *priv = self->priv;
 	GSList *streams;
 
 	DEBUG("Playlist downloaded");
 
+	/* Take ownership of the playlist, the download is over */
+	g_signal_handlers_disconnect_by_data(playlist, self);
+	priv->playlist = NULL;
+	clear_playlist_cancellables(self);
+
 	streams = gv_playlist_get_stream_list(playlist);
 	gv_station_set_stream_uris(self, streams);
 
 	g_object_unref(playlist);
 }
 
+static void
+on_playlist_cancellable_cancelled(GCancellable *cancellable G_GNUC_UNUSED,
+                                  GvStation    *self)
+{
+	GvStationPrivate *priv = self->priv;
+	guint i;
+
+	if (priv->playlist_wanted)
+		return;
+
+	for (i = 0; i < priv->playlist_cancellables->len; i++) {
+		GCancellable *other = g_ptr_array_index(priv->playlist_cancellables, i);
+
+		if (!g_cancellable_is_cancelled(other))
+			return;
+	}
+
+	DEBUG("Playlist download not wanted anymore");
+	stop_playlist_download(self);
+}
+
 /*
  * Property accessors
  */
@@ -193,9 +313,16 @@ gv_station_set_uri(GvStation *self, const gchar *uri)
 	g_free(priv->uri);
 	priv->uri = g_strdup(uri);
 
-	/* If this is not a playlist uri, then it's a stream uri */
+	/* A download of the previous playlist is useless now */
+	stop_playlist_download(self);
+
+	/* If this is not a playlist uri, then it's a stream uri.
+	 * Otherwise, the streams are unknown until the playlist is downloaded.
+	 */
 	if (gv_playlist_get_format(uri) == GV_PLAYLIST_FORMAT_UNKNOWN)
 		gv_station_set_stream_uri(self, uri);
+	else if (priv->stream_uris)
+		gv_station_set_stream_uris(self, NULL);
 
 	/* Notify */
 	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_URI]);
@@ -215,6 +342,59 @@ gv_station_get_stream_uris(GvStation *self)
 	return self->priv->stream_uris;
 }
 
+const GvStationStats *
+gv_station_get_stats(GvStation *self)
+{
+	return &self->priv->stats;
+}
+
+void
+gv_station_set_stats(GvStation *self, const GvStationStats *stats)
+{
+	GvStationPrivate *priv = self->priv;
+
+	g_free(priv->stats.last_error);
+	priv->stats = *stats;
+	priv->stats.last_error = g_strdup(stats->last_error);
+	priv->stats.n_connect_times = MIN(stats->n_connect_times,
+	                                  GV_STATION_STATS_N_CONNECT_TIMES);
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STATS]);
+}
+
+/* Time of the last health check, in seconds since the epoch, 0 if never */
+gint64
+gv_station_get_check_time(GvStation *self)
+{
+	return self->priv->check_time;
+}
+
+/* Error met during the last health check, NULL if the station was fine */
+const gchar *
+gv_station_get_check_error(GvStation *self)
+{
+	return self->priv->check_error;
+}
+
+void
+gv_station_set_check_result(GvStation *self, const gchar *error)
+{
+	GvStationPrivate *priv = self->priv;
+
+	g_object_freeze_notify(G_OBJECT(self));
+
+	priv->check_time = g_get_real_time() / G_USEC_PER_SEC;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_CHECK_TIME]);
+
+	if (g_strcmp0(priv->check_error, error)) {
+		g_free(priv->check_error);
+		priv->check_error = g_strdup(error);
+		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_CHECK_ERROR]);
+	}
+
+	g_object_thaw_notify(G_OBJECT(self));
+}
+
 static void
 gv_station_get_property(GObject    *object,
                         guint       property_id,
@@ -238,6 +418,15 @@ gv_station_get_property(GObject    *object,
 	case PROP_STREAM_URIS:
 		g_value_set_pointer(value, gv_station_get_stream_uris(self));
 		break;
+	case PROP_STATS:
+		g_value_set_pointer(value, (gpointer) gv_station_get_stats(self));
+		break;
+	case PROP_CHECK_TIME:
+		g_value_set_int64(value, gv_station_get_check_time(self));
+		break;
+	case PROP_CHECK_ERROR:
+		g_value_set_string(value, gv_station_get_check_error(self));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
 		break;
@@ -271,30 +460,181 @@ gv_station_set_property(GObject      *object,
  * Public methods
  */
 
+/* Download the playlist, in order to get the stream uris. The download is
+ * shared by all the callers, and it's cancelled once all of them cancelled
+ * it. A caller without cancellable can't cancel it.
+ */
 gboolean
-gv_station_download_playlist(GvStation *self)
+gv_station_download_playlist(GvStation *self, GCancellable *cancellable)
 {
 	GvStationPrivate *priv = self->priv;
-	GvPlaylist *playlist;
+	guint i;
 
-	if (priv->uri == NULL) {
-		WARNING("No uri to download");
+	if (cancellable && g_cancellable_is_cancelled(cancellable))
 		return FALSE;
-	}
 
-	if (gv_playlist_get_format(priv->uri) == GV_PLAYLIST_FORMAT_UNKNOWN) {
-		WARNING("Uri doesn't seem to be a playlist");
+	/* A download might be in progress already */
+	if (!start_playlist_download(self))
 		return FALSE;
+
+	if (cancellable == NULL) {
+		priv->playlist_wanted = TRUE;
+		return TRUE;
 	}
 
-	/* No need to keep track of that, it's unreferenced in the callback */
-	playlist = gv_playlist_new(priv->uri);
-	g_signal_connect(playlist, "downloaded", G_CALLBACK(on_playlist_downloaded), self);
-	gv_playlist_download(playlist);
+	if (priv->playlist_cancellables == NULL)
+		priv->playlist_cancellables = g_ptr_array_new_with_free_func(g_object_unref);
+
+	for (i = 0; i < priv->playlist_cancellables->len; i++)
+		if (g_ptr_array_index(priv->playlist_cancellables, i) == cancellable)
+			return TRUE;
+
+	g_ptr_array_add(priv->playlist_cancellables, g_object_ref(cancellable));
+	g_signal_connect(cancellable, "cancelled",
+	                 G_CALLBACK(on_playlist_cancellable_cancelled), self);
 
 	return TRUE;
 }
 
+void
+gv_station_report_success(GvStation *self, guint connect_time)
+{
+	GvStationStats *stats = &self->priv->stats;
+
+	stats->successes++;
+	stats->failures_in_row = 0;
+
+	/* Keep the most recent times only */
+	if (stats->n_connect_times == GV_STATION_STATS_N_CONNECT_TIMES) {
+		memmove(stats->connect_times, stats->connect_times + 1,
+		        (GV_STATION_STATS_N_CONNECT_TIMES - 1) * sizeof(guint));
+		stats->n_connect_times--;
+	}
+	stats->connect_times[stats->n_connect_times++] = connect_time;
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STATS]);
+}
+
+void
+gv_station_report_failure(GvStation *self, const gchar *error)
+{
+	GvStationStats *stats = &self->priv->stats;
+
+	stats->failures++;
+	stats->failures_in_row++;
+
+	g_free(stats->last_error);
+	stats->last_error = g_strdup(error);
+	stats->last_error_time = g_get_real_time() / G_USEC_PER_SEC;
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STATS]);
+}
+
+void
+gv_station_report_rebuffer(GvStation *self)
+{
+	GvStationStats *stats = &self->priv->stats;
+
+	stats->rebuffers++;
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STATS]);
+}
+
+/* Ratio of connections that succeeded, 1 if unknown */
+gdouble
+gv_station_get_success_rate(GvStation *self)
+{
+	GvStationStats *stats = &self->priv->stats;
+	guint total = stats->successes + stats->failures;
+
+	if (total == 0)
+		return 1.0;
+
+	return (gdouble) stats->successes / total;
+}
+
+/* Median time to get to the playing state, in ms, 0 if unknown */
+guint
+gv_station_get_median_connect_time(GvStation *self)
+{
+	GvStationStats *stats = &self->priv->stats;
+	guint times[GV_STATION_STATS_N_CONNECT_TIMES];
+	guint n = stats->n_connect_times;
+	guint i, j;
+
+	if (n == 0)
+		return 0;
+
+	/* Insertion sort, there's only a handful of values */
+	for (i = 0; i < n; i++) {
+		guint t = stats->connect_times[i];
+
+		for (j = i; j > 0 && times[j - 1] > t; j--)
+			times[j] = times[j - 1];
+		times[j] = t;
+	}
+
+	return times[n / 2];
+}
+
+/* Average number of rebufferings per successful connection */
+gdouble
+gv_station_get_rebuffer_rate(GvStation *self)
+{
+	GvStationStats *stats = &self->priv->stats;
+
+	if (stats->successes == 0)
+		return 0.0;
+
+	return (gdouble) stats->rebuffers / stats->successes;
+}
+
+/* Overall health of the station, between 0 and 1. Stations with no history
+ * are given the benefit of the doubt.
+ */
+gdouble
+gv_station_get_health(GvStation *self)
+{
+	GvStationStats *stats = &self->priv->stats;
+	gdouble success_rate;
+	gdouble health;
+
+	/* Laplace smoothing, so that a single failure is not a verdict */
+	success_rate = (stats->successes + 1.0) /
+	               (stats->successes + stats->failures + 2.0);
+
+	health = success_rate / (1.0 + gv_station_get_rebuffer_rate(self));
+
+	return MAX(health, MIN_HEALTH);
+}
+
+/* A station is dead if the most recent news about it are bad, be it from
+ * the health checker, or from playback. Either way, it's given another
+ * chance after a while.
+ */
+gboolean
+gv_station_is_dead(GvStation *self)
+{
+	GvStationPrivate *priv = self->priv;
+	GvStationStats *stats = &priv->stats;
+	gint64 now;
+
+	now = g_get_real_time() / G_USEC_PER_SEC;
+
+	/* The health check came after the last playback failure */
+	if (priv->check_time > 0 && priv->check_time >= stats->last_error_time) {
+		if (priv->check_error == NULL)
+			return FALSE;
+
+		return now - priv->check_time < DEAD_RETRY_DELAY;
+	}
+
+	if (stats->failures_in_row < DEAD_FAILURES_IN_ROW)
+		return FALSE;
+
+	return now - stats->last_error_time < DEAD_RETRY_DELAY;
+}
+
 gchar *
 gv_station_make_name(GvStation *self, gboolean escape)
 {
@@ -332,9 +672,13 @@ gv_station_finalize(GObject *object)
 	TRACE("%p", object);
 
 	/* Free any allocated resources */
+	stop_playlist_download(GV_STATION(object));
+
 	if (priv->stream_uris)
 		g_slist_free_full(priv->stream_uris, g_free);
 
+	g_free(priv->stats.last_error);
+	g_free(priv->check_error);
 	g_free(priv->uid);
 	g_free(priv->name);
 	g_free(priv->uri);
@@ -387,6 +731,19 @@ gv_station_class_init(GvStationClass *class)
 	        g_param_spec_pointer("stream-uris", "Stream uris", NULL,
 	                             GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
 
+	properties[PROP_STATS] =
+	        g_param_spec_pointer("stats", "Connection quality statistics", NULL,
+	                             GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
+
+	properties[PROP_CHECK_TIME] =
+	        g_param_spec_int64("check-time", "Last health check time", NULL,
+	                           0, G_MAXINT64, 0,
+	                           GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
+
+	properties[PROP_CHECK_ERROR] =
+	        g_param_spec_string("check-error", "Last health check error", NULL, NULL,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READABLE);
+
 	g_object_class_install_properties(object_class, PROP_N, properties);
 
 	/* Signals */
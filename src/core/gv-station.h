@@ -21,6 +21,7 @@
 #define __GOODVIBES_CORE_GV_STATION_H__
 
 #include <glib-object.h>
+#include <gio/gio.h>
 
 // WISHED Stations should be initially unowned, since they're meant to be added
 //        to the station list. But it's a bit slippery to change that now.
@@ -31,11 +32,27 @@
 
 G_DECLARE_FINAL_TYPE(GvStation, gv_station, GV, STATION, GObject)
 
+/* Data types */
+
+#define GV_STATION_STATS_N_CONNECT_TIMES 15
+
+typedef struct {
+	guint   successes;
+	guint   failures;
+	guint   failures_in_row;
+	guint   rebuffers;
+	/* Most recent times to get to the playing state, in ms */
+	guint   connect_times[GV_STATION_STATS_N_CONNECT_TIMES];
+	guint   n_connect_times;
+	gchar  *last_error;
+	gint64  last_error_time;
+} GvStationStats;
+
 /* Methods */
 
 GvStation  *gv_station_new              (const gchar *name, const gchar *uri);
 gchar       *gv_station_make_name        (GvStation *self, gboolean escape);
-gboolean     gv_station_download_playlist(GvStation *self);
+gboolean     gv_station_download_playlist(GvStation *self, GCancellable *cancellable);
 
 const gchar *gv_station_get_uid        (GvStation *self);
 const gchar *gv_station_get_name       (GvStation *self);
@@ -45,4 +62,25 @@ void         gv_station_set_uri        (GvStation *self, const gchar *uri);
 const gchar *gv_station_get_name_or_uri(GvStation *self);
 GSList      *gv_station_get_stream_uris(GvStation *self);
 
+/* Connection quality */
+
+const GvStationStats *gv_station_get_stats(GvStation *self);
+void                  gv_station_set_stats(GvStation *self, const GvStationStats *stats);
+
+void     gv_station_report_success (GvStation *self, guint connect_time);
+void     gv_station_report_failure (GvStation *self, const gchar *error);
+void     gv_station_report_rebuffer(GvStation *self);
+
+gdouble  gv_station_get_success_rate       (GvStation *self);
+guint    gv_station_get_median_connect_time(GvStation *self);
+gdouble  gv_station_get_rebuffer_rate      (GvStation *self);
+gdouble  gv_station_get_health             (GvStation *self);
+gboolean gv_station_is_dead                (GvStation *self);
+
+/* Background health check */
+
+gint64       gv_station_get_check_time (GvStation *self);
+const gchar *gv_station_get_check_error(GvStation *self);
+void         gv_station_set_check_result(GvStation *self, const gchar *error);
+
 #endif /* __GOODVIBES_CORE_GV_STATION_H__ */
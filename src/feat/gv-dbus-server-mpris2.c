@@ -156,6 +156,8 @@ static const gchar *DBUS_INTROSPECTION =
 struct _GvDbusServerMpris2 {
 	/* Parent instance structure */
 	GvDbusServer parent_instance;
+	/* Metadata of the current station, built when needed */
+	GVariant    *metadata_map;
 };
 
 G_DEFINE_TYPE(GvDbusServerMpris2, gv_dbus_server_mpris2, GV_TYPE_DBUS_SERVER)
@@ -164,7 +166,27 @@ G_DEFINE_TYPE(GvDbusServerMpris2, gv_dbus_server_mpris2, GV_TYPE_DBUS_SERVER)
  * Helpers
  */
 
-static gchar *
+/* Object paths are built once per station, and attached to it */
+
+static GQuark playlist_id_quark;
+static GQuark track_id_quark;
+
+static const gchar *
+get_object_path(GvStation *station, GQuark quark, const gchar *prefix)
+{
+	gchar *path;
+
+	path = g_object_get_qdata(G_OBJECT(station), quark);
+	if (path)
+		return path;
+
+	path = g_strdup_printf("%s/%s", prefix, gv_station_get_uid(station));
+	g_object_set_qdata_full(G_OBJECT(station), quark, path, g_free);
+
+	return path;
+}
+
+static const gchar *
 make_playlist_id(GvStation *station)
 {
 	/* As suggested in the MPRIS2 specifications, "/" should be used if NULL.
@@ -172,9 +194,9 @@ make_playlist_id(GvStation *station)
 	 * Playlists_Interface.html#Struct:Maybe_Playlist
 	 */
 	if (station == NULL)
-		return g_strdup("/");
+		return "/";
 
-	return g_strdup_printf(PLAYLISTID_PATH "/%s", gv_station_get_uid(station));
+	return get_object_path(station, playlist_id_quark, PLAYLISTID_PATH);
 }
 
 static gboolean
@@ -201,13 +223,13 @@ parse_playlist_id(const gchar    *playlist_id,
 	return TRUE;
 }
 
-static gchar *
+static const gchar *
 make_track_id(GvStation *station)
 {
 	if (station == NULL)
-		return g_strdup(DBUS_PATH "/TrackList/NoTrack");
+		return DBUS_PATH "/TrackList/NoTrack";
 
-	return g_strdup_printf(TRACKID_PATH "/%s", gv_station_get_uid(station));
+	return get_object_path(station, track_id_quark, TRACKID_PATH);
 }
 
 static gboolean
@@ -234,73 +256,6 @@ parse_track_id(const gchar     *track_id,
 	return TRUE;
 }
 
-static gint
-compare_alphabetically(GvStation *a, GvStation *b)
-{
-	const gchar *str1 = gv_station_get_name_or_uri(a);
-	const gchar *str2 = gv_station_get_name_or_uri(b);
-
-	return g_strcmp0(str1, str2);
-}
-
-static GList *
-build_station_list(GvStationList *station_list, gboolean alphabetical,
-                   gboolean reverse, guint start_index, guint max_count)
-{
-	GvStationListIter *iter;
-	GvStation *station;
-	GList *list = NULL;
-
-	/* Build a GList */
-	iter = gv_station_list_iter_new(station_list);
-
-	while (gv_station_list_iter_loop(iter, &station))
-		list = g_list_append(list, station);
-
-	gv_station_list_iter_free(iter);
-
-	/* Order alphabetically if needed */
-	if (alphabetical)
-		list = g_list_sort(list, (GCompareFunc) compare_alphabetically);
-
-	/* Reverse order if needed */
-	if (reverse)
-		list = g_list_reverse(list);
-
-	/* Handle start index */
-	while (start_index > 0) {
-		if (list == NULL)
-			break;
-
-		list = g_list_delete_link(list, list);
-		start_index--;
-	}
-
-	/* Handle max count */
-	GList *tmp = list;
-
-	while (max_count > 0) {
-		if (tmp == NULL)
-			break;
-
-		tmp = tmp->next;
-		max_count--;
-	}
-
-	if (tmp != NULL) {
-		if (tmp == list) {
-			g_list_free(list);
-			list = NULL;
-		} else {
-			tmp->prev->next = NULL;
-			tmp->prev = NULL;
-			g_list_free(tmp);
-		}
-	}
-
-	return list;
-}
-
 /*
  * GVariant helpers for MPRIS2 types
  */
@@ -308,18 +263,12 @@ build_station_list(GvStationList *station_list, gboolean alphabetical,
 static GVariant *
 g_variant_new_playlist(GvStation *station)
 {
-	gchar *playlist_id;
-
-	playlist_id = make_playlist_id(station);
-
 	GVariant *tuples[] = {
-		g_variant_new_object_path(playlist_id),
+		g_variant_new_object_path(make_playlist_id(station)),
 		g_variant_new_string(station ? gv_station_get_name_or_uri(station) : ""),
 		g_variant_new_string("")
 	};
 
-	g_free(playlist_id);
-
 	return g_variant_new_tuple(tuples, 3);
 }
 
@@ -338,7 +287,6 @@ static GVariant *
 g_variant_new_metadata_map(GvStation *station, GvMetadata *metadata)
 {
 	GVariantBuilder b;
-	gchar *track_id;
 	const gchar *uri;
 	const gchar *name;
 	const gchar *artist;
@@ -354,9 +302,8 @@ g_variant_new_metadata_map(GvStation *station, GvMetadata *metadata)
 	if (station == NULL)
 		goto end;
 
-	track_id = make_track_id(station);
-	g_variant_builder_add_dictentry_object_path(&b, "mpris:trackid", track_id);
-	g_free(track_id);
+	g_variant_builder_add_dictentry_object_path(&b, "mpris:trackid",
+	                                            make_track_id(station));
 
 	name = gv_station_get_name(station);
 	if (name)
@@ -446,6 +393,36 @@ g_variant_new_volume(GvPlayer *player)
 	return g_variant_new_double((gdouble) volume / 100.0);
 }
 
+/*
+ * Metadata cache
+ */
+
+static GVariant *
+get_metadata_map(GvDbusServerMpris2 *self)
+{
+	GvPlayer *player = gv_core_player;
+	GvStation *station;
+	GvMetadata *metadata;
+
+	if (self->metadata_map)
+		return self->metadata_map;
+
+	station = gv_player_get_station(player);
+	metadata = gv_player_get_metadata(player);
+	self->metadata_map = g_variant_ref_sink(g_variant_new_metadata_map(station, metadata));
+
+	return self->metadata_map;
+}
+
+static void
+invalidate_metadata_map(GvDbusServerMpris2 *self)
+{
+	if (self->metadata_map) {
+		g_variant_unref(self->metadata_map);
+		self->metadata_map = NULL;
+	}
+}
+
 /*
  * Dbus method handlers
  */
@@ -754,29 +731,47 @@ method_get_playlists(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 {
 	GvStationList *station_list = gv_core_station_list;
 	GVariantBuilder b;
+	GvStationListIter *iter;
+	GvStation *station;
 	GList *list, *item;
 	guint32 start_index, max_count;
 	const gchar *order;
 	gboolean reverse_order;
-	gboolean alphabetical;
 
 	g_variant_get(params, "(uu&sb)", &start_index, &max_count, &order, &reverse_order);
 
-	/* We only support 'Alphabetical' */
-	if (!g_strcmp0(order, "Alphabetical"))
-		alphabetical = TRUE;
-	else
-		alphabetical = FALSE;
-
-	/* Make a list */
-	list = build_station_list(station_list, alphabetical, reverse_order,
-	                          start_index, max_count);
-
 	/* Make a GVariant */
 	g_variant_builder_init(&b, G_VARIANT_TYPE("a(oss)"));
 
-	for (item = list; item; item = item->next) {
-		GvStation *station = item->data;
+	/* We only support 'Alphabetical', which the station list keeps sorted */
+	if (!g_strcmp0(order, "Alphabetical")) {
+		list = gv_station_list_get_sorted_range(station_list, start_index,
+		                                        max_count, reverse_order);
+
+		for (item = list; item; item = item->next) {
+			station = item->data;
+			g_variant_builder_add_value(&b, g_variant_new_playlist(station));
+		}
+
+		g_list_free(list);
+
+		return g_variant_builder_end(&b);
+	}
+
+	/* Otherwise it's the user order */
+	list = NULL;
+	iter = gv_station_list_iter_new(station_list);
+	while (gv_station_list_iter_loop(iter, &station))
+		list = g_list_prepend(list, station);
+	gv_station_list_iter_free(iter);
+
+	/* The list is in reverse order now */
+	if (!reverse_order)
+		list = g_list_reverse(list);
+
+	for (item = g_list_nth(list, start_index); item && max_count > 0;
+	     item = item->next, max_count--) {
+		station = item->data;
 		g_variant_builder_add_value(&b, g_variant_new_playlist(station));
 	}
 
@@ -969,16 +964,11 @@ prop_get_rate(GvDbusServer *dbus_server G_GNUC_UNUSED)
 }
 
 static GVariant *
-prop_get_metadata(GvDbusServer *dbus_server G_GNUC_UNUSED)
+prop_get_metadata(GvDbusServer *dbus_server)
 {
-	GvPlayer *player = gv_core_player;
-	GvStation *station;
-	GvMetadata *metadata;
+	GvDbusServerMpris2 *self = GV_DBUS_SERVER_MPRIS2(dbus_server);
 
-	station = gv_player_get_station(player);
-	metadata = gv_player_get_metadata(player);
-
-	return g_variant_new_metadata_map(station, metadata);
+	return g_variant_ref(get_metadata_map(self));
 }
 
 static GVariant *
@@ -1043,12 +1033,8 @@ prop_get_tracks(GvDbusServer *dbus_server G_GNUC_UNUSED)
 	g_variant_builder_init(&b, G_VARIANT_TYPE("ao"));
 	iter = gv_station_list_iter_new(station_list);
 
-	while (gv_station_list_iter_loop(iter, &station)) {
-		gchar *track_id;
-		track_id = make_track_id(station);
-		g_variant_builder_add(&b, "o", track_id);
-		g_free(track_id);
-	}
+	while (gv_station_list_iter_loop(iter, &station))
+		g_variant_builder_add(&b, "o", make_track_id(station));
 
 	gv_station_list_iter_free(iter);
 	return g_variant_builder_end(&b);
@@ -1127,46 +1113,44 @@ on_player_notify(GvPlayer           *player,
 			return;
 
 		gv_dbus_server_emit_signal_property_changed
-		(dbus_server, DBUS_IFACE_PLAYER, "PlaybackStatus",
+		(dbus_server, NULL, DBUS_IFACE_PLAYER, "PlaybackStatus",
 		 g_variant_new_playback_status(player));
 
 	} else if (!g_strcmp0(property_name, "repeat")) {
 		gv_dbus_server_emit_signal_property_changed
-		(dbus_server, DBUS_IFACE_PLAYER, "LoopStatus",
+		(dbus_server, NULL, DBUS_IFACE_PLAYER, "LoopStatus",
 		 g_variant_new_loop_status(player));
 
 	} else if (!g_strcmp0(property_name, "shuffle")) {
 		gv_dbus_server_emit_signal_property_changed
-		(dbus_server, DBUS_IFACE_PLAYER, "Shuffle",
+		(dbus_server, NULL, DBUS_IFACE_PLAYER, "Shuffle",
 		 g_variant_new_shuffle(player));
 
 	} else if (!g_strcmp0(property_name, "volume")) {
 		gv_dbus_server_emit_signal_property_changed
-		(dbus_server, DBUS_IFACE_PLAYER, "Volume",
+		(dbus_server, NULL, DBUS_IFACE_PLAYER, "Volume",
 		 g_variant_new_volume(player));
 
 	} else if (!g_strcmp0(property_name, "station")) {
 		GvStation *station = gv_player_get_station(player);
-		GvMetadata *metadata = gv_player_get_metadata(player);
 
+		invalidate_metadata_map(self);
 		gv_dbus_server_emit_signal_property_changed
-		(dbus_server, DBUS_IFACE_PLAYER, "Metadata",
-		 g_variant_new_metadata_map(station, metadata));
+		(dbus_server, NULL, DBUS_IFACE_PLAYER, "Metadata",
+		 g_variant_ref(get_metadata_map(self)));
 
 		/* This signal should be send only if the station's name
 		 * or the station's icon was changed.
 		 */
 		gv_dbus_server_emit_signal_property_changed
-		(dbus_server, DBUS_IFACE_PLAYLISTS, "PlaylistChanged",
+		(dbus_server, NULL, DBUS_IFACE_PLAYLISTS, "PlaylistChanged",
 		 g_variant_new_playlist(station));
 
 	} else if (!g_strcmp0(property_name, "metadata")) {
-		GvStation *station = gv_player_get_station(player);
-		GvMetadata *metadata = gv_player_get_metadata(player);
-
+		invalidate_metadata_map(self);
 		gv_dbus_server_emit_signal_property_changed
-		(dbus_server, DBUS_IFACE_PLAYER, "Metadata",
-		 g_variant_new_metadata_map(station, metadata));
+		(dbus_server, NULL, DBUS_IFACE_PLAYER, "Metadata",
+		 g_variant_ref(get_metadata_map(self)));
 	}
 }
 
@@ -1178,9 +1162,9 @@ on_station_list_station_added(GvStationList      *station_list,
 	GvDbusServer *dbus_server = GV_DBUS_SERVER(self);
 	GVariantBuilder b;
 	GvStation *after_station;
-	gchar *after_track_id;
+	const gchar *after_track_id;
 
-	after_station = gv_station_list_prev(station_list, station, FALSE, FALSE);
+	after_station = gv_station_list_prev(station_list, station, FALSE, FALSE, FALSE);
 	after_track_id = make_track_id(after_station);
 
 	g_variant_builder_init(&b, G_VARIANT_TYPE("(a{sv}o)"));
@@ -1189,8 +1173,26 @@ on_station_list_station_added(GvStationList      *station_list,
 
 	gv_dbus_server_emit_signal(dbus_server, DBUS_IFACE_TRACKLIST, "TrackAdded",
 	                           g_variant_builder_end(&b));
+}
+
+/* It's cheaper to replace the whole track list than to add tracks one by one */
+static void
+on_station_list_stations_added(GvStationList      *station_list G_GNUC_UNUSED,
+                               GList              *stations G_GNUC_UNUSED,
+                               GvDbusServerMpris2 *self)
+{
+	GvDbusServer *dbus_server = GV_DBUS_SERVER(self);
+	GvStation *current_station;
+	GVariantBuilder b;
+
+	current_station = gv_player_get_station(gv_core_player);
 
-	g_free(after_track_id);
+	g_variant_builder_init(&b, G_VARIANT_TYPE("(aoo)"));
+	g_variant_builder_add_value(&b, prop_get_tracks(dbus_server));
+	g_variant_builder_add(&b, "o", make_track_id(current_station));
+
+	gv_dbus_server_emit_signal(dbus_server, DBUS_IFACE_TRACKLIST, "TrackListReplaced",
+	                           g_variant_builder_end(&b));
 }
 
 static void
@@ -1200,7 +1202,7 @@ on_station_list_station_removed(GvStationList      *station_list G_GNUC_UNUSED,
 {
 	GvDbusServer *dbus_server = GV_DBUS_SERVER(self);
 	GVariantBuilder b;
-	gchar *track_id;
+	const gchar *track_id;
 
 	track_id = make_track_id(station);
 
@@ -1209,8 +1211,6 @@ on_station_list_station_removed(GvStationList      *station_list G_GNUC_UNUSED,
 
 	gv_dbus_server_emit_signal(dbus_server, DBUS_IFACE_TRACKLIST, "TrackRemoved",
 	                           g_variant_builder_end(&b));
-
-	g_free(track_id);
 }
 
 static void
@@ -1220,7 +1220,7 @@ on_station_list_station_modified(GvStationList      *station_list G_GNUC_UNUSED,
 {
 	GvDbusServer *dbus_server = GV_DBUS_SERVER(self);
 	GVariantBuilder b;
-	gchar *track_id;
+	const gchar *track_id;
 
 	track_id = make_track_id(station);
 
@@ -1231,7 +1231,20 @@ on_station_list_station_modified(GvStationList      *station_list G_GNUC_UNUSED,
 	gv_dbus_server_emit_signal(dbus_server, DBUS_IFACE_TRACKLIST, "TrackMetadataChanged",
 	                           g_variant_builder_end(&b));
 
-	g_free(track_id);
+	/* The current station might have been renamed. Stations are also
+	 * modified when their stats change, in which case there's no need
+	 * to tell anyone.
+	 */
+	if (self->metadata_map && station == gv_player_get_station(gv_core_player)) {
+		GVariant *old_map = self->metadata_map;
+
+		self->metadata_map = NULL;
+		if (!g_variant_equal(old_map, get_metadata_map(self)))
+			gv_dbus_server_emit_signal_property_changed
+			(dbus_server, NULL, DBUS_IFACE_PLAYER, "Metadata",
+			 g_variant_ref(self->metadata_map));
+		g_variant_unref(old_map);
+	}
 }
 
 /*
@@ -1248,6 +1261,9 @@ gv_dbus_server_mpris2_disable(GvFeature *feature)
 	g_signal_handlers_disconnect_by_data(station_list, feature);
 	g_signal_handlers_disconnect_by_data(player, feature);
 
+	/* Not kept up to date anymore */
+	invalidate_metadata_map(GV_DBUS_SERVER_MPRIS2(feature));
+
 	/* Chain up */
 	GV_FEATURE_CHAINUP_DISABLE(gv_dbus_server_mpris2, feature);
 }
@@ -1265,6 +1281,8 @@ gv_dbus_server_mpris2_enable(GvFeature *feature)
 	g_signal_connect(player, "notify", G_CALLBACK(on_player_notify), feature);
 	g_signal_connect(station_list, "station-added",
 	                 G_CALLBACK(on_station_list_station_added), feature);
+	g_signal_connect(station_list, "stations-added",
+	                 G_CALLBACK(on_station_list_stations_added), feature);
 	g_signal_connect(station_list, "station-removed",
 	                 G_CALLBACK(on_station_list_station_removed), feature);
 	g_signal_connect(station_list, "station-modified",
@@ -1319,6 +1337,10 @@ gv_dbus_server_mpris2_class_init(GvDbusServerMpris2Class *class)
 	/* Override GObject methods */
 	object_class->constructed = gv_dbus_server_mpris2_constructed;
 
+	/* Quarks for the object paths attached to stations */
+	playlist_id_quark = g_quark_from_static_string("gv-mpris2-playlist-id");
+	track_id_quark = g_quark_from_static_string("gv-mpris2-track-id");
+
 	/* Override GvFeature methods */
 	feature_class->enable = gv_dbus_server_mpris2_enable;
 	feature_class->disable = gv_dbus_server_mpris2_disable;
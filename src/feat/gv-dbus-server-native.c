@@ -17,6 +17,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include <glib.h>
 #include <gio/gio.h>
 #include <glib-object.h>
@@ -33,12 +35,17 @@
 #define DBUS_IFACE_ROOT     PACKAGE_APPLICATION_ID
 #define DBUS_IFACE_PLAYER   DBUS_IFACE_ROOT ".Player"
 #define DBUS_IFACE_STATIONS DBUS_IFACE_ROOT ".Stations"
+#define DBUS_IFACE_HISTORY  DBUS_IFACE_ROOT ".History"
+
+/* Minimum interval between two Spectrum signals */
+#define SPECTRUM_SIGNAL_INTERVAL 100 /* ms */
 
 static const gchar *DBUS_INTROSPECTION =
         "<node>"
         "    <interface name='"DBUS_IFACE_ROOT"'>"
         "        <method name='Quit'/>"
-        "        <property name='Version' type='s' access='read'/>"
+        "        <property name='Version' type='s'  access='read'/>"
+        "        <property name='Zones'   type='as' access='read'/>"
         "    </interface>"
         "    <interface name='"DBUS_IFACE_PLAYER"'>"
         "        <method name='Play'>"
@@ -48,16 +55,28 @@ static const gchar *DBUS_INTROSPECTION =
         "        <method name='PlayStop'/>"
         "        <method name='Next'/>"
         "        <method name='Previous'/>"
+        "        <method name='StartRecording'/>"
+        "        <method name='StopRecording'/>"
         "        <property name='Current' type='a{sv}' access='read'/>"
         "        <property name='Playing' type='b'     access='read'/>"
         "        <property name='Repeat'  type='b'     access='readwrite'/>"
         "        <property name='Shuffle' type='b'     access='readwrite'/>"
         "        <property name='Volume'  type='u'     access='readwrite'/>"
         "        <property name='Mute'    type='b'     access='readwrite'/>"
+        "        <property name='Recording' type='b'   access='read'/>"
+        "        <signal name='Spectrum'>"
+        "            <arg name='Magnitudes' type='ad'/>"
+        "        </signal>"
         "    </interface>"
         "    <interface name='"DBUS_IFACE_STATIONS"'>"
         "        <method name='List'>"
+        "            <arg direction='in'  name='Offset'        type='u'/>"
+        "            <arg direction='in'  name='Limit'         type='u'/>"
+        "            <arg direction='in'  name='Filter'        type='s'/>"
+        "            <arg direction='in'  name='Fields'        type='as'/>"
+        "            <arg direction='in'  name='Cursor'        type='s'/>"
         "            <arg direction='out' name='Stations'      type='aa{sv}'/>"
+        "            <arg direction='out' name='NextCursor'    type='s'/>"
         "        </method>"
         "        <method name='Add'>"
         "            <arg direction='in'  name='StationUri'    type='s'/>"
@@ -77,6 +96,44 @@ static const gchar *DBUS_INTROSPECTION =
         "            <arg direction='in'  name='Where'         type='s'/>"
         "            <arg direction='in'  name='AroundStation' type='s'/>"
         "        </method>"
+        "        <method name='AddMany'>"
+        "            <arg direction='in'  name='Stations'      type='a(ssss)'/>"
+        "            <arg direction='out' name='Errors'        type='as'/>"
+        "        </method>"
+        "        <method name='RemoveMany'>"
+        "            <arg direction='in'  name='Stations'      type='as'/>"
+        "            <arg direction='out' name='Errors'        type='as'/>"
+        "        </method>"
+        "        <method name='Reorder'>"
+        "            <arg direction='in'  name='Stations'      type='as'/>"
+        "            <arg direction='out' name='Errors'        type='as'/>"
+        "        </method>"
+        "        <method name='Changes'>"
+        "            <arg direction='in'  name='Since'         type='t'/>"
+        "            <arg direction='out' name='Revision'      type='t'/>"
+        "            <arg direction='out' name='Changes'       type='aa{sv}'/>"
+        "            <arg direction='out' name='Complete'      type='b'/>"
+        "        </method>"
+        "        <method name='Search'>"
+        "            <arg direction='in'  name='Query'         type='s'/>"
+        "            <arg direction='in'  name='Offset'        type='u'/>"
+        "            <arg direction='in'  name='Limit'         type='u'/>"
+        "            <arg direction='out' name='Results'       type='aa{sv}'/>"
+        "            <arg direction='out' name='Total'         type='u'/>"
+        "        </method>"
+        "        <property name='Revision' type='t' access='read'/>"
+        "        <signal name='StationsChanged'>"
+        "            <arg name='Revision' type='t'/>"
+        "        </signal>"
+        "    </interface>"
+        "    <interface name='"DBUS_IFACE_HISTORY"'>"
+        "        <method name='Query'>"
+        "            <arg direction='in'  name='Station'       type='s'/>"
+        "            <arg direction='in'  name='Start'         type='x'/>"
+        "            <arg direction='in'  name='End'           type='x'/>"
+        "            <arg direction='in'  name='MaxEntries'    type='u'/>"
+        "            <arg direction='out' name='Entries'       type='aa{sv}'/>"
+        "        </method>"
         "    </interface>"
         "</node>";
 
@@ -87,6 +144,10 @@ static const gchar *DBUS_INTROSPECTION =
 struct _GvDbusServerNative {
 	/* Parent instance structure */
 	GvDbusServer parent_instance;
+	/* Time of the last Spectrum signal */
+	gint64       spectrum_time;
+	/* Pending StationsChanged signal */
+	guint        when_idle_id;
 };
 
 G_DEFINE_TYPE(GvDbusServerNative, gv_dbus_server_native, GV_TYPE_DBUS_SERVER)
@@ -95,8 +156,96 @@ G_DEFINE_TYPE(GvDbusServerNative, gv_dbus_server_native, GV_TYPE_DBUS_SERVER)
  * Helpers
  */
 
+static gchar *
+make_zone_path(const gchar *zone)
+{
+	gchar *id;
+	gchar *path;
+
+	id = gv_core_make_zone_id(zone);
+	path = g_strdup_printf("%s/Zones/%s", DBUS_PATH, id);
+	g_free(id);
+
+	return path;
+}
+
+static GvPlayer *
+get_player(GvDbusServer *dbus_server)
+{
+	const gchar *path;
+	GList *item;
+
+	/* The player interface is exported at the main path for the main
+	 * player, and under /Zones for each zone.
+	 */
+	path = gv_dbus_server_get_invocation_path(dbus_server);
+	if (path == NULL || !g_strcmp0(path, DBUS_PATH))
+		return gv_core_player;
+
+	for (item = gv_core_zones; item; item = item->next) {
+		GvPlayer *player = item->data;
+		gchar *zone_path;
+		gboolean match;
+
+		zone_path = make_zone_path(gv_player_get_zone(player));
+		match = !g_strcmp0(path, zone_path);
+		g_free(zone_path);
+
+		if (match)
+			return player;
+	}
+
+	WARNING("No player for path '%s'", path);
+	return gv_core_player;
+}
+
+/* The other way around, where a player is exported */
+static gchar *
+make_player_path(GvPlayer *player)
+{
+	if (player == gv_core_player)
+		return g_strdup(DBUS_PATH);
+
+	return make_zone_path(gv_player_get_zone(player));
+}
+
+/* Fields to serialize, NULL or empty means all of them */
+static gboolean
+has_field(const gchar * const *fields, const gchar *field)
+{
+	if (fields == NULL || fields[0] == NULL)
+		return TRUE;
+
+	return g_strv_contains(fields, field);
+}
+
+static gboolean
+station_matches(GvStation *station, const gchar *filter)
+{
+	const gchar *strings[] = {
+		gv_station_get_name(station),
+		gv_station_get_uri(station)
+	};
+	gboolean match = FALSE;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(strings) && !match; i++) {
+		gchar *folded;
+
+		if (strings[i] == NULL)
+			continue;
+
+		folded = g_utf8_casefold(strings[i], -1);
+		match = strstr(folded, filter) != NULL;
+		g_free(folded);
+	}
+
+	return match;
+}
+
 static GVariant *
-g_variant_new_station(GvStation *station, GvMetadata *metadata)
+g_variant_new_station(GvStation *station, GvMetadata *metadata,
+                      const gchar * const *fields)
 {
 	GVariantBuilder b;
 	const gchar *uri;
@@ -107,6 +256,9 @@ g_variant_new_station(GvStation *station, GvMetadata *metadata)
 	const gchar *genre;
 	const gchar *year;
 	const gchar *comment;
+	const gchar *check_error;
+	const GvStationStats *stats;
+	gint64 check_time;
 
 	g_variant_builder_init(&b, G_VARIANT_TYPE("a{sv}"));
 
@@ -114,14 +266,46 @@ g_variant_new_station(GvStation *station, GvMetadata *metadata)
 	if (station == NULL)
 		goto end;
 
+	if (has_field(fields, "uid"))
+		g_variant_builder_add_dictentry_string(&b, "uid", gv_station_get_uid(station));
+
 	uri = gv_station_get_uri(station);
-	if (uri)
+	if (uri && has_field(fields, "uri"))
 		g_variant_builder_add_dictentry_string(&b, "uri", uri);
 
 	name = gv_station_get_name(station);
-	if (name)
+	if (name && has_field(fields, "name"))
 		g_variant_builder_add_dictentry_string(&b, "name", name);
 
+	/* Result of the background health check, if any */
+	check_time = gv_station_get_check_time(station);
+	if (check_time > 0) {
+		if (has_field(fields, "check-time"))
+			g_variant_builder_add(&b, "{sv}", "check-time",
+			                      g_variant_new_int64(check_time));
+		check_error = gv_station_get_check_error(station);
+		if (check_error && has_field(fields, "check-error"))
+			g_variant_builder_add_dictentry_string(&b, "check-error",
+			                                       check_error);
+	}
+
+	/* Connection stats, once the station has been played */
+	stats = gv_station_get_stats(station);
+	if (stats->successes + stats->failures > 0) {
+		if (has_field(fields, "health"))
+			g_variant_builder_add(&b, "{sv}", "health",
+			                      g_variant_new_double(gv_station_get_health(station)));
+		if (has_field(fields, "success-rate"))
+			g_variant_builder_add(&b, "{sv}", "success-rate",
+			                      g_variant_new_double(gv_station_get_success_rate(station)));
+		if (has_field(fields, "median-connect-time"))
+			g_variant_builder_add(&b, "{sv}", "median-connect-time",
+			                      g_variant_new_uint32(gv_station_get_median_connect_time(station)));
+		if (has_field(fields, "rebuffer-rate"))
+			g_variant_builder_add(&b, "{sv}", "rebuffer-rate",
+			                      g_variant_new_double(gv_station_get_rebuffer_rate(station)));
+	}
+
 	/* Metadata if any */
 	if (metadata == NULL)
 		goto end;
@@ -174,11 +358,11 @@ static GvDbusMethod root_methods[] = {
 };
 
 static GVariant *
-method_play(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+method_play(GvDbusServer  *dbus_server,
             GVariant       *params,
             GError        **error)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	gchar *string;
 
 	g_variant_get(params, "(&s)", &string);
@@ -215,11 +399,11 @@ method_play(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 }
 
 static GVariant *
-method_stop(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+method_stop(GvDbusServer  *dbus_server,
             GVariant       *params G_GNUC_UNUSED,
             GError        **error G_GNUC_UNUSED)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 
 	gv_player_stop(player);
 
@@ -227,11 +411,11 @@ method_stop(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 }
 
 static GVariant *
-method_play_stop(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+method_play_stop(GvDbusServer  *dbus_server,
                  GVariant       *params G_GNUC_UNUSED,
                  GError        **error G_GNUC_UNUSED)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 
 	gv_player_toggle(player);
 
@@ -239,11 +423,11 @@ method_play_stop(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 }
 
 static GVariant *
-method_next(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+method_next(GvDbusServer  *dbus_server,
             GVariant       *params G_GNUC_UNUSED,
             GError        **error  G_GNUC_UNUSED)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 
 	gv_player_next(player);
 
@@ -251,66 +435,152 @@ method_next(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 }
 
 static GVariant *
-method_prev(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+method_prev(GvDbusServer  *dbus_server,
             GVariant       *params G_GNUC_UNUSED,
             GError        **error G_GNUC_UNUSED)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 
 	gv_player_prev(player);
 
 	return NULL;
 }
 
+static GVariant *
+method_start_recording(GvDbusServer  *dbus_server,
+                       GVariant       *params G_GNUC_UNUSED,
+                       GError        **error)
+{
+	GvRecorder *recorder = gv_core_recorder;
+
+	if (get_player(dbus_server) != gv_core_player) {
+		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
+		            "Recording is not supported for zones");
+		return NULL;
+	}
+
+	gv_recorder_start(recorder);
+
+	return NULL;
+}
+
+static GVariant *
+method_stop_recording(GvDbusServer  *dbus_server,
+                      GVariant       *params G_GNUC_UNUSED,
+                      GError        **error)
+{
+	GvRecorder *recorder = gv_core_recorder;
+
+	if (get_player(dbus_server) != gv_core_player) {
+		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
+		            "Recording is not supported for zones");
+		return NULL;
+	}
+
+	gv_recorder_stop(recorder);
+
+	return NULL;
+}
+
 static GvDbusMethod player_methods[] = {
-	{ "Play",     method_play      },
-	{ "Stop",     method_stop      },
-	{ "PlayStop", method_play_stop },
-	{ "Next",     method_next      },
-	{ "Previous", method_prev      },
-	{ NULL,       NULL             }
+	{ "Play",           method_play            },
+	{ "Stop",           method_stop            },
+	{ "PlayStop",       method_play_stop       },
+	{ "Next",           method_next            },
+	{ "Previous",       method_prev            },
+	{ "StartRecording", method_start_recording },
+	{ "StopRecording",  method_stop_recording  },
+	{ NULL,             NULL                   }
 };
 
+/* The stations are returned in pages, in alphabetical order. Each page comes
+ * with a cursor, that is the uid of the first station of the next page (or an
+ * empty string if there's no more stations), and that can be given back to
+ * get the next page. Offset is counted from the cursor, if any. A limit of
+ * zero means no limit. Thanks to the alphabetical index, resuming from the
+ * cursor doesn't require to walk the list from the start.
+ */
 static GVariant *
 method_list(GvDbusServer  *dbus_server G_GNUC_UNUSED,
-            GVariant       *params G_GNUC_UNUSED,
-            GError        **error G_GNUC_UNUSED)
+            GVariant       *params,
+            GError        **error)
 {
 	GvStationList *station_list = gv_core_station_list;
-	GvStationListIter *iter;
 	GvStation *station;
 	GVariantBuilder b;
+	const gchar *filter;
+	const gchar *cursor;
+	const gchar **fields;
+	const gchar *next_cursor;
+	gchar *folded_filter;
+	guint32 offset, limit;
+	guint n_stations;
+
+	g_variant_get(params, "(uu&s^a&s&s)", &offset, &limit, &filter, &fields, &cursor);
+
+	/* Start from the cursor, after checking that it still points to a station */
+	if (cursor[0] == '\0') {
+		station = gv_station_list_get_sorted_next(station_list, NULL);
+	} else {
+		station = gv_station_list_find_by_uid(station_list, cursor);
+		if (station == NULL) {
+			g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
+			            "Invalid cursor '%s'", cursor);
+			g_free(fields);
+			return NULL;
+		}
+	}
+
+	folded_filter = g_utf8_casefold(filter, -1);
+	next_cursor = "";
+	n_stations = 0;
 
 	g_variant_builder_init(&b, G_VARIANT_TYPE("aa{sv}"));
-	iter = gv_station_list_iter_new(station_list);
 
-	while (gv_station_list_iter_loop(iter, &station))
-		g_variant_builder_add_value(&b, g_variant_new_station(station, NULL));
+	for (; station; station = gv_station_list_get_sorted_next(station_list, station)) {
+		if (folded_filter[0] != '\0' && !station_matches(station, folded_filter))
+			continue;
 
-	gv_station_list_iter_free(iter);
-	return g_variant_builder_end(&b);
+		if (offset > 0) {
+			offset--;
+			continue;
+		}
+
+		/* Page is full, remember where the next one starts */
+		if (limit > 0 && n_stations == limit) {
+			next_cursor = gv_station_get_uid(station);
+			break;
+		}
+
+		g_variant_builder_add_value(&b, g_variant_new_station
+		                            (station, NULL, (const gchar * const *) fields));
+		n_stations++;
+	}
+
+	g_free(folded_filter);
+	g_free(fields);
+
+	GVariant *tuples[] = {
+		g_variant_builder_end(&b),
+		g_variant_new_string(next_cursor)
+	};
+
+	return g_variant_new_tuple(tuples, 2);
 }
 
-static GVariant *
-method_add(GvDbusServer  *dbus_server G_GNUC_UNUSED,
-           GVariant       *params,
-           GError        **error)
+static gboolean
+add_station(GvStationList *station_list, const gchar *uri, const gchar *name,
+            const gchar *where, const gchar *around, GError **error)
 {
-	GvStationList *station_list = gv_core_station_list;
 	GvStation *new_station;
 	GvStation *around_station;
-	gchar *uri;
-	gchar *name;
-	gchar *where;
-	gchar *around;
-
-	g_variant_get(params, "(&s&s&s&s)", &uri, &name, &where, &around);
+	gboolean ret = TRUE;
 
 	/* Handle new station */
 	if (!is_uri_scheme_supported(uri)) {
 		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
 		            "URI scheme not supported");
-		return NULL;
+		return FALSE;
 	}
 
 	new_station = gv_station_new(name, uri);
@@ -325,36 +595,218 @@ method_add(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 		gv_station_list_insert_before(station_list, new_station, around_station);
 	else if (!g_strcmp0(where, "after"))
 		gv_station_list_insert_after(station_list, new_station, around_station);
-	else
+	else {
 		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
 		            "Invalid keyword '%s'", where);
+		ret = FALSE;
+	}
 
 	g_object_unref(new_station);
 
+	return ret;
+}
+
+static gboolean
+remove_station(GvStationList *station_list, const gchar *station, GError **error)
+{
+	GvStation *match;
+
+	match = gv_station_list_find_by_guessing(station_list, station);
+	if (match == NULL) {
+		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
+		            "Station '%s' not found", station);
+		return FALSE;
+	}
+
+	gv_station_list_remove(station_list, match);
+
+	return TRUE;
+}
+
+/* Batch methods apply every item, and return an error message for each
+ * of them, empty if the item succeeded.
+ */
+static void
+add_batch_result(GVariantBuilder *b, GError *err)
+{
+	g_variant_builder_add(b, "s", err ? err->message : "");
+}
+
+static GVariant *
+method_add(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+           GVariant       *params,
+           GError        **error)
+{
+	GvStationList *station_list = gv_core_station_list;
+	gchar *uri;
+	gchar *name;
+	gchar *where;
+	gchar *around;
+
+	g_variant_get(params, "(&s&s&s&s)", &uri, &name, &where, &around);
+
+	add_station(station_list, uri, name, where, around, error);
+
 	return NULL;
 }
 
+/* Stations to add at the beginning or at the end of the list are
+ * accumulated, and inserted in one go. Each of them would have been
+ * prepended to the previous one, so the order is reversed for "first".
+ */
+static void
+flush_pending_stations(GvStationList *station_list, GList **pending, gboolean first)
+{
+	if (*pending == NULL)
+		return;
+
+	if (first) {
+		gv_station_list_insert_many(station_list, *pending, 0);
+	} else {
+		*pending = g_list_reverse(*pending);
+		gv_station_list_insert_many(station_list, *pending, -1);
+	}
+
+	g_list_free_full(*pending, g_object_unref);
+	*pending = NULL;
+}
+
+static GVariant *
+method_add_many(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+                GVariant       *params,
+                GError        **error G_GNUC_UNUSED)
+{
+	GvStationList *station_list = gv_core_station_list;
+	GVariantIter *iter;
+	GVariantBuilder b;
+	GList *pending = NULL;
+	gboolean pending_first = FALSE;
+	gchar *uri;
+	gchar *name;
+	gchar *where;
+	gchar *around;
+
+	g_variant_get(params, "(a(ssss))", &iter);
+	g_variant_builder_init(&b, G_VARIANT_TYPE("as"));
+
+	while (g_variant_iter_next(iter, "(&s&s&s&s)", &uri, &name, &where, &around)) {
+		GError *err = NULL;
+		gboolean first = !g_strcmp0(where, "first");
+		gboolean last = !g_strcmp0(where, "last") || !g_strcmp0(where, "");
+
+		if ((first || last) && !is_uri_scheme_supported(uri)) {
+			g_set_error(&err, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
+			            "URI scheme not supported");
+			add_batch_result(&b, err);
+			g_clear_error(&err);
+			continue;
+		}
+
+		if (first || last) {
+			if (pending && pending_first != first)
+				flush_pending_stations(station_list, &pending, pending_first);
+
+			pending = g_list_prepend(pending, gv_station_new(name, uri));
+			pending_first = first;
+			add_batch_result(&b, NULL);
+			continue;
+		}
+
+		/* Other stations might refer to the pending ones */
+		flush_pending_stations(station_list, &pending, pending_first);
+
+		add_station(station_list, uri, name, where, around, &err);
+		add_batch_result(&b, err);
+		g_clear_error(&err);
+	}
+
+	flush_pending_stations(station_list, &pending, pending_first);
+
+	g_variant_iter_free(iter);
+
+	return g_variant_builder_end(&b);
+}
+
 static GVariant *
 method_remove(GvDbusServer  *dbus_server G_GNUC_UNUSED,
               GVariant       *params,
               GError        **error)
 {
 	GvStationList *station_list = gv_core_station_list;
-	GvStation *match;
 	gchar *station;
 
 	g_variant_get(params, "(&s)", &station);
 
-	match = gv_station_list_find_by_guessing(station_list, station);
-	if (match)
-		gv_station_list_remove(station_list, match);
-	else
-		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
-		            "Station '%s' not found", station);
+	remove_station(station_list, station, error);
 
 	return NULL;
 }
 
+static GVariant *
+method_remove_many(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+                   GVariant       *params,
+                   GError        **error G_GNUC_UNUSED)
+{
+	GvStationList *station_list = gv_core_station_list;
+	GVariantIter *iter;
+	GVariantBuilder b;
+	gchar *station;
+
+	g_variant_get(params, "(as)", &iter);
+	g_variant_builder_init(&b, G_VARIANT_TYPE("as"));
+
+	while (g_variant_iter_next(iter, "&s", &station)) {
+		GError *err = NULL;
+
+		remove_station(station_list, station, &err);
+		add_batch_result(&b, err);
+		g_clear_error(&err);
+	}
+
+	g_variant_iter_free(iter);
+
+	return g_variant_builder_end(&b);
+}
+
+static GVariant *
+method_reorder(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+               GVariant       *params,
+               GError        **error G_GNUC_UNUSED)
+{
+	GvStationList *station_list = gv_core_station_list;
+	GVariantIter *iter;
+	GVariantBuilder b;
+	GList *stations = NULL;
+	gchar *station;
+
+	g_variant_get(params, "(as)", &iter);
+	g_variant_builder_init(&b, G_VARIANT_TYPE("as"));
+
+	/* Stations found are moved at the top of the list, in this order */
+	while (g_variant_iter_next(iter, "&s", &station)) {
+		GError *err = NULL;
+		GvStation *match;
+
+		match = gv_station_list_find_by_guessing(station_list, station);
+		if (match)
+			stations = g_list_prepend(stations, match);
+		else
+			g_set_error(&err, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
+			            "Station '%s' not found", station);
+
+		add_batch_result(&b, err);
+		g_clear_error(&err);
+	}
+
+	stations = g_list_reverse(stations);
+	gv_station_list_reorder(station_list, stations);
+
+	g_list_free(stations);
+	g_variant_iter_free(iter);
+
+	return g_variant_builder_end(&b);
+}
+
 static GVariant *
 method_rename(GvDbusServer  *dbus_server G_GNUC_UNUSED,
               GVariant       *params,
@@ -416,13 +868,202 @@ method_move(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 	return NULL;
 }
 
+static GVariant *
+g_variant_new_station_change(GvStationChange *change)
+{
+	static const gchar *change_names[] = {
+		[GV_STATION_CHANGE_ADDED]    = "added",
+		[GV_STATION_CHANGE_REMOVED]  = "removed",
+		[GV_STATION_CHANGE_MOVED]    = "moved",
+		[GV_STATION_CHANGE_MODIFIED] = "modified",
+	};
+	GVariantBuilder b;
+
+	g_variant_builder_init(&b, G_VARIANT_TYPE("a{sv}"));
+
+	g_variant_builder_add(&b, "{sv}", "revision", g_variant_new_uint64(change->revision));
+	g_variant_builder_add_dictentry_string(&b, "change", change_names[change->type]);
+	g_variant_builder_add_dictentry_string(&b, "uid", change->uid);
+
+	if (change->name)
+		g_variant_builder_add_dictentry_string(&b, "name", change->name);
+
+	if (change->uri)
+		g_variant_builder_add_dictentry_string(&b, "uri", change->uri);
+
+	if (change->position >= 0)
+		g_variant_builder_add(&b, "{sv}", "position", g_variant_new_int32(change->position));
+
+	return g_variant_builder_end(&b);
+}
+
+/* Changes since a given revision, for clients to keep in sync. If the
+ * revision is too old, or if it comes from a previous run (the upper 32 bits
+ * of the revision are an epoch that changes on every restart), the changes
+ * are not complete, and the client must list the stations again.
+ */
+static GVariant *
+method_changes(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+               GVariant       *params,
+               GError        **error G_GNUC_UNUSED)
+{
+	GvStationList *station_list = gv_core_station_list;
+	GVariantBuilder b;
+	GList *changes, *item;
+	guint64 since;
+	gboolean complete;
+
+	g_variant_get(params, "(t)", &since);
+
+	complete = gv_station_list_get_changes(station_list, since, &changes);
+
+	g_variant_builder_init(&b, G_VARIANT_TYPE("aa{sv}"));
+	for (item = changes; item; item = item->next)
+		g_variant_builder_add_value(&b, g_variant_new_station_change(item->data));
+
+	g_list_free_full(changes, (GDestroyNotify) gv_station_change_free);
+
+	GVariant *tuples[] = {
+		g_variant_new_uint64(gv_station_list_get_revision(station_list)),
+		g_variant_builder_end(&b),
+		g_variant_new_boolean(complete)
+	};
+
+	return g_variant_new_tuple(tuples, 3);
+}
+
+static GVariant *
+method_search(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+              GVariant       *params,
+              GError        **error G_GNUC_UNUSED)
+{
+	GvSearch *search = gv_core_search;
+	GPtrArray *results;
+	GVariantBuilder b;
+	gchar *query;
+	guint offset;
+	guint limit;
+	guint total;
+	guint i;
+
+	g_variant_get(params, "(&suu)", &query, &offset, &limit);
+
+	results = gv_search_query(search, query, offset, limit, &total);
+
+	g_variant_builder_init(&b, G_VARIANT_TYPE("aa{sv}"));
+
+	for (i = 0; i < results->len; i++) {
+		GvSearchResult *result = g_ptr_array_index(results, i);
+		GvStation *station = result->station;
+
+		g_variant_builder_open(&b, G_VARIANT_TYPE("a{sv}"));
+		g_variant_builder_add(&b, "{sv}", "score",
+		                      g_variant_new_uint32(result->score));
+
+		if (result->type == GV_SEARCH_RESULT_STATION) {
+			g_variant_builder_add_dictentry_string(&b, "type", "station");
+			if (gv_station_get_uri(station))
+				g_variant_builder_add_dictentry_string(&b, "uri",
+				                                       gv_station_get_uri(station));
+			if (gv_station_get_name(station))
+				g_variant_builder_add_dictentry_string(&b, "name",
+				                                       gv_station_get_name(station));
+		} else {
+			g_variant_builder_add_dictentry_string(&b, "type", "track");
+			if (result->station_uri)
+				g_variant_builder_add_dictentry_string(&b, "uri", result->station_uri);
+			if (result->station_name)
+				g_variant_builder_add_dictentry_string(&b, "name", result->station_name);
+			if (result->title)
+				g_variant_builder_add_dictentry_string(&b, "title", result->title);
+			if (result->artist)
+				g_variant_builder_add_dictentry_string(&b, "artist", result->artist);
+		}
+
+		g_variant_builder_close(&b);
+	}
+
+	g_ptr_array_unref(results);
+
+	return g_variant_new("(aa{sv}u)", &b, total);
+}
+
 static GvDbusMethod stations_methods[] = {
-	{ "List",   method_list   },
-	{ "Add",    method_add    },
-	{ "Remove", method_remove },
-	{ "Rename", method_rename },
-	{ "Move",   method_move   },
-	{ NULL,     NULL          }
+	{ "List",       method_list        },
+	{ "Add",        method_add         },
+	{ "Remove",     method_remove      },
+	{ "Rename",     method_rename      },
+	{ "Move",       method_move        },
+	{ "AddMany",    method_add_many    },
+	{ "RemoveMany", method_remove_many },
+	{ "Reorder",    method_reorder     },
+	{ "Changes",    method_changes     },
+	{ "Search",     method_search      },
+	{ NULL,         NULL               }
+};
+
+static GVariant *
+method_history_query(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+                     GVariant       *params,
+                     GError        **error)
+{
+	GvStationList *station_list = gv_core_station_list;
+	GvHistory *history = gv_core_history;
+	const gchar *station_uri;
+	GPtrArray *entries;
+	GVariantBuilder b;
+	gchar *station;
+	gint64 start;
+	gint64 end;
+	guint max_entries;
+	guint i;
+
+	g_variant_get(params, "(&sxxu)", &station, &start, &end, &max_entries);
+
+	/* Empty string: any station. Otherwise, it's likely to be a station
+	 * from the list. If it's not, it might be the uri of a station that
+	 * was removed from the list since then.
+	 */
+	if (!g_strcmp0(station, "")) {
+		station_uri = NULL;
+	} else {
+		GvStation *match;
+
+		match = gv_station_list_find_by_guessing(station_list, station);
+		station_uri = match ? gv_station_get_uri(match) : station;
+	}
+
+	entries = gv_history_query(history, station_uri, start, end, max_entries, error);
+	if (entries == NULL)
+		return NULL;
+
+	g_variant_builder_init(&b, G_VARIANT_TYPE("aa{sv}"));
+
+	for (i = 0; i < entries->len; i++) {
+		GvHistoryEntry *entry = g_ptr_array_index(entries, i);
+
+		g_variant_builder_open(&b, G_VARIANT_TYPE("a{sv}"));
+		g_variant_builder_add(&b, "{sv}", "time",
+		                      g_variant_new_int64(entry->timestamp));
+		if (entry->station_uri)
+			g_variant_builder_add_dictentry_string(&b, "uri", entry->station_uri);
+		if (entry->station_name)
+			g_variant_builder_add_dictentry_string(&b, "name", entry->station_name);
+		if (entry->title)
+			g_variant_builder_add_dictentry_string(&b, "title", entry->title);
+		if (entry->artist)
+			g_variant_builder_add_dictentry_string(&b, "artist", entry->artist);
+		g_variant_builder_close(&b);
+	}
+
+	g_ptr_array_unref(entries);
+
+	return g_variant_builder_end(&b);
+}
+
+static GvDbusMethod history_methods[] = {
+	{ "Query", method_history_query },
+	{ NULL,    NULL                 }
 };
 
 /*
@@ -435,28 +1076,46 @@ prop_get_version(GvDbusServer *dbus_server G_GNUC_UNUSED)
 	return g_variant_new_string(PACKAGE_VERSION);
 }
 
+static GVariant *
+prop_get_zones(GvDbusServer *dbus_server G_GNUC_UNUSED)
+{
+	GVariantBuilder b;
+	GList *item;
+
+	g_variant_builder_init(&b, G_VARIANT_TYPE("as"));
+
+	for (item = gv_core_zones; item; item = item->next) {
+		GvPlayer *player = item->data;
+
+		g_variant_builder_add(&b, "s", gv_player_get_zone(player));
+	}
+
+	return g_variant_builder_end(&b);
+}
+
 static GvDbusProperty root_properties[] = {
 	{ "Version", prop_get_version, NULL },
+	{ "Zones",   prop_get_zones,   NULL },
 	{ NULL,      NULL,             NULL }
 };
 
 static GVariant *
-prop_get_current(GvDbusServer *dbus_server G_GNUC_UNUSED)
+prop_get_current(GvDbusServer *dbus_server)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	GvStation *station;
 	GvMetadata *metadata;
 
 	station = gv_player_get_station(player);
 	metadata = gv_player_get_metadata(player);
 
-	return g_variant_new_station(station, metadata);
+	return g_variant_new_station(station, metadata, NULL);
 }
 
 static GVariant *
-prop_get_playing(GvDbusServer *dbus_server G_GNUC_UNUSED)
+prop_get_playing(GvDbusServer *dbus_server)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	GvPlayerState player_state;
 	gboolean is_playing;
 
@@ -467,9 +1126,9 @@ prop_get_playing(GvDbusServer *dbus_server G_GNUC_UNUSED)
 }
 
 static GVariant *
-prop_get_repeat(GvDbusServer *dbus_server G_GNUC_UNUSED)
+prop_get_repeat(GvDbusServer *dbus_server)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	gboolean repeat;
 
 	repeat = gv_player_get_repeat(player);
@@ -478,11 +1137,11 @@ prop_get_repeat(GvDbusServer *dbus_server G_GNUC_UNUSED)
 }
 
 static gboolean
-prop_set_repeat(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+prop_set_repeat(GvDbusServer  *dbus_server,
                 GVariant       *value,
                 GError        **error G_GNUC_UNUSED)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	gboolean repeat;
 
 	repeat = g_variant_get_boolean(value);
@@ -492,9 +1151,9 @@ prop_set_repeat(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 }
 
 static GVariant *
-prop_get_shuffle(GvDbusServer *dbus_server G_GNUC_UNUSED)
+prop_get_shuffle(GvDbusServer *dbus_server)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	gboolean shuffle;
 
 	shuffle = gv_player_get_shuffle(player);
@@ -503,11 +1162,11 @@ prop_get_shuffle(GvDbusServer *dbus_server G_GNUC_UNUSED)
 }
 
 static gboolean
-prop_set_shuffle(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+prop_set_shuffle(GvDbusServer  *dbus_server,
                  GVariant       *value,
                  GError        **error G_GNUC_UNUSED)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	gboolean shuffle;
 
 	shuffle = g_variant_get_boolean(value);
@@ -517,9 +1176,9 @@ prop_set_shuffle(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 }
 
 static GVariant *
-prop_get_volume(GvDbusServer *dbus_server G_GNUC_UNUSED)
+prop_get_volume(GvDbusServer *dbus_server)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	guint volume;
 
 	volume = gv_player_get_volume(player);
@@ -528,11 +1187,11 @@ prop_get_volume(GvDbusServer *dbus_server G_GNUC_UNUSED)
 }
 
 static gboolean
-prop_set_volume(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+prop_set_volume(GvDbusServer  *dbus_server,
                 GVariant       *value,
                 GError        **error G_GNUC_UNUSED)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	guint volume;
 
 	volume = g_variant_get_uint32(value);
@@ -542,9 +1201,9 @@ prop_set_volume(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 }
 
 static GVariant *
-prop_get_mute(GvDbusServer *dbus_server G_GNUC_UNUSED)
+prop_get_mute(GvDbusServer *dbus_server)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	gboolean mute;
 
 	mute = gv_player_get_mute(player);
@@ -553,11 +1212,11 @@ prop_get_mute(GvDbusServer *dbus_server G_GNUC_UNUSED)
 }
 
 static gboolean
-prop_set_mute(GvDbusServer  *dbus_server G_GNUC_UNUSED,
+prop_set_mute(GvDbusServer  *dbus_server,
               GVariant       *value,
               GError        **error G_GNUC_UNUSED)
 {
-	GvPlayer *player = gv_core_player;
+	GvPlayer *player = get_player(dbus_server);
 	gboolean mute;
 
 	mute = g_variant_get_boolean(value);
@@ -566,14 +1225,42 @@ prop_set_mute(GvDbusServer  *dbus_server G_GNUC_UNUSED,
 	return TRUE;
 }
 
+static GVariant *
+prop_get_recording(GvDbusServer *dbus_server)
+{
+	GvRecorder *recorder = gv_core_recorder;
+	gboolean recording;
+
+	if (get_player(dbus_server) != gv_core_player)
+		return g_variant_new_boolean(FALSE);
+
+	recording = gv_recorder_get_recording(recorder);
+
+	return g_variant_new_boolean(recording);
+}
+
+static GVariant *
+prop_get_revision(GvDbusServer *dbus_server G_GNUC_UNUSED)
+{
+	GvStationList *station_list = gv_core_station_list;
+
+	return g_variant_new_uint64(gv_station_list_get_revision(station_list));
+}
+
+static GvDbusProperty stations_properties[] = {
+	{ "Revision", prop_get_revision, NULL },
+	{ NULL,       NULL,              NULL }
+};
+
 static GvDbusProperty player_properties[] = {
-	{ "Current", prop_get_current, NULL             },
-	{ "Playing", prop_get_playing, NULL             },
-	{ "Repeat",  prop_get_repeat,  prop_set_repeat  },
-	{ "Shuffle", prop_get_shuffle, prop_set_shuffle },
-	{ "Volume",  prop_get_volume,  prop_set_volume  },
-	{ "Mute",    prop_get_mute,    prop_set_mute    },
-	{ NULL,      NULL,                        NULL  }
+	{ "Current",   prop_get_current,   NULL             },
+	{ "Playing",   prop_get_playing,   NULL             },
+	{ "Repeat",    prop_get_repeat,    prop_set_repeat  },
+	{ "Shuffle",   prop_get_shuffle,   prop_set_shuffle },
+	{ "Volume",    prop_get_volume,    prop_set_volume  },
+	{ "Mute",      prop_get_mute,      prop_set_mute    },
+	{ "Recording", prop_get_recording, NULL             },
+	{ NULL,        NULL,               NULL             }
 };
 
 /*
@@ -581,12 +1268,182 @@ static GvDbusProperty player_properties[] = {
  */
 
 static GvDbusInterface dbus_interfaces[] = {
-	{ DBUS_IFACE_ROOT,     root_methods,      root_properties   },
-	{ DBUS_IFACE_PLAYER,   player_methods,    player_properties },
-	{ DBUS_IFACE_STATIONS, stations_methods,  NULL              },
-	{ NULL,                NULL,              NULL              }
+	{ DBUS_IFACE_ROOT,     root_methods,      root_properties     },
+	{ DBUS_IFACE_PLAYER,   player_methods,    player_properties   },
+	{ DBUS_IFACE_STATIONS, stations_methods,  stations_properties },
+	{ DBUS_IFACE_HISTORY,  history_methods,   NULL                },
+	{ NULL,                NULL,              NULL                }
 };
 
+/*
+ * Signal handlers & callbacks
+ */
+
+static void
+on_engine_spectrum(GvEngine           *engine G_GNUC_UNUSED,
+                   guint               n_bands,
+                   const gfloat       *magnitudes,
+                   GvDbusServerNative *self)
+{
+	GvDbusServer *dbus_server = GV_DBUS_SERVER(self);
+	gint64 now = g_get_monotonic_time();
+	GVariantBuilder b;
+	guint i;
+
+	/* Spectrum frames come fast, don't flood the bus */
+	if (now - self->spectrum_time < SPECTRUM_SIGNAL_INTERVAL * 1000)
+		return;
+
+	self->spectrum_time = now;
+
+	g_variant_builder_init(&b, G_VARIANT_TYPE("ad"));
+	for (i = 0; i < n_bands; i++)
+		g_variant_builder_add(&b, "d", (gdouble) magnitudes[i]);
+
+	gv_dbus_server_emit_signal(dbus_server, DBUS_IFACE_PLAYER, "Spectrum",
+	                           g_variant_new("(ad)", &b));
+}
+
+static void
+on_player_notify(GvPlayer           *player,
+                 GParamSpec         *pspec,
+                 GvDbusServerNative *self)
+{
+	GvDbusServer *dbus_server = GV_DBUS_SERVER(self);
+	const gchar *property_name = g_param_spec_get_name(pspec);
+	const gchar *dbus_property_name;
+	GVariant *value;
+	gchar *path;
+
+	/* This might be the main player or a zone, so the values come
+	 * from the player that changed, not from the invocation path.
+	 */
+	if (!g_strcmp0(property_name, "station") ||
+	    !g_strcmp0(property_name, "metadata")) {
+		dbus_property_name = "Current";
+		value = g_variant_new_station(gv_player_get_station(player),
+		                              gv_player_get_metadata(player), NULL);
+	} else if (!g_strcmp0(property_name, "state")) {
+		dbus_property_name = "Playing";
+		value = g_variant_new_boolean(gv_player_get_state(player) ==
+		                              GV_PLAYER_STATE_PLAYING);
+	} else if (!g_strcmp0(property_name, "repeat")) {
+		dbus_property_name = "Repeat";
+		value = g_variant_new_boolean(gv_player_get_repeat(player));
+	} else if (!g_strcmp0(property_name, "shuffle")) {
+		dbus_property_name = "Shuffle";
+		value = g_variant_new_boolean(gv_player_get_shuffle(player));
+	} else if (!g_strcmp0(property_name, "volume")) {
+		dbus_property_name = "Volume";
+		value = g_variant_new_uint32(gv_player_get_volume(player));
+	} else if (!g_strcmp0(property_name, "mute")) {
+		dbus_property_name = "Mute";
+		value = g_variant_new_boolean(gv_player_get_mute(player));
+	} else {
+		return;
+	}
+
+	path = make_player_path(player);
+	gv_dbus_server_emit_signal_property_changed(dbus_server, path, DBUS_IFACE_PLAYER,
+	                                            dbus_property_name, value);
+	g_free(path);
+}
+
+static void
+on_recorder_notify_recording(GvRecorder         *recorder G_GNUC_UNUSED,
+                             GParamSpec         *pspec G_GNUC_UNUSED,
+                             GvDbusServerNative *self)
+{
+	GvDbusServer *dbus_server = GV_DBUS_SERVER(self);
+
+	/* Only the main player records */
+	gv_dbus_server_emit_signal_property_changed(dbus_server, DBUS_PATH,
+	                                            DBUS_IFACE_PLAYER, "Recording",
+	                                            prop_get_recording(dbus_server));
+}
+
+/* Changes might come in batches, clients are told only once */
+static gboolean
+when_idle_emit_stations_changed(GvDbusServerNative *self)
+{
+	GvDbusServer *dbus_server = GV_DBUS_SERVER(self);
+	GvStationList *station_list = gv_core_station_list;
+	guint64 revision;
+
+	self->when_idle_id = 0;
+
+	revision = gv_station_list_get_revision(station_list);
+	gv_dbus_server_emit_signal(dbus_server, DBUS_IFACE_STATIONS, "StationsChanged",
+	                           g_variant_new("(t)", revision));
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+on_station_list_notify_revision(GvStationList      *station_list G_GNUC_UNUSED,
+                                GParamSpec         *pspec G_GNUC_UNUSED,
+                                GvDbusServerNative *self)
+{
+	if (self->when_idle_id == 0)
+		self->when_idle_id = g_idle_add((GSourceFunc) when_idle_emit_stations_changed,
+		                                self);
+}
+
+/*
+ * GvFeature methods
+ */
+
+static void
+gv_dbus_server_native_disable(GvFeature *feature)
+{
+	GvDbusServerNative *self = GV_DBUS_SERVER_NATIVE(feature);
+	GvEngine *engine = gv_core_engine;
+	GvStationList *station_list = gv_core_station_list;
+	GvPlayer *player = gv_core_player;
+	GvRecorder *recorder = gv_core_recorder;
+	GList *item;
+
+	/* Remove pending signal */
+	if (self->when_idle_id) {
+		g_source_remove(self->when_idle_id);
+		self->when_idle_id = 0;
+	}
+
+	/* Signal handlers */
+	for (item = gv_core_zones; item; item = item->next)
+		g_signal_handlers_disconnect_by_data(item->data, feature);
+	g_signal_handlers_disconnect_by_data(recorder, feature);
+	g_signal_handlers_disconnect_by_data(player, feature);
+	g_signal_handlers_disconnect_by_data(station_list, feature);
+	g_signal_handlers_disconnect_by_data(engine, feature);
+
+	/* Chain up */
+	GV_FEATURE_CHAINUP_DISABLE(gv_dbus_server_native, feature);
+}
+
+static void
+gv_dbus_server_native_enable(GvFeature *feature)
+{
+	GvEngine *engine = gv_core_engine;
+	GvStationList *station_list = gv_core_station_list;
+	GvPlayer *player = gv_core_player;
+	GvRecorder *recorder = gv_core_recorder;
+	GList *item;
+
+	/* Chain up */
+	GV_FEATURE_CHAINUP_ENABLE(gv_dbus_server_native, feature);
+
+	/* Signal handlers */
+	g_signal_connect(engine, "spectrum", G_CALLBACK(on_engine_spectrum), feature);
+	g_signal_connect(station_list, "notify::revision",
+	                 G_CALLBACK(on_station_list_notify_revision), feature);
+	g_signal_connect(player, "notify", G_CALLBACK(on_player_notify), feature);
+	g_signal_connect(recorder, "notify::recording",
+	                 G_CALLBACK(on_recorder_notify_recording), feature);
+	for (item = gv_core_zones; item; item = item->next)
+		g_signal_connect(item->data, "notify", G_CALLBACK(on_player_notify), feature);
+}
+
 /*
  * Public methods
  */
@@ -605,12 +1462,23 @@ static void
 gv_dbus_server_native_constructed(GObject *object)
 {
 	GvDbusServer *dbus_server = GV_DBUS_SERVER(object);
+	GList *item;
 
 	/* Set dbus server properties - we don't set a name as we don't want to acquire any */
 	gv_dbus_server_set_dbus_path(dbus_server, DBUS_PATH);
 	gv_dbus_server_set_dbus_introspection(dbus_server, DBUS_INTROSPECTION);
 	gv_dbus_server_set_dbus_interface_table(dbus_server, dbus_interfaces);
 
+	/* Export the player interface for each zone */
+	for (item = gv_core_zones; item; item = item->next) {
+		GvPlayer *player = item->data;
+		gchar *path;
+
+		path = make_zone_path(gv_player_get_zone(player));
+		gv_dbus_server_add_dbus_object(dbus_server, path, DBUS_IFACE_PLAYER);
+		g_free(path);
+	}
+
 	/* Chain up */
 	G_OBJECT_CHAINUP_CONSTRUCTED(gv_dbus_server_native, object);
 }
@@ -625,9 +1493,14 @@ static void
 gv_dbus_server_native_class_init(GvDbusServerNativeClass *class)
 {
 	GObjectClass *object_class = G_OBJECT_CLASS(class);
+	GvFeatureClass *feature_class = GV_FEATURE_CLASS(class);
 
 	TRACE("%p", class);
 
 	/* Override GObject methods */
 	object_class->constructed = gv_dbus_server_native_constructed;
+
+	/* Override GvFeature methods */
+	feature_class->enable = gv_dbus_server_native_enable;
+	feature_class->disable = gv_dbus_server_native_disable;
 }
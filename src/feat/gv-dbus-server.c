@@ -27,8 +27,6 @@
 
 #include "feat/gv-dbus-server.h"
 
-#define MAX_INTERFACES 4
-
 #undef DEBUG_INTERFACES
 
 /*
@@ -59,17 +57,126 @@ struct _GvDbusServerPrivate {
 	const gchar      *path;
 	const gchar      *introspection;
 	GvDbusInterface *interface_table;
+	/* Dispatch map, built from the interface table */
+	GHashTable       *interfaces;
+	GHashTable       *methods;
+	GHashTable       *properties;
 	/* Dbus stuff */
 	GDBusNodeInfo    *introspection_data;
 	guint             bus_owner_id;
 	GDBusConnection  *bus_connection;
-	guint             registration_ids[MAX_INTERFACES + 1];
+	GArray           *registration_ids;
+	/* Additional objects, exporting a single interface */
+	GSList           *extra_objects;
+	/* Object path of the call being handled */
+	const gchar      *invocation_path;
+	/* Pending property changes, per object path and interface */
+	GHashTable       *pending_changes;
+	guint             when_idle_id;
 };
 
 typedef struct _GvDbusServerPrivate GvDbusServerPrivate;
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE(GvDbusServer, gv_dbus_server, GV_TYPE_FEATURE)
 
+typedef struct {
+	gchar       *path;
+	const gchar *interface_name;
+} GvDbusObject;
+
+static void
+gv_dbus_object_free(GvDbusObject *object)
+{
+	g_free(object->path);
+	g_free(object);
+}
+
+typedef struct {
+	/* Key */
+	GQuark                interface;
+	GQuark                member;
+	/* Value */
+	const GvDbusMethod   *method;
+	const GvDbusProperty *property;
+	/* Type of the value returned by the handler, NULL if unknown */
+	GVariantType         *type;
+} GvDbusHandler;
+
+static void
+gv_dbus_handler_free(GvDbusHandler *handler)
+{
+	if (handler->type)
+		g_variant_type_free(handler->type);
+	g_free(handler);
+}
+
+static guint
+gv_dbus_handler_hash(gconstpointer key)
+{
+	const GvDbusHandler *handler = key;
+
+	return handler->interface * 31 + handler->member;
+}
+
+static gboolean
+gv_dbus_handler_equal(gconstpointer a, gconstpointer b)
+{
+	const GvDbusHandler *handler1 = a;
+	const GvDbusHandler *handler2 = b;
+
+	return handler1->interface == handler2->interface &&
+	       handler1->member == handler2->member;
+}
+
+typedef struct {
+	/* Key */
+	gchar       *path;
+	gchar       *interface_name;
+	/* Value */
+	GHashTable  *properties;
+} GvDbusChanges;
+
+static GvDbusChanges *
+gv_dbus_changes_new(const gchar *path, const gchar *interface_name)
+{
+	GvDbusChanges *changes;
+
+	changes = g_new0(GvDbusChanges, 1);
+	changes->path = g_strdup(path);
+	changes->interface_name = g_strdup(interface_name);
+	changes->properties = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+	                                            (GDestroyNotify) g_variant_unref);
+
+	return changes;
+}
+
+static void
+gv_dbus_changes_free(GvDbusChanges *changes)
+{
+	g_hash_table_unref(changes->properties);
+	g_free(changes->interface_name);
+	g_free(changes->path);
+	g_free(changes);
+}
+
+static guint
+gv_dbus_changes_hash(gconstpointer key)
+{
+	const GvDbusChanges *changes = key;
+
+	return g_str_hash(changes->path) * 31 + g_str_hash(changes->interface_name);
+}
+
+static gboolean
+gv_dbus_changes_equal(gconstpointer a, gconstpointer b)
+{
+	const GvDbusChanges *changes1 = a;
+	const GvDbusChanges *changes2 = b;
+
+	return !g_strcmp0(changes1->path, changes2->path) &&
+	       !g_strcmp0(changes1->interface_name, changes2->interface_name);
+}
+
 /*
  * Debug helpers
  */
@@ -204,6 +311,226 @@ debug_interfaces(GvDbusServer *self)
 }
 #endif
 
+/*
+ * Dispatch map
+ *
+ * The interface table is compiled into hash tables once, when the server
+ * is constructed, rather than going through the table for each call.
+ * Names are interned as quarks: a name that was never interned can't be
+ * implemented, and is rejected without any lookup. The types of the values
+ * returned by the handlers are taken from the introspection data, and
+ * checked before they're sent on the bus.
+ */
+
+static GVariantType *
+make_method_type(GDBusMethodInfo *info)
+{
+	GPtrArray *types;
+	GVariantType *type;
+	GDBusArgInfo **args;
+
+	types = g_ptr_array_new();
+	for (args = info->out_args; args && *args; args++)
+		g_ptr_array_add(types, (gpointer) G_VARIANT_TYPE((*args)->signature));
+
+	type = g_variant_type_new_tuple((const GVariantType * const *) types->pdata,
+	                                types->len);
+	g_ptr_array_free(types, TRUE);
+
+	return type;
+}
+
+static void
+build_dispatch_map(GvDbusServer *self)
+{
+	GvDbusServerPrivate   *priv = gv_dbus_server_get_instance_private(self);
+	const GvDbusInterface *iface;
+	const GvDbusMethod    *method;
+	const GvDbusProperty  *prop;
+
+	for (iface = priv->interface_table; iface->name; iface++) {
+		GDBusInterfaceInfo *iface_info;
+		GQuark iface_quark;
+
+		iface_quark = g_quark_from_static_string(iface->name);
+		g_hash_table_add(priv->interfaces, GUINT_TO_POINTER(iface_quark));
+
+		iface_info = g_dbus_node_info_lookup_interface(priv->introspection_data,
+		                                               iface->name);
+
+		for (method = iface->methods; method && method->name; method++) {
+			GvDbusHandler *handler;
+			GDBusMethodInfo *info = NULL;
+
+			handler = g_new0(GvDbusHandler, 1);
+			handler->interface = iface_quark;
+			handler->member = g_quark_from_static_string(method->name);
+			handler->method = method;
+
+			if (iface_info)
+				info = g_dbus_interface_info_lookup_method(iface_info,
+				                                           method->name);
+			if (info)
+				handler->type = make_method_type(info);
+
+			g_hash_table_add(priv->methods, handler);
+		}
+
+		for (prop = iface->properties; prop && prop->name; prop++) {
+			GvDbusHandler *handler;
+			GDBusPropertyInfo *info = NULL;
+
+			handler = g_new0(GvDbusHandler, 1);
+			handler->interface = iface_quark;
+			handler->member = g_quark_from_static_string(prop->name);
+			handler->property = prop;
+
+			if (iface_info)
+				info = g_dbus_interface_info_lookup_property(iface_info,
+				                                             prop->name);
+			if (info)
+				handler->type = g_variant_type_new(info->signature);
+
+			g_hash_table_add(priv->properties, handler);
+		}
+	}
+}
+
+static GvDbusHandler *
+lookup_handler(GHashTable *handlers, const gchar *interface_name,
+               const gchar *member_name)
+{
+	GvDbusHandler key;
+
+	key.interface = g_quark_try_string(interface_name);
+	if (key.interface == 0)
+		return NULL;
+
+	key.member = g_quark_try_string(member_name);
+	if (key.member == 0)
+		return NULL;
+
+	return g_hash_table_lookup(handlers, &key);
+}
+
+static gboolean
+has_interface(GvDbusServer *self, const gchar *interface_name)
+{
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+	GQuark quark;
+
+	quark = g_quark_try_string(interface_name);
+	if (quark == 0)
+		return FALSE;
+
+	return g_hash_table_contains(priv->interfaces, GUINT_TO_POINTER(quark));
+}
+
+/*
+ * Property changes
+ *
+ * Changes are accumulated per object path and interface, and each batch is
+ * sent all at once in a single PropertiesChanged signal, on the object path
+ * it belongs to, from an idle callback. If a property changes
+ * several times in a row, only the latest value is sent.
+ */
+
+static void
+emit_signal(GvDbusServer *self, const gchar *path, const gchar *interface_name,
+            const gchar *signal_name, GVariant *parameters)
+{
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+	GError *error = NULL;
+
+	/* Parameters might come as a floating reference or a full one */
+	if (parameters)
+		g_variant_take_ref(parameters);
+
+	/* We're not sure to have a connection to dbus. Connection might fail
+	 * (for example, if the name is already owned). Or, early at startup,
+	 * we might still be waiting for the connection to finish when we're
+	 * asked to send the first signals. In any case, we must check that the
+	 * connection exists before using it.
+	 */
+	if (priv->bus_connection == NULL) {
+		if (parameters)
+			g_variant_unref(parameters);
+		return;
+	}
+
+	g_dbus_connection_emit_signal(priv->bus_connection, NULL, path,
+	                              interface_name, signal_name, parameters, &error);
+	if (error) {
+		WARNING("Failed to emit dbus signal: %s", error->message);
+		g_error_free(error);
+	}
+
+	if (parameters)
+		g_variant_unref(parameters);
+}
+
+static void
+flush_property_changes(GvDbusServer *self)
+{
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+	GHashTableIter iter;
+	GvDbusChanges *changes;
+
+	if (priv->when_idle_id) {
+		g_source_remove(priv->when_idle_id);
+		priv->when_idle_id = 0;
+	}
+
+	g_hash_table_iter_init(&iter, priv->pending_changes);
+	while (g_hash_table_iter_next(&iter, (gpointer *) &changes, NULL)) {
+		GHashTableIter changes_iter;
+		const gchar *property_name;
+		GVariant *value;
+		GVariantBuilder b;
+
+		g_variant_builder_init(&b, G_VARIANT_TYPE("a{sv}"));
+		g_hash_table_iter_init(&changes_iter, changes->properties);
+		while (g_hash_table_iter_next(&changes_iter, (gpointer *) &property_name,
+		                              (gpointer *) &value))
+			g_variant_builder_add(&b, "{sv}", property_name, value);
+
+		GVariant *tuples[] = {
+			g_variant_new_string(changes->interface_name),
+			g_variant_builder_end(&b),
+			g_variant_new_strv(NULL, 0)
+		};
+
+		emit_signal(self, changes->path, "org.freedesktop.DBus.Properties",
+		            "PropertiesChanged", g_variant_new_tuple(tuples, 3));
+
+		g_hash_table_iter_remove(&iter);
+	}
+}
+
+static void
+drop_property_changes(GvDbusServer *self)
+{
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+
+	if (priv->when_idle_id) {
+		g_source_remove(priv->when_idle_id);
+		priv->when_idle_id = 0;
+	}
+
+	g_hash_table_remove_all(priv->pending_changes);
+}
+
+static gboolean
+when_idle_flush_property_changes(GvDbusServer *self)
+{
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+
+	priv->when_idle_id = 0;
+	flush_property_changes(self);
+
+	return G_SOURCE_REMOVE;
+}
+
 /*
  * GDBus helpers
  */
@@ -220,8 +547,7 @@ handle_method_call(GDBusConnection       *connection,
 {
 	GvDbusServer          *self = GV_DBUS_SERVER(user_data);
 	GvDbusServerPrivate   *priv = gv_dbus_server_get_instance_private(self);
-	const GvDbusInterface *iface;
-	const GvDbusMethod    *method;
+	const GvDbusHandler   *handler;
 	GVariant               *ret = NULL;
 	GError                 *error = NULL;
 	const gchar            *bus_name = connection ?
@@ -231,38 +557,25 @@ handle_method_call(GDBusConnection       *connection,
 	TRACE("%s, %s, %s, %s, %s, ...",
 	      bus_name, sender, object_path, interface_name, method_name);
 
-	/* Iterate over interfaces */
-	for (iface = priv->interface_table; iface && iface->name; iface++) {
-		if (g_strcmp0(iface->name, interface_name))
-			continue;
-
-		/* Iterate over methods */
-		for (method = iface->methods; method && method->name; method++) {
-			if (g_strcmp0(method->name, method_name))
-				continue;
-
-			if (method->call)
-				ret = method->call(self, parameters, &error);
-			else
-				g_set_error(&error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
-				            "Method is not implemented.");
+	/* Find the handler and invoke it */
+	handler = lookup_handler(priv->methods, interface_name, method_name);
 
-			break;
-		}
-
-		/* Check if method was found */
-		if (method == NULL || method->name == NULL)
+	if (handler == NULL) {
+		if (has_interface(self, interface_name))
 			g_set_error(&error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
 			            "Method not found.");
-
-		break;
+		else
+			g_set_error(&error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_INTERFACE,
+			            "Interface not found.");
+	} else if (handler->method->call == NULL) {
+		g_set_error(&error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
+		            "Method is not implemented.");
+	} else {
+		priv->invocation_path = object_path;
+		ret = handler->method->call(self, parameters, &error);
+		priv->invocation_path = NULL;
 	}
 
-	/* Check if interface was found */
-	if (iface == NULL || iface->name == NULL)
-		g_set_error(&error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_INTERFACE,
-		            "Interface not found.");
-
 	/* Return with error if any */
 	if (error) {
 		g_dbus_method_invocation_return_gerror(invocation, error);
@@ -270,12 +583,37 @@ handle_method_call(GDBusConnection       *connection,
 		return;
 	}
 
-	/* Return value if any */
-	if (ret == NULL)
+	/* Return value if any. Methods with several out arguments
+	 * return them in a tuple already, otherwise it must be wrapped.
+	 */
+	if (ret == NULL) {
 		g_dbus_method_invocation_return_value(invocation, NULL);
-	else
-		g_dbus_method_invocation_return_value(invocation,
-		                                      g_variant_new_tuple(&ret, 1));
+		return;
+	}
+
+	/* Handlers might return a floating reference or a full one */
+	g_variant_take_ref(ret);
+
+	if (!g_variant_is_of_type(ret, handler->type ? handler->type : G_VARIANT_TYPE_TUPLE)) {
+		GVariant *tuple = g_variant_take_ref(g_variant_new_tuple(&ret, 1));
+
+		g_variant_unref(ret);
+		ret = tuple;
+	}
+
+	if (handler->type && !g_variant_is_of_type(ret, handler->type)) {
+		WARNING("Method '%s': returned '%s' instead of '%s'", method_name,
+		        g_variant_get_type_string(ret),
+		        g_variant_type_peek_string(handler->type));
+		g_variant_unref(ret);
+		g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR,
+		                                      G_DBUS_ERROR_FAILED,
+		                                      "Invalid return value.");
+		return;
+	}
+
+	g_dbus_method_invocation_return_value(invocation, ret);
+	g_variant_unref(ret);
 }
 
 static GVariant *
@@ -289,45 +627,49 @@ handle_get_property(GDBusConnection  *connection,
 {
 	GvDbusServer          *self = GV_DBUS_SERVER(user_data);
 	GvDbusServerPrivate   *priv = gv_dbus_server_get_instance_private(self);
-	const GvDbusInterface *iface;
-	const GvDbusProperty  *prop;
+	const GvDbusHandler   *handler;
+	GVariant               *ret;
 	const gchar            *bus_name = connection ?
 	                                   g_dbus_connection_get_unique_name(connection) : "(null)";
 
 	TRACE("%s, %s, %s, %s, %s, ...",
 	      bus_name, sender, object_path, interface_name, property_name);
 
-	/* Iterate over interfaces */
-	for (iface = priv->interface_table; iface && iface->name; iface++) {
-		if (g_strcmp0(iface->name, interface_name))
-			continue;
-
-		/* Iterate over properties */
-		for (prop = iface->properties; prop && prop->name; prop++) {
-			if (g_strcmp0(prop->name, property_name))
-				continue;
-
-			if (prop->get == NULL) {
-				g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
-				            "Property reader is not implemented.");
-				return NULL;
-			}
-
-			return prop->get(self);
-		}
+	/* Find the handler */
+	handler = lookup_handler(priv->properties, interface_name, property_name);
 
-		/* Property not found */
-		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_PROPERTY,
-		            "Property not found.");
+	if (handler == NULL) {
+		if (has_interface(self, interface_name))
+			g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_PROPERTY,
+			            "Property not found.");
+		else
+			g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_INTERFACE,
+			            "Interface not found.");
+		return NULL;
+	}
 
+	if (handler->property->get == NULL) {
+		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
+		            "Property reader is not implemented.");
 		return NULL;
 	}
 
-	/* Interface not found */
-	g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_INTERFACE,
-	            "Interface not found.");
+	/* Invoke it */
+	priv->invocation_path = object_path;
+	ret = handler->property->get(self);
+	priv->invocation_path = NULL;
+
+	if (ret && handler->type && !g_variant_is_of_type(ret, handler->type)) {
+		WARNING("Property '%s': got '%s' instead of '%s'", property_name,
+		        g_variant_get_type_string(ret),
+		        g_variant_type_peek_string(handler->type));
+		g_variant_unref(g_variant_take_ref(ret));
+		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
+		            "Invalid property value.");
+		return NULL;
+	}
 
-	return NULL;
+	return ret;
 }
 
 static gboolean
@@ -342,45 +684,39 @@ handle_set_property(GDBusConnection  *connection,
 {
 	GvDbusServer          *self = GV_DBUS_SERVER(user_data);
 	GvDbusServerPrivate   *priv = gv_dbus_server_get_instance_private(self);
-	const GvDbusInterface *iface = NULL;
-	const GvDbusProperty  *prop = NULL;
+	const GvDbusHandler   *handler;
+	gboolean               ret;
 	const gchar            *bus_name = connection ?
 	                                   g_dbus_connection_get_unique_name(connection) : "(null)";
 
 	TRACE("%s, %s, %s, %s, %s, ...",
 	      bus_name, sender, object_path, interface_name, property_name);
 
-	/* Iterate over interfaces */
-	for (iface = priv->interface_table; iface && iface->name; iface++) {
-		if (g_strcmp0(iface->name, interface_name))
-			continue;
+	/* Find the handler */
+	handler = lookup_handler(priv->properties, interface_name, property_name);
 
-		/* Iterate over properties */
-		for (prop = iface->properties; prop && prop->name; prop++) {
-			if (g_strcmp0(prop->name, property_name))
-				continue;
-
-			if (prop->set == NULL) {
-				g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
-				            "Property writer is not implemented.");
-				return FALSE;
-			}
-
-			return prop->set(self, value, error);
-		}
-
-		/* Property not found */
-		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_PROPERTY,
-		            "Property not found.");
+	if (handler == NULL) {
+		if (has_interface(self, interface_name))
+			g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_PROPERTY,
+			            "Property not found.");
+		else
+			g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_INTERFACE,
+			            "Interface not found.");
+		return FALSE;
+	}
 
+	if (handler->property->set == NULL) {
+		g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
+		            "Property writer is not implemented.");
 		return FALSE;
 	}
 
-	/* Interface not found */
-	g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_INTERFACE,
-	            "Interface not found.");
+	/* The value type was checked by GDBus already */
+	priv->invocation_path = object_path;
+	ret = handler->property->set(self, value, error);
+	priv->invocation_path = NULL;
 
-	return FALSE;
+	return ret;
 }
 
 static const
@@ -394,34 +730,52 @@ GDBusInterfaceVTable interface_vtable = {
  * Private methods
  */
 
+static void
+gv_dbus_server_register_object(GvDbusServer *self, const gchar *path,
+                               GDBusInterfaceInfo *interface)
+{
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+	GError *error = NULL;
+	guint id;
+
+	id = g_dbus_connection_register_object(priv->bus_connection,
+	                                       path,
+	                                       interface,
+	                                       &interface_vtable,
+	                                       self,
+	                                       NULL,
+	                                       &error);
+	if (id == 0) {
+		WARNING("Failed to register interface '%s' at '%s': %s",
+		        interface->name, path, error->message);
+		g_error_free(error);
+		return;
+	}
+
+	g_array_append_val(priv->registration_ids, id);
+
+	INFO("Interface '%s' registered at '%s'", interface->name, path);
+}
+
 static void
 gv_dbus_server_register_objects(GvDbusServer *self)
 {
 	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
 	GDBusInterfaceInfo **interfaces = priv->introspection_data->interfaces;
 	GDBusInterfaceInfo *interface;
-	guint i;
+	GSList *item;
 
-	// TODO: checks
+	while (interfaces && (interface = *interfaces++))
+		gv_dbus_server_register_object(self, priv->path, interface);
 
-	i = 0;
-	while (interfaces && (interface = *interfaces++)) {
-		guint id;
+	for (item = priv->extra_objects; item; item = item->next) {
+		GvDbusObject *object = item->data;
 
-		g_assert(i < MAX_INTERFACES);
+		interface = g_dbus_node_info_lookup_interface(priv->introspection_data,
+		                                              object->interface_name);
+		g_assert_nonnull(interface);
 
-		id = g_dbus_connection_register_object(priv->bus_connection,
-		                                       priv->path,
-		                                       interface,
-		                                       &interface_vtable,
-		                                       self,
-		                                       NULL,
-		                                       NULL);
-		g_assert(id > 0);
-
-		priv->registration_ids[i++] = id;
-
-		INFO("Interface '%s' registered", interface->name);
+		gv_dbus_server_register_object(self, object->path, interface);
 	}
 }
 
@@ -431,11 +785,12 @@ gv_dbus_server_unregister_objects(GvDbusServer *self)
 	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
 	guint i;
 
-	for (i = 0; priv->registration_ids[i] > 0; i++) {
+	for (i = 0; i < priv->registration_ids->len; i++)
 		g_dbus_connection_unregister_object(priv->bus_connection,
-		                                    priv->registration_ids[i]);
-		priv->registration_ids[i] = 0;
-	}
+		                                    g_array_index(priv->registration_ids,
+		                                                  guint, i));
+
+	g_array_set_size(priv->registration_ids, 0);
 }
 
 /*
@@ -511,6 +866,14 @@ gv_dbus_server_set_dbus_interface_table(GvDbusServer *self, GvDbusInterface *val
 	priv->interface_table = value;
 }
 
+const gchar *
+gv_dbus_server_get_invocation_path(GvDbusServer *self)
+{
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+
+	return priv->invocation_path;
+}
+
 static void
 gv_dbus_server_get_property(GObject    *object,
                             guint       property_id,
@@ -560,42 +923,64 @@ gv_dbus_server_emit_signal(GvDbusServer *self, const gchar *interface_name,
                            const gchar *signal_name, GVariant *parameters)
 {
 	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
-	GError *error = NULL;
 
-	/* We're not sure to have a connection to dbus. Connection might fail
-	 * (for example, if the name is already owned). Or, early at startup,
-	 * we might still be waiting for the connection to finish when we're
-	 * asked to send the first signals. In any case, we must check that the
-	 * connection exists before using it.
-	 */
-	if (priv->bus_connection == NULL)
+	/* Pending property changes happened before, send them first */
+	flush_property_changes(self);
+
+	emit_signal(self, priv->path, interface_name, signal_name, parameters);
+}
+
+void
+gv_dbus_server_emit_signal_property_changed(GvDbusServer *self, const gchar *path,
+                const gchar *interface_name, const gchar *property_name, GVariant *value)
+{
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+	GvDbusChanges key = { (gchar *) path, (gchar *) interface_name, NULL };
+	GvDbusChanges *changes;
+
+	/* We own the value from now on, be it floating or not */
+	g_variant_take_ref(value);
+
+	/* Nobody to send it to */
+	if (priv->bus_connection == NULL) {
+		g_variant_unref(value);
 		return;
+	}
 
-	g_dbus_connection_emit_signal(priv->bus_connection, NULL, priv->path,
-	                              interface_name, signal_name, parameters, &error);
-	if (error) {
-		WARNING("Failed to emit dbus signal: %s", error->message);
-		g_error_free(error);
+	/* The main object, unless told otherwise */
+	if (path == NULL)
+		key.path = (gchar *) priv->path;
+
+	/* Queue the change, replacing any previous value */
+	changes = g_hash_table_lookup(priv->pending_changes, &key);
+	if (changes == NULL) {
+		changes = gv_dbus_changes_new(key.path, interface_name);
+		g_hash_table_add(priv->pending_changes, changes);
 	}
+
+	g_hash_table_replace(changes->properties, g_strdup(property_name), value);
+
+	/* Send it later */
+	if (priv->when_idle_id == 0)
+		priv->when_idle_id = g_idle_add((GSourceFunc) when_idle_flush_property_changes,
+		                                self);
 }
 
 void
-gv_dbus_server_emit_signal_property_changed(GvDbusServer *self, const gchar *interface_name,
-                const gchar *property_name, GVariant *value)
+gv_dbus_server_add_dbus_object(GvDbusServer *self, const gchar *path,
+                               const gchar *interface_name)
 {
-	GVariantBuilder b;
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+	GvDbusObject *object;
 
-	g_variant_builder_init(&b, G_VARIANT_TYPE("a{sv}"));
-	g_variant_builder_add(&b, "{sv}", property_name, value);
+	/* Objects must be added before the server is enabled */
+	g_assert_null(priv->bus_connection);
 
-	GVariant *tuples[] = {
-		g_variant_new_string(interface_name),
-		g_variant_builder_end(&b),
-		g_variant_new_strv(NULL, 0)
-	};
+	object = g_new0(GvDbusObject, 1);
+	object->path = g_strdup(path);
+	object->interface_name = interface_name;
 
-	gv_dbus_server_emit_signal(self, "org.freedesktop.DBus.Properties",
-	                           "PropertiesChanged", g_variant_new_tuple(tuples, 3));
+	priv->extra_objects = g_slist_append(priv->extra_objects, object);
 }
 
 GvDbusServer *
@@ -614,6 +999,9 @@ gv_dbus_server_disable(GvFeature *feature)
 	GvDbusServer *self = GV_DBUS_SERVER(feature);
 	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
 
+	/* Drop pending property changes */
+	drop_property_changes(self);
+
 	/* Unref DBus connection & objects registered */
 	if (priv->bus_connection != NULL) {
 		gv_dbus_server_unregister_objects(self);
@@ -679,9 +1067,29 @@ gv_dbus_server_finalize(GObject *object)
 
 	TRACE("%p", object);
 
+	/* Free property changes */
+	drop_property_changes(self);
+	g_hash_table_unref(priv->pending_changes);
+
+	/* Free dispatch map */
+	g_hash_table_unref(priv->properties);
+	g_hash_table_unref(priv->methods);
+	g_hash_table_unref(priv->interfaces);
+
 	/* Unref introspection data */
-	if (priv->introspection_data != NULL)
+	if (priv->introspection_data != NULL) {
+		GDBusInterfaceInfo **interfaces = priv->introspection_data->interfaces;
+		GDBusInterfaceInfo *interface;
+
+		while (interfaces && (interface = *interfaces++))
+			g_dbus_interface_info_cache_release(interface);
+
 		g_dbus_node_info_unref(priv->introspection_data);
+	}
+
+	/* Free objects */
+	g_slist_free_full(priv->extra_objects, (GDestroyNotify) gv_dbus_object_free);
+	g_array_free(priv->registration_ids, TRUE);
 
 	/* Chain up */
 	G_OBJECT_CHAINUP_FINALIZE(gv_dbus_server, object);
@@ -692,6 +1100,8 @@ gv_dbus_server_constructed(GObject *object)
 {
 	GvDbusServer *self = GV_DBUS_SERVER(object);
 	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+	GDBusInterfaceInfo **interfaces;
+	GDBusInterfaceInfo *interface;
 
 	TRACE("%p", object);
 
@@ -706,6 +1116,14 @@ gv_dbus_server_constructed(GObject *object)
 	priv->introspection_data = g_dbus_node_info_new_for_xml(priv->introspection, NULL);
 	g_assert_nonnull(priv->introspection_data);
 
+	/* Speed up the lookups that GDBus does for each call */
+	interfaces = priv->introspection_data->interfaces;
+	while (interfaces && (interface = *interfaces++))
+		g_dbus_interface_info_cache_build(interface);
+
+	/* Compile the interface table */
+	build_dispatch_map(self);
+
 #ifdef DEBUG_INTERFACES
 	/* Ensure that the interface table matches the introspection data.
 	 * Be sure to enable this test if you work on this part.
@@ -720,7 +1138,24 @@ gv_dbus_server_constructed(GObject *object)
 static void
 gv_dbus_server_init(GvDbusServer *self)
 {
+	GvDbusServerPrivate *priv = gv_dbus_server_get_instance_private(self);
+
 	TRACE("%p", self);
+
+	/* Initialize registration ids */
+	priv->registration_ids = g_array_new(FALSE, FALSE, sizeof(guint));
+
+	/* Initialize dispatch map */
+	priv->interfaces = g_hash_table_new(NULL, NULL);
+	priv->methods = g_hash_table_new_full(gv_dbus_handler_hash, gv_dbus_handler_equal,
+	                                      (GDestroyNotify) gv_dbus_handler_free, NULL);
+	priv->properties = g_hash_table_new_full(gv_dbus_handler_hash, gv_dbus_handler_equal,
+	                                         (GDestroyNotify) gv_dbus_handler_free, NULL);
+
+	/* Initialize property changes */
+	priv->pending_changes = g_hash_table_new_full(gv_dbus_changes_hash, gv_dbus_changes_equal,
+	                                              (GDestroyNotify) gv_dbus_changes_free,
+	                                              NULL);
 }
 
 static void
@@ -74,10 +74,17 @@ void gv_dbus_server_emit_signal(GvDbusServer *self,
                                 GVariant *parameters);
 
 void gv_dbus_server_emit_signal_property_changed(GvDbusServer *self,
+                                                 const gchar *path,
                                                  const gchar *interface_name,
                                                  const gchar *property_name,
                                                  GVariant *value);
 
+void gv_dbus_server_add_dbus_object(GvDbusServer *self,
+                                    const gchar *path,
+                                    const gchar *interface_name);
+
+const gchar *gv_dbus_server_get_invocation_path(GvDbusServer *self);
+
 /* Property accessors */
 
 void gv_dbus_server_set_dbus_name           (GvDbusServer *self, const gchar *name);
@@ -37,6 +37,9 @@
 #ifdef NOTIFICATIONS_ENABLED
 #include "feat/gv-notifications.h"
 #endif
+#ifdef RELAY_ENABLED
+#include "feat/gv-relay.h"
+#endif
 
 #define MAX_FEATURES 12
 
@@ -133,6 +136,11 @@ gv_feat_init(void)
 	gv_framework_register(feature);
 	features[i++] = feature;
 #endif
+#ifdef RELAY_ENABLED
+	feature = gv_relay_new();
+	gv_framework_register(feature);
+	features[i++] = feature;
+#endif
 
 	/* Sum up the situation */
 
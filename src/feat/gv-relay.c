@@ -0,0 +1,856 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2017 Arnaud Rebillout
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <gst/gst.h>
+
+#include "framework/gv-framework.h"
+#include "core/gv-core.h"
+
+#include "feat/gv-relay.h"
+
+/* Maximum amount of data waiting to be sent to a client. A client that
+ * can't keep up is dropped, so that it never blocks the streaming thread,
+ * nor delays the other clients.
+ */
+
+#define MAX_QUEUED_BYTES (512 * 1024)
+
+/*
+ * Properties
+ */
+
+#define DEFAULT_ADDRESS     "127.0.0.1"
+#define DEFAULT_PORT        8000
+#define DEFAULT_MAX_CLIENTS 4
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Properties */
+	PROP_ADDRESS,
+	PROP_PORT,
+	PROP_MAX_CLIENTS,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+/*
+ * Clients
+ */
+
+typedef struct {
+	GvRelay           *relay;
+	GSocketConnection *connection;
+	GDataInputStream  *input;
+	GCancellable      *cancellable;
+	/* Protected by the relay lock */
+	GQueue             buffers;
+	gsize              queued_bytes;
+	gboolean           streaming;
+	gboolean           overflow;
+	/* Main thread only */
+	gboolean           request_started;
+	gboolean           headers_sent;
+	gboolean           busy;
+	gboolean           closed;
+	gchar             *headers;
+	GstBuffer         *buffer;
+	GstMapInfo         map;
+} GvRelayClient;
+
+/*
+ * GObject definitions
+ */
+
+struct _GvRelayPrivate {
+	/* Properties */
+	gchar            *address;
+	guint             port;
+	guint             max_clients;
+	/* Listening socket */
+	GSocketService   *service;
+	/* Clients, and things shared with the streaming thread.
+	 * The lock only exists while the feature is enabled.
+	 */
+	GMutex            lock;
+	GList            *clients;
+	gchar            *content_type;
+	guint             when_idle_id;
+};
+
+typedef struct _GvRelayPrivate GvRelayPrivate;
+
+struct _GvRelay {
+	/* Parent instance structure */
+	GvFeature       parent_instance;
+	/* Private data */
+	GvRelayPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GvRelay, gv_relay, GV_TYPE_FEATURE,
+                        G_ADD_PRIVATE(GvRelay)
+                        G_IMPLEMENT_INTERFACE(GV_TYPE_ERRORABLE, NULL))
+
+/*
+ * Client helpers
+ */
+
+static void client_write_next(GvRelayClient *client);
+
+static void
+client_free(GvRelayClient *client)
+{
+	GstBuffer *buffer;
+
+	while ((buffer = g_queue_pop_head(&client->buffers)))
+		gst_buffer_unref(buffer);
+
+	g_io_stream_close(G_IO_STREAM(client->connection), NULL, NULL);
+
+	g_object_unref(client->input);
+	g_object_unref(client->connection);
+	g_object_unref(client->cancellable);
+	g_free(client->headers);
+	g_free(client);
+}
+
+static void
+client_close(GvRelayClient *client)
+{
+	GvRelayPrivate *priv = client->relay->priv;
+
+	g_mutex_lock(&priv->lock);
+	priv->clients = g_list_remove(priv->clients, client);
+	g_mutex_unlock(&priv->lock);
+
+	/* If an operation is pending, the client is freed in its callback */
+	client->closed = TRUE;
+	g_cancellable_cancel(client->cancellable);
+
+	if (client->busy == FALSE)
+		client_free(client);
+}
+
+static gchar *
+client_make_headers(GvRelayClient *client)
+{
+	GvRelayPrivate *priv = client->relay->priv;
+	GvStation *station = gv_player_get_station(gv_core_player);
+	const gchar *name = station ? gv_station_get_name(station) : NULL;
+	gchar *content_type;
+	GString *headers;
+
+	g_mutex_lock(&priv->lock);
+	content_type = g_strdup(priv->content_type);
+	g_mutex_unlock(&priv->lock);
+
+	headers = g_string_new("HTTP/1.0 200 OK\r\n");
+	g_string_append_printf(headers, "Content-Type: %s\r\n",
+	                       content_type ? content_type : "application/octet-stream");
+	g_string_append(headers, "Cache-Control: no-cache\r\n");
+	g_string_append(headers, "Connection: close\r\n");
+	if (name)
+		g_string_append_printf(headers, "icy-name: %s\r\n", name);
+	g_string_append(headers, "\r\n");
+
+	g_free(content_type);
+
+	return g_string_free(headers, FALSE);
+}
+
+static void
+on_client_data_written(GOutputStream *stream,
+                       GAsyncResult  *result,
+                       GvRelayClient *client)
+{
+	GError *err = NULL;
+
+	g_output_stream_write_all_finish(stream, result, NULL, &err);
+
+	if (client->buffer) {
+		gst_buffer_unmap(client->buffer, &client->map);
+		gst_buffer_unref(client->buffer);
+		client->buffer = NULL;
+	}
+
+	client->busy = FALSE;
+
+	if (client->closed) {
+		g_clear_error(&err);
+		client_free(client);
+		return;
+	}
+
+	if (err) {
+		DEBUG("Client %p write error: %s", client, err->message);
+		g_error_free(err);
+		client_close(client);
+		return;
+	}
+
+	client_write_next(client);
+}
+
+static void
+client_write_next(GvRelayClient *client)
+{
+	GvRelayPrivate *priv = client->relay->priv;
+	GOutputStream *output;
+	GstBuffer *buffer;
+
+	g_assert(client->busy == FALSE);
+
+	output = g_io_stream_get_output_stream(G_IO_STREAM(client->connection));
+
+	/* Send headers first, at this point the stream type is known */
+	if (client->headers_sent == FALSE) {
+		client->headers_sent = TRUE;
+		client->headers = client_make_headers(client);
+		client->busy = TRUE;
+		g_output_stream_write_all_async(output,
+		                                client->headers, strlen(client->headers),
+		                                G_PRIORITY_DEFAULT, client->cancellable,
+		                                (GAsyncReadyCallback) on_client_data_written,
+		                                client);
+		return;
+	}
+
+	/* Then send data, buffers are shared between clients, no copy */
+	g_mutex_lock(&priv->lock);
+	buffer = g_queue_pop_head(&client->buffers);
+	if (buffer)
+		client->queued_bytes -= gst_buffer_get_size(buffer);
+	g_mutex_unlock(&priv->lock);
+
+	if (buffer == NULL)
+		return;
+
+	if (!gst_buffer_map(buffer, &client->map, GST_MAP_READ)) {
+		WARNING("Failed to map buffer");
+		gst_buffer_unref(buffer);
+		client_close(client);
+		return;
+	}
+
+	client->buffer = buffer;
+	client->busy = TRUE;
+	g_output_stream_write_all_async(output,
+	                                client->map.data, client->map.size,
+	                                G_PRIORITY_DEFAULT, client->cancellable,
+	                                (GAsyncReadyCallback) on_client_data_written,
+	                                client);
+}
+
+static void
+on_client_line_read(GDataInputStream *input,
+                    GAsyncResult     *result,
+                    GvRelayClient    *client)
+{
+	GvRelayPrivate *priv;
+	GError *err = NULL;
+	gchar *line;
+
+	line = g_data_input_stream_read_line_finish(input, result, NULL, &err);
+
+	client->busy = FALSE;
+
+	if (client->closed) {
+		g_clear_error(&err);
+		g_free(line);
+		client_free(client);
+		return;
+	}
+
+	if (line == NULL) {
+		DEBUG("Client %p read error: %s", client,
+		      err ? err->message : "end of stream");
+		g_clear_error(&err);
+		client_close(client);
+		return;
+	}
+
+	/* We only serve the stream, whatever the path requested */
+	if (client->request_started == FALSE) {
+		client->request_started = TRUE;
+		if (!g_str_has_prefix(line, "GET ")) {
+			DEBUG("Client %p invalid request: %s", client, line);
+			g_free(line);
+			client_close(client);
+			return;
+		}
+	}
+
+	/* Headers are ignored, an empty line ends the request */
+	if (line[0] != '\0') {
+		g_free(line);
+		client->busy = TRUE;
+		g_data_input_stream_read_line_async(input, G_PRIORITY_DEFAULT,
+		                                    client->cancellable,
+		                                    (GAsyncReadyCallback) on_client_line_read,
+		                                    client);
+		return;
+	}
+
+	g_free(line);
+
+	/* Request done, start streaming */
+	priv = client->relay->priv;
+	g_mutex_lock(&priv->lock);
+	client->streaming = TRUE;
+	g_mutex_unlock(&priv->lock);
+
+	INFO("Client %p connected", client);
+}
+
+/*
+ * Helpers
+ */
+
+static void
+close_clients(GvRelay *self)
+{
+	GvRelayPrivate *priv = self->priv;
+
+	while (priv->clients)
+		client_close(priv->clients->data);
+}
+
+static gboolean
+when_idle_flush_clients(GvRelay *self)
+{
+	GvRelayPrivate *priv = self->priv;
+	GList *clients, *item;
+
+	g_mutex_lock(&priv->lock);
+	priv->when_idle_id = 0;
+	clients = g_list_copy(priv->clients);
+	g_mutex_unlock(&priv->lock);
+
+	/* Clients are only removed from the main thread, so the copy is safe */
+	for (item = clients; item; item = item->next) {
+		GvRelayClient *client = item->data;
+		gboolean overflow;
+
+		g_mutex_lock(&priv->lock);
+		overflow = client->overflow;
+		g_mutex_unlock(&priv->lock);
+
+		if (overflow) {
+			INFO("Client %p is too slow, dropping it", client);
+			client_close(client);
+			continue;
+		}
+
+		if (client->busy == FALSE)
+			client_write_next(client);
+	}
+
+	g_list_free(clients);
+
+	return G_SOURCE_REMOVE;
+}
+
+static gchar *
+guess_content_type(GstBuffer *buffer)
+{
+	gchar *content_type;
+	gchar *mime_type;
+	GstMapInfo map;
+
+	if (!gst_buffer_map(buffer, &map, GST_MAP_READ))
+		return NULL;
+
+	content_type = g_content_type_guess(NULL, map.data, map.size, NULL);
+	gst_buffer_unmap(buffer, &map);
+
+	mime_type = g_content_type_get_mime_type(content_type);
+	DEBUG("Stream content type: %s (%s)", content_type, mime_type);
+	g_free(content_type);
+
+	return mime_type;
+}
+
+static void
+stop_listening(GvRelay *self)
+{
+	GvRelayPrivate *priv = self->priv;
+
+	if (priv->service == NULL)
+		return;
+
+	g_signal_handlers_disconnect_by_data(priv->service, self);
+	g_socket_service_stop(priv->service);
+	g_socket_listener_close(G_SOCKET_LISTENER(priv->service));
+	g_clear_object(&priv->service);
+
+	INFO("Relay stopped listening");
+}
+
+static gboolean
+add_listening_address(GSocketListener *listener, const gchar *address, guint port,
+                      GError **err)
+{
+	GInetAddress *inet_address;
+	GSocketAddress *socket_address;
+	gboolean ret;
+
+	/* No address means every interface */
+	if (address == NULL || address[0] == '\0')
+		return g_socket_listener_add_inet_port(listener, port, NULL, err);
+
+	inet_address = g_inet_address_new_from_string(address);
+	if (inet_address == NULL) {
+		g_set_error(err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+		            "Invalid address '%s'", address);
+		return FALSE;
+	}
+
+	socket_address = g_inet_socket_address_new(inet_address, port);
+	ret = g_socket_listener_add_address(listener, socket_address,
+	                                    G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_TCP,
+	                                    NULL, NULL, err);
+
+	g_object_unref(socket_address);
+	g_object_unref(inet_address);
+
+	return ret;
+}
+
+static gboolean on_service_incoming(GSocketService    *service,
+                                    GSocketConnection *connection,
+                                    GObject           *source_object,
+                                    GvRelay           *self);
+
+static void
+start_listening(GvRelay *self)
+{
+	GvRelayPrivate *priv = self->priv;
+	GSocketService *service;
+	GError *err = NULL;
+
+	g_assert_null(priv->service);
+
+	service = g_socket_service_new();
+	add_listening_address(G_SOCKET_LISTENER(service), priv->address, priv->port, &err);
+	if (err) {
+		gv_errorable_emit_error_printf(GV_ERRORABLE(self),
+		                               _("Failed to listen on port %u: %s"),
+		                               priv->port, err->message);
+		g_error_free(err);
+		g_object_unref(service);
+		return;
+	}
+
+	g_signal_connect(service, "incoming", G_CALLBACK(on_service_incoming), self);
+	g_socket_service_start(service);
+	priv->service = service;
+
+	INFO("Relay listening on %s, port %u",
+	     priv->address && priv->address[0] ? priv->address : "all interfaces",
+	     priv->port);
+}
+
+/*
+ * Signal handlers & callbacks
+ */
+
+static gboolean
+on_service_incoming(GSocketService    *service G_GNUC_UNUSED,
+                    GSocketConnection *connection,
+                    GObject           *source_object G_GNUC_UNUSED,
+                    GvRelay           *self)
+{
+	GvRelayPrivate *priv = self->priv;
+	GvRelayClient *client;
+	GInputStream *input;
+	guint n_clients;
+
+	/* Every client gets its own copy of the stream, so their number is capped */
+	g_mutex_lock(&priv->lock);
+	n_clients = g_list_length(priv->clients);
+	g_mutex_unlock(&priv->lock);
+
+	if (priv->max_clients > 0 && n_clients >= priv->max_clients) {
+		INFO("Too many clients, refusing connection");
+		g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+		return TRUE;
+	}
+
+	client = g_new0(GvRelayClient, 1);
+	client->relay = self;
+	client->connection = g_object_ref(connection);
+	client->cancellable = g_cancellable_new();
+	g_queue_init(&client->buffers);
+
+	input = g_io_stream_get_input_stream(G_IO_STREAM(connection));
+	client->input = g_data_input_stream_new(input);
+	g_data_input_stream_set_newline_type(client->input, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+
+	g_mutex_lock(&priv->lock);
+	priv->clients = g_list_append(priv->clients, client);
+	g_mutex_unlock(&priv->lock);
+
+	/* Read the request */
+	client->busy = TRUE;
+	g_data_input_stream_read_line_async(client->input, G_PRIORITY_DEFAULT,
+	                                    client->cancellable,
+	                                    (GAsyncReadyCallback) on_client_line_read,
+	                                    client);
+
+	return TRUE;
+}
+
+static void
+on_engine_buffer(GstBuffer *buffer, GvRelay *self)
+{
+	GvRelayPrivate *priv = self->priv;
+	gsize size = gst_buffer_get_size(buffer);
+	gboolean pending = FALSE;
+	GList *item;
+
+	/* Invoked from the streaming thread. Clients just get a new reference
+	 * on the buffer, data is written later on from the main thread.
+	 */
+	g_mutex_lock(&priv->lock);
+
+	if (priv->content_type == NULL)
+		priv->content_type = guess_content_type(buffer);
+
+	for (item = priv->clients; item; item = item->next) {
+		GvRelayClient *client = item->data;
+
+		if (client->streaming == FALSE || client->overflow == TRUE)
+			continue;
+
+		if (client->queued_bytes + size > MAX_QUEUED_BYTES) {
+			client->overflow = TRUE;
+		} else {
+			g_queue_push_tail(&client->buffers, gst_buffer_ref(buffer));
+			client->queued_bytes += size;
+		}
+
+		pending = TRUE;
+	}
+
+	if (pending && priv->when_idle_id == 0)
+		priv->when_idle_id = g_idle_add((GSourceFunc) when_idle_flush_clients, self);
+
+	g_mutex_unlock(&priv->lock);
+}
+
+static void
+on_engine_notify_stream_uri(GvEngine   *engine G_GNUC_UNUSED,
+                            GParamSpec *pspec G_GNUC_UNUSED,
+                            GvRelay    *self)
+{
+	GvRelayPrivate *priv = self->priv;
+
+	/* New stream, content type must be guessed again */
+	g_mutex_lock(&priv->lock);
+	g_clear_pointer(&priv->content_type, g_free);
+	g_mutex_unlock(&priv->lock);
+}
+
+/*
+ * Property accessors
+ */
+
+const gchar *
+gv_relay_get_address(GvRelay *self)
+{
+	return self->priv->address;
+}
+
+void
+gv_relay_set_address(GvRelay *self, const gchar *address)
+{
+	GvRelayPrivate *priv = self->priv;
+
+	if (!g_strcmp0(priv->address, address))
+		return;
+
+	g_free(priv->address);
+	priv->address = g_strdup(address);
+
+	/* Restart listening if needed, connected clients are not affected */
+	if (priv->service) {
+		stop_listening(self);
+		start_listening(self);
+	}
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_ADDRESS]);
+}
+
+guint
+gv_relay_get_port(GvRelay *self)
+{
+	return self->priv->port;
+}
+
+void
+gv_relay_set_port(GvRelay *self, guint port)
+{
+	GvRelayPrivate *priv = self->priv;
+
+	if (priv->port == port)
+		return;
+
+	priv->port = port;
+
+	/* Restart listening if needed, connected clients are not affected */
+	if (priv->service) {
+		stop_listening(self);
+		start_listening(self);
+	}
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_PORT]);
+}
+
+guint
+gv_relay_get_max_clients(GvRelay *self)
+{
+	return self->priv->max_clients;
+}
+
+void
+gv_relay_set_max_clients(GvRelay *self, guint max_clients)
+{
+	GvRelayPrivate *priv = self->priv;
+
+	if (priv->max_clients == max_clients)
+		return;
+
+	/* Connected clients are not affected, the cap applies to new ones */
+	priv->max_clients = max_clients;
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MAX_CLIENTS]);
+}
+
+static void
+gv_relay_get_property(GObject    *object,
+                      guint       property_id,
+                      GValue     *value,
+                      GParamSpec *pspec)
+{
+	GvRelay *self = GV_RELAY(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_ADDRESS:
+		g_value_set_string(value, gv_relay_get_address(self));
+		break;
+	case PROP_PORT:
+		g_value_set_uint(value, gv_relay_get_port(self));
+		break;
+	case PROP_MAX_CLIENTS:
+		g_value_set_uint(value, gv_relay_get_max_clients(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_relay_set_property(GObject      *object,
+                      guint         property_id,
+                      const GValue *value,
+                      GParamSpec   *pspec)
+{
+	GvRelay *self = GV_RELAY(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_ADDRESS:
+		gv_relay_set_address(self, g_value_get_string(value));
+		break;
+	case PROP_PORT:
+		gv_relay_set_port(self, g_value_get_uint(value));
+		break;
+	case PROP_MAX_CLIENTS:
+		gv_relay_set_max_clients(self, g_value_get_uint(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Feature methods
+ */
+
+static void
+gv_relay_disable(GvFeature *feature)
+{
+	GvRelay *self = GV_RELAY(feature);
+	GvRelayPrivate *priv = self->priv;
+	GvEngine *engine = gv_core_engine;
+
+	/* Once the tap is removed, the streaming thread is out of the way */
+	gv_engine_remove_tap(engine, (GvEngineTapFunc) on_engine_buffer, self);
+	g_signal_handlers_disconnect_by_data(engine, self);
+
+	/* Stop accepting connections, and drop clients */
+	stop_listening(self);
+	close_clients(self);
+
+	/* Cleanup */
+	if (priv->when_idle_id) {
+		g_source_remove(priv->when_idle_id);
+		priv->when_idle_id = 0;
+	}
+
+	g_clear_pointer(&priv->content_type, g_free);
+	g_mutex_clear(&priv->lock);
+
+	/* Chain up */
+	GV_FEATURE_CHAINUP_DISABLE(gv_relay, feature);
+}
+
+static void
+gv_relay_enable(GvFeature *feature)
+{
+	GvRelay *self = GV_RELAY(feature);
+	GvRelayPrivate *priv = self->priv;
+	GvEngine *engine = gv_core_engine;
+
+	/* Chain up */
+	GV_FEATURE_CHAINUP_ENABLE(gv_relay, feature);
+
+	/* Initialize lock */
+	g_mutex_init(&priv->lock);
+
+	/* Start accepting connections */
+	start_listening(self);
+
+	/* Get the stream data */
+	g_signal_connect(engine, "notify::stream-uri",
+	                 G_CALLBACK(on_engine_notify_stream_uri), self);
+	gv_engine_add_tap(engine, (GvEngineTapFunc) on_engine_buffer, self);
+}
+
+/*
+ * Public methods
+ */
+
+GvFeature *
+gv_relay_new(void)
+{
+	return gv_feature_new(GV_TYPE_RELAY, "Relay");
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_relay_finalize(GObject *object)
+{
+	GvRelay *self = GV_RELAY(object);
+	GvRelayPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Free resources */
+	g_free(priv->address);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_relay, object);
+}
+
+static void
+gv_relay_constructed(GObject *object)
+{
+	GvRelay *self = GV_RELAY(object);
+	GSettings *settings;
+
+	/* Chain up, settings are created there */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_relay, object);
+
+	/* Bind settings */
+	settings = gv_feature_get_settings(GV_FEATURE(self));
+	g_settings_bind(settings, "address", self, "address", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(settings, "port", self, "port", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(settings, "max-clients", self, "max-clients", G_SETTINGS_BIND_DEFAULT);
+}
+
+static void
+gv_relay_init(GvRelay *self)
+{
+	GvRelayPrivate *priv;
+
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = priv = gv_relay_get_instance_private(self);
+
+	/* Initialize properties */
+	priv->address = g_strdup(DEFAULT_ADDRESS);
+	priv->port = DEFAULT_PORT;
+	priv->max_clients = DEFAULT_MAX_CLIENTS;
+}
+
+static void
+gv_relay_class_init(GvRelayClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+	GvFeatureClass *feature_class = GV_FEATURE_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_relay_finalize;
+	object_class->constructed = gv_relay_constructed;
+
+	/* Override GvFeature methods */
+	feature_class->enable = gv_relay_enable;
+	feature_class->disable = gv_relay_disable;
+
+	/* Properties */
+	object_class->get_property = gv_relay_get_property;
+	object_class->set_property = gv_relay_set_property;
+
+	properties[PROP_ADDRESS] =
+	        g_param_spec_string("address", "Address", "Address to serve the stream on",
+	                            DEFAULT_ADDRESS,
+	                            GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_PORT] =
+	        g_param_spec_uint("port", "Port", "Port to serve the stream on",
+	                          1, G_MAXUINT16, DEFAULT_PORT,
+	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	properties[PROP_MAX_CLIENTS] =
+	        g_param_spec_uint("max-clients", "Max clients",
+	                          "Maximum number of clients, 0 for no limit",
+	                          0, G_MAXUINT, DEFAULT_MAX_CLIENTS,
+	                          GV_PARAM_DEFAULT_FLAGS | G_PARAM_READWRITE);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+}
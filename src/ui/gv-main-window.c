@@ -17,6 +17,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include <glib.h>
 #include <glib-object.h>
 #include <gtk/gtk.h>
@@ -33,6 +35,10 @@
 
 #define UI_FILE "main-window.glade"
 
+/* Spectrum magnitudes range, the engine clamps the lowest values */
+#define SPECTRUM_FLOOR  -80.0 /* dB */
+#define SPECTRUM_HEIGHT 48    /* px */
+
 /*
  * GObject definitions
  */
@@ -54,6 +60,8 @@ struct _GvMainWindowPrivate {
 	GtkWidget *repeat_toggle_button;
 	GtkWidget *shuffle_toggle_button;
 	GtkWidget *volume_button;
+	/* Spectrum */
+	GtkWidget *spectrum_drawing_area;
 	/* Stations */
 	GtkWidget *stations_tree_view;
 
@@ -62,6 +70,13 @@ struct _GvMainWindowPrivate {
 	 */
 
 	GBinding *volume_binding;
+
+	/*
+	 * Spectrum
+	 */
+
+	gfloat *spectrum;
+	guint   spectrum_bands;
 };
 
 typedef struct _GvMainWindowPrivate GvMainWindowPrivate;
@@ -210,10 +225,104 @@ on_player_notify(GvPlayer     *player,
 	}
 }
 
+/*
+ * Core Engine signal handlers
+ */
+
+static void
+clear_spectrum(GvMainWindow *self)
+{
+	GvMainWindowPrivate *priv = self->priv;
+
+	g_free(priv->spectrum);
+	priv->spectrum = NULL;
+	priv->spectrum_bands = 0;
+	gtk_widget_queue_draw(priv->spectrum_drawing_area);
+}
+
+static void
+on_engine_spectrum(GvEngine     *engine G_GNUC_UNUSED,
+                   guint         n_bands,
+                   const gfloat *magnitudes,
+                   GvMainWindow *self)
+{
+	GvMainWindowPrivate *priv = self->priv;
+
+	/* No need to draw if nobody can see it */
+	if (!gtk_widget_is_drawable(priv->spectrum_drawing_area))
+		return;
+
+	if (priv->spectrum_bands != n_bands) {
+		g_free(priv->spectrum);
+		priv->spectrum = g_new(gfloat, n_bands);
+		priv->spectrum_bands = n_bands;
+	}
+
+	memcpy(priv->spectrum, magnitudes, n_bands * sizeof(gfloat));
+	gtk_widget_queue_draw(priv->spectrum_drawing_area);
+}
+
+static void
+on_engine_notify(GvEngine     *engine,
+                 GParamSpec   *pspec,
+                 GvMainWindow *self)
+{
+	GvMainWindowPrivate *priv = self->priv;
+	const gchar *property_name = g_param_spec_get_name(pspec);
+
+	TRACE("%p, %s, %p", engine, property_name, self);
+
+	if (!g_strcmp0(property_name, "spectrum-bands")) {
+		guint n_bands = gv_engine_get_spectrum_bands(engine);
+
+		gtk_widget_set_visible(priv->spectrum_drawing_area, n_bands > 0);
+
+	} else if (!g_strcmp0(property_name, "state")) {
+		if (gv_engine_get_state(engine) == GV_ENGINE_STATE_STOPPED)
+			clear_spectrum(self);
+	}
+}
+
 /*
  * Widget signal handlers
  */
 
+static gboolean
+on_spectrum_drawing_area_draw(GtkWidget    *widget,
+                              cairo_t      *cr,
+                              GvMainWindow *self)
+{
+	GvMainWindowPrivate *priv = self->priv;
+	GtkStyleContext *context;
+	GdkRGBA color;
+	gdouble width, height, bar_width;
+	guint i;
+
+	if (priv->spectrum_bands == 0)
+		return FALSE;
+
+	width = gtk_widget_get_allocated_width(widget);
+	height = gtk_widget_get_allocated_height(widget);
+	bar_width = width / priv->spectrum_bands;
+
+	context = gtk_widget_get_style_context(widget);
+	gtk_style_context_get_color(context, gtk_style_context_get_state(context), &color);
+	gdk_cairo_set_source_rgba(cr, &color);
+
+	for (i = 0; i < priv->spectrum_bands; i++) {
+		gdouble level;
+
+		level = 1.0 - priv->spectrum[i] / SPECTRUM_FLOOR;
+		level = CLAMP(level, 0.0, 1.0);
+		cairo_rectangle(cr, i * bar_width, height * (1.0 - level),
+		                MAX(bar_width - 1.0, 1.0), height * level);
+	}
+
+	cairo_fill(cr);
+
+	return FALSE;
+}
+
 static void
 on_button_clicked(GtkButton *button, GvMainWindow *self)
 {
@@ -494,6 +603,14 @@ gv_main_window_populate_widgets(GvMainWindow *self)
 	GTK_BUILDER_SAVE_WIDGET(builder, priv, shuffle_toggle_button);
 	GTK_BUILDER_SAVE_WIDGET(builder, priv, volume_button);
 
+	/* Create the spectrum drawing area, only visible if there's a spectrum */
+	priv->spectrum_drawing_area = gtk_drawing_area_new();
+	gtk_widget_set_size_request(priv->spectrum_drawing_area, -1, SPECTRUM_HEIGHT);
+	gtk_widget_set_no_show_all(priv->spectrum_drawing_area, TRUE);
+	gtk_box_pack_start(GTK_BOX(priv->window_vbox), priv->spectrum_drawing_area,
+	                   FALSE, TRUE, 0);
+	gtk_box_reorder_child(GTK_BOX(priv->window_vbox), priv->spectrum_drawing_area, 1);
+
 	/* Now create the stations tree view */
 	priv->stations_tree_view = gv_stations_tree_view_new();
 	gtk_widget_show_all(priv->stations_tree_view);
@@ -553,6 +670,12 @@ gv_main_window_setup_widgets(GvMainWindow *self)
 	/* Set the station label */
 	set_station_label(GTK_LABEL(priv->station_label),
 	                  gv_player_get_station(gv_core_player));
+
+	/* Spectrum */
+	g_signal_connect(priv->spectrum_drawing_area, "draw",
+	                 G_CALLBACK(on_spectrum_drawing_area_draw), self);
+	gtk_widget_set_visible(priv->spectrum_drawing_area,
+	                       gv_engine_get_spectrum_bands(gv_core_engine) > 0);
 }
 
 static void
@@ -574,12 +697,17 @@ gv_main_window_finalize(GObject *object)
 {
 	GvMainWindow *self = GV_MAIN_WINDOW(object);
 	GvPlayer *player = gv_core_player;
+	GvEngine *engine = gv_core_engine;
 
 	TRACE("%p", object);
 
 	/* Disconnect core signal handlers */
+	g_signal_handlers_disconnect_by_data(engine, self);
 	g_signal_handlers_disconnect_by_data(player, self);
 
+	/* Free spectrum */
+	g_free(self->priv->spectrum);
+
 	/* Chain up */
 	G_OBJECT_CHAINUP_FINALIZE(gv_main_window, object);
 }
@@ -589,6 +717,7 @@ gv_main_window_constructed(GObject *object)
 {
 	GvMainWindow *self = GV_MAIN_WINDOW(object);
 	GvPlayer *player = gv_core_player;
+	GvEngine *engine = gv_core_engine;
 
 	/* Build window */
 	gv_main_window_populate_widgets(self);
@@ -598,6 +727,10 @@ gv_main_window_constructed(GObject *object)
 	/* Connect core signal handlers */
 	g_signal_connect(player, "notify",
 	                 G_CALLBACK(on_player_notify), self);
+	g_signal_connect(engine, "notify",
+	                 G_CALLBACK(on_engine_notify), self);
+	g_signal_connect(engine, "spectrum",
+	                 G_CALLBACK(on_engine_spectrum), self);
 
 	/* Chain up */
 	G_OBJECT_CHAINUP_CONSTRUCTED(gv_main_window, object);
@@ -39,6 +39,8 @@ struct _GvStationsTreeViewPrivate {
 	gboolean is_dragging;
 	GvStation *station_dragged;
 	gint station_new_pos;
+	/* Pending repopulate operation */
+	guint when_idle_id;
 };
 
 typedef struct _GvStationsTreeViewPrivate GvStationsTreeViewPrivate;
@@ -115,12 +117,35 @@ on_player_notify_station(GvPlayer           *player,
  * (remember the station list might be updated through the D-Bus API).
  */
 
+static gboolean
+when_idle_populate(GvStationsTreeView *self)
+{
+	GvStationsTreeViewPrivate *priv = self->priv;
+
+	priv->when_idle_id = 0;
+	gv_stations_tree_view_populate(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+/* Changes might come in batches, we repopulate only once for all of them */
 static void
 on_station_list_station_event(GvStationList *station_list G_GNUC_UNUSED,
                               GvStation     *station G_GNUC_UNUSED,
                               GvStationsTreeView  *self)
 {
-	gv_stations_tree_view_populate(self);
+	GvStationsTreeViewPrivate *priv = self->priv;
+
+	if (priv->when_idle_id == 0)
+		priv->when_idle_id = g_idle_add((GSourceFunc) when_idle_populate, self);
+}
+
+static void
+on_station_list_stations_added(GvStationList *station_list,
+                               GList         *stations G_GNUC_UNUSED,
+                               GvStationsTreeView  *self)
+{
+	on_station_list_station_event(station_list, NULL, self);
 }
 
 static GSignalHandler station_list_handlers[] = {
@@ -128,6 +153,7 @@ static GSignalHandler station_list_handlers[] = {
 	{ "station-removed",  G_CALLBACK(on_station_list_station_event) },
 	{ "station-modified", G_CALLBACK(on_station_list_station_event) },
 	{ "station-moved",    G_CALLBACK(on_station_list_station_event) },
+	{ "stations-added",   G_CALLBACK(on_station_list_stations_added) },
 	{ NULL,               NULL                                      }
 };
 
@@ -379,6 +405,46 @@ static GSignalHandler tree_view_drag_handlers[] = {
 	{ NULL,          NULL                                 }
 };
 
+/*
+ * Stations Tree View selection, to let the core know which station
+ * is likely to be played next. With hover selection, the selection
+ * follows the mouse pointer.
+ */
+
+static void
+on_tree_selection_changed(GtkTreeSelection   *tree_selection,
+                          GvStationsTreeView *self)
+{
+	GvStationsTreeViewPrivate *priv = self->priv;
+	GvPreconnect *preconnect = gv_core_preconnect;
+	GtkTreeModel *tree_model;
+	GtkTreeIter iter;
+	GvStation *station = NULL;
+
+	if (!priv->is_dragging &&
+	    gtk_tree_selection_get_selected(tree_selection, &tree_model, &iter))
+		gtk_tree_model_get(tree_model, &iter,
+		                   STATION_COLUMN, &station,
+		                   -1);
+
+	gv_preconnect_hint(preconnect, station);
+
+	if (station)
+		g_object_unref(station);
+}
+
+static gboolean
+on_tree_view_leave_notify_event(GvStationsTreeView *self G_GNUC_UNUSED,
+                                GdkEventCrossing    *event G_GNUC_UNUSED,
+                                gpointer             data G_GNUC_UNUSED)
+{
+	GvPreconnect *preconnect = gv_core_preconnect;
+
+	gv_preconnect_hint(preconnect, NULL);
+
+	return FALSE;
+}
+
 /*
  * Stations List Store signal handlers.
  * We watch these signals to be notified when a station is moved
@@ -556,6 +622,12 @@ gv_stations_tree_view_populate(GvStationsTreeView *self)
 
 	TRACE("%p", self);
 
+	/* A pending repopulate is not needed anymore */
+	if (self->priv->when_idle_id) {
+		g_source_remove(self->priv->when_idle_id);
+		self->priv->when_idle_id = 0;
+	}
+
 	/* Block list store handlers */
 	g_signal_handlers_block(list_store, list_store_handlers, self);
 
@@ -591,6 +663,7 @@ gv_stations_tree_view_populate(GvStationsTreeView *self)
 			GtkTreeIter tree_iter;
 			const gchar *station_name;
 			PangoWeight weight;
+			PangoStyle style;
 
 			station_name = gv_station_get_name_or_uri(station);
 
@@ -599,12 +672,18 @@ gv_stations_tree_view_populate(GvStationsTreeView *self)
 			else
 				weight = PANGO_WEIGHT_NORMAL;
 
+			/* Stations that failed the health check */
+			if (gv_station_get_check_error(station))
+				style = PANGO_STYLE_ITALIC;
+			else
+				style = PANGO_STYLE_NORMAL;
+
 			gtk_list_store_append(list_store, &tree_iter);
 			gtk_list_store_set(list_store, &tree_iter,
 			                   STATION_COLUMN, station,
 			                   STATION_NAME_COLUMN, station_name,
 			                   STATION_WEIGHT_COLUMN, weight,
-			                   STATION_STYLE_COLUMN, PANGO_STYLE_NORMAL,
+			                   STATION_STYLE_COLUMN, style,
 			                   -1);
 		}
 		gv_station_list_iter_free(iter);
@@ -722,6 +801,12 @@ gv_stations_tree_view_constructed(GObject *object)
 	 */
 	g_signal_handlers_connect(tree_view, tree_view_drag_handlers, NULL);
 
+	/* Selection and pointer leaving, for preconnect */
+	g_signal_connect(gtk_tree_view_get_selection(tree_view), "changed",
+	                 G_CALLBACK(on_tree_selection_changed), self);
+	g_signal_connect(tree_view, "leave-notify-event",
+	                 G_CALLBACK(on_tree_view_leave_notify_event), NULL);
+
 	/*
 	 * List Store signal handlers
 	 */
@@ -744,6 +829,21 @@ gv_stations_tree_view_constructed(GObject *object)
 	G_OBJECT_CHAINUP_CONSTRUCTED(gv_stations_tree_view, object);
 }
 
+static void
+gv_stations_tree_view_finalize(GObject *object)
+{
+	GvStationsTreeViewPrivate *priv = GV_STATIONS_TREE_VIEW(object)->priv;
+
+	TRACE("%p", object);
+
+	/* Remove pending operation */
+	if (priv->when_idle_id)
+		g_source_remove(priv->when_idle_id);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_stations_tree_view, object);
+}
+
 static void
 gv_stations_tree_view_init(GvStationsTreeView *self)
 {
@@ -764,5 +864,6 @@ gv_stations_tree_view_class_init(GvStationsTreeViewClass *class)
 	TRACE("%p", class);
 
 	/* Override GObject methods */
+	object_class->finalize = gv_stations_tree_view_finalize;
 	object_class->constructed = gv_stations_tree_view_constructed;
 }